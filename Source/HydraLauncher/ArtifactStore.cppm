@@ -0,0 +1,406 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module ArtifactStore;
+
+import HE;
+import std;
+import Hash;
+import Utils;
+
+export namespace ArtifactStore {
+
+	constexpr const char* c_ManifestHeader = "HydraArtifacts 1";
+	constexpr const char* c_ManifestFileName = "manifest";
+	constexpr const char* c_FilesDirName = "files";
+
+	struct Key
+	{
+		std::string commit;    // full commit OID
+		std::string toolchain; // e.g. vs2022-windows-x86_64
+		std::string config;    // Debug, Release, Profile, Dist
+
+		std::string ToString() const { return std::format("{}/{}/{}", commit, toolchain, config); }
+		bool IsValid() const { return !commit.empty() && !toolchain.empty() && !config.empty(); }
+	};
+
+	struct Entry
+	{
+		std::string path; // relative to the engine root, '/' separated
+		uint64_t size = 0;
+		uint64_t hash = 0;
+	};
+
+	struct Manifest
+	{
+		std::vector<Entry> entries;
+
+		bool Write(const std::filesystem::path& filePath) const
+		{
+			std::ofstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+			{
+				HE_ERROR("Unable to open file for writing, {}", filePath.string());
+				return false;
+			}
+
+			file << c_ManifestHeader << "\n";
+			for (auto& e : entries)
+				file << Hash::ToString(e.hash) << " " << e.size << " " << e.path << "\n";
+
+			return file.good();
+		}
+
+		bool Read(const std::filesystem::path& filePath)
+		{
+			entries.clear();
+
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+				return false;
+
+			std::string line;
+			if (!std::getline(file, line) || line != c_ManifestHeader)
+				return false;
+
+			while (std::getline(file, line))
+			{
+				if (line.empty())
+					continue;
+
+				auto first = line.find(' ');
+				auto second = line.find(' ', first + 1);
+				if (first == std::string::npos || second == std::string::npos)
+					return false;
+
+				Entry e;
+				std::string_view view = line;
+				if (!Hash::FromString(view.substr(0, first), e.hash))
+					return false;
+
+				auto sizeStr = view.substr(first + 1, second - first - 1);
+				if (std::from_chars(sizeStr.data(), sizeStr.data() + sizeStr.size(), e.size).ec != std::errc())
+					return false;
+
+				if (!Utils::IsContainedPath(view.substr(second + 1), e.path))
+				{
+					HE_ERROR("ArtifactStore : invalid path in manifest, {}", view.substr(second + 1));
+					return false;
+				}
+
+				entries.push_back(std::move(e));
+			}
+
+			return true;
+		}
+	};
+
+	enum class Backend
+	{
+		None,
+		Directory,
+		Http
+	};
+
+	Backend GetBackend(std::string_view location)
+	{
+		if (location.empty())
+			return Backend::None;
+
+		if (location.starts_with("http://") || location.starts_with("https://"))
+			return Backend::Http;
+
+		return Backend::Directory;
+	}
+}
+
+// Internal
+namespace ArtifactStore {
+
+	std::filesystem::path GetDirectoryRoot(std::string_view location)
+	{
+		if (location.starts_with("file://"))
+		{
+			location.remove_prefix(7);
+
+			// file:///C:/store
+			if (location.size() > 2 && location[0] == '/' && location[2] == ':')
+				location.remove_prefix(1);
+		}
+
+		return std::filesystem::path(location).lexically_normal();
+	}
+
+	std::string GetUrl(std::string_view location, const Key& key, std::string_view relativePath)
+	{
+		std::string url(location);
+		if (!url.ends_with('/'))
+			url += '/';
+
+		url += key.ToString();
+		url += '/';
+
+		for (char c : relativePath)
+		{
+			if (std::isalnum((unsigned char)c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~')
+				url += c;
+			else
+				url += std::format("%{:02X}", (unsigned char)c);
+		}
+
+		return url;
+	}
+
+	// -f makes HTTP errors fail, the exit code is curl's own
+	bool Curl(const std::string& args)
+	{
+		std::string cmd = std::format("curl {}", args);
+		return Utils::RunProcess(cmd.c_str()) == 0;
+	}
+
+	std::filesystem::path GetTempDirectory()
+	{
+		auto dir = std::filesystem::temp_directory_path() / "HydraLauncher";
+		std::error_code ec;
+		std::filesystem::create_directories(dir, ec);
+		return dir;
+	}
+
+	bool Verify(const std::filesystem::path& root, const Manifest& manifest)
+	{
+		for (auto& e : manifest.entries)
+		{
+			auto filePath = root / e.path;
+
+			std::error_code ec;
+			uint64_t size = std::filesystem::file_size(filePath, ec);
+			if (ec || size != e.size)
+			{
+				HE_ERROR("ArtifactStore : size mismatch {}", filePath.string());
+				return false;
+			}
+
+			uint64_t hash = 0;
+			if (!Hash::ComputeFile(filePath, hash) || hash != e.hash)
+			{
+				HE_ERROR("ArtifactStore : hash mismatch {}", filePath.string());
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool BuildManifest(const std::filesystem::path& root, const std::vector<std::filesystem::path>& files, Manifest& manifest)
+	{
+		manifest.entries.clear();
+		manifest.entries.reserve(files.size());
+
+		for (auto& file : files)
+		{
+			Entry e;
+			e.path = file.lexically_normal().generic_string();
+
+			std::error_code ec;
+			e.size = std::filesystem::file_size(root / file, ec);
+			if (ec || !Hash::ComputeFile(root / file, e.hash))
+			{
+				HE_ERROR("ArtifactStore : unable to read {}", (root / file).string());
+				return false;
+			}
+
+			manifest.entries.push_back(std::move(e));
+		}
+
+		std::sort(manifest.entries.begin(), manifest.entries.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+
+		return true;
+	}
+
+	bool FetchFromDirectory(const std::filesystem::path& storeRoot, const Key& key, const std::filesystem::path& root)
+	{
+		auto keyDir = storeRoot / key.commit / key.toolchain / key.config;
+
+		Manifest manifest;
+		if (!manifest.Read(keyDir / c_ManifestFileName))
+			return false;
+
+		for (auto& e : manifest.entries)
+		{
+			auto dst = root / e.path;
+
+			std::error_code ec;
+			std::filesystem::create_directories(dst.parent_path(), ec);
+			std::filesystem::copy_file(keyDir / c_FilesDirName / e.path, dst, std::filesystem::copy_options::overwrite_existing, ec);
+			if (ec)
+			{
+				HE_ERROR("ArtifactStore : {} : {}", e.path, ec.message());
+				return false;
+			}
+		}
+
+		return Verify(root, manifest);
+	}
+
+	bool PublishToDirectory(const std::filesystem::path& storeRoot, const Key& key, const std::filesystem::path& root, const Manifest& manifest)
+	{
+		auto toolchainDir = storeRoot / key.commit / key.toolchain;
+		auto keyDir = toolchainDir / key.config;
+		if (std::filesystem::exists(keyDir / c_ManifestFileName))
+			return true;
+
+		// stage next to the final location so the publish is a single rename
+		auto tmpDir = toolchainDir / std::format(".{}-{:x}", key.config, std::chrono::steady_clock::now().time_since_epoch().count());
+
+		std::error_code ec;
+		for (auto& e : manifest.entries)
+		{
+			auto dst = tmpDir / c_FilesDirName / e.path;
+			std::filesystem::create_directories(dst.parent_path(), ec);
+			std::filesystem::copy_file(root / e.path, dst, std::filesystem::copy_options::overwrite_existing, ec);
+			if (ec)
+			{
+				HE_ERROR("ArtifactStore : {} : {}", e.path, ec.message());
+				std::filesystem::remove_all(tmpDir, ec);
+				return false;
+			}
+		}
+
+		if (!manifest.Write(tmpDir / c_ManifestFileName))
+		{
+			std::filesystem::remove_all(tmpDir, ec);
+			return false;
+		}
+
+		std::filesystem::rename(tmpDir, keyDir, ec);
+		if (ec)
+		{
+			// another client published the same key first
+			std::filesystem::remove_all(tmpDir, ec);
+			return std::filesystem::exists(keyDir / c_ManifestFileName);
+		}
+
+		return true;
+	}
+
+	bool FetchFromHttp(std::string_view location, const Key& key, const std::filesystem::path& root)
+	{
+		auto tmp = GetTempDirectory();
+		auto manifestPath = tmp / std::format("{}-{}-{}.manifest", key.commit, key.toolchain, key.config);
+
+		// a missing manifest is a cache miss
+		Manifest manifest;
+		bool found = Curl(std::format("-f -s -L -o \"{}\" \"{}\"", manifestPath.string(), GetUrl(location, key, c_ManifestFileName))) && manifest.Read(manifestPath);
+		std::error_code ec;
+		std::filesystem::remove(manifestPath, ec);
+
+		if (!found)
+			return false;
+
+		// one curl process for all files
+		auto configPath = tmp / std::format("{}-{}-{}.fetch", key.commit, key.toolchain, key.config);
+		{
+			std::ofstream config(configPath);
+			for (auto& e : manifest.entries)
+			{
+				config << "url = \"" << GetUrl(location, key, std::format("{}/{}", c_FilesDirName, e.path)) << "\"\n";
+				config << "output = \"" << (root / e.path).generic_string() << "\"\n";
+			}
+		}
+
+		bool fetched = Curl(std::format("-f -s -L --create-dirs --parallel --fail-early -K \"{}\"", configPath.string()));
+		std::filesystem::remove(configPath, ec);
+
+		if (!fetched)
+		{
+			HE_ERROR("ArtifactStore : download failed {}", key.ToString());
+			return false;
+		}
+
+		return Verify(root, manifest);
+	}
+
+	bool PublishToHttp(std::string_view location, const Key& key, const std::filesystem::path& root, const Manifest& manifest)
+	{
+		auto tmp = GetTempDirectory();
+		auto manifestPath = tmp / std::format("{}-{}-{}.manifest", key.commit, key.toolchain, key.config);
+		if (!manifest.Write(manifestPath))
+			return false;
+
+		auto configPath = tmp / std::format("{}-{}-{}.publish", key.commit, key.toolchain, key.config);
+		{
+			std::ofstream config(configPath);
+			for (auto& e : manifest.entries)
+			{
+				config << "upload-file = \"" << (root / e.path).generic_string() << "\"\n";
+				config << "url = \"" << GetUrl(location, key, std::format("{}/{}", c_FilesDirName, e.path)) << "\"\n";
+			}
+		}
+
+		// manifest goes last and only after every file, readers never see a key without its files
+		bool published = Curl(std::format("-f -s --parallel --fail-early -K \"{}\"", configPath.string())) &&
+			Curl(std::format("-f -s -T \"{}\" \"{}\"", manifestPath.string(), GetUrl(location, key, c_ManifestFileName)));
+
+		if (!published)
+			HE_ERROR("ArtifactStore : upload failed {}", key.ToString());
+
+		std::error_code ec;
+		std::filesystem::remove(configPath, ec);
+		std::filesystem::remove(manifestPath, ec);
+
+		return published;
+	}
+}
+
+export namespace ArtifactStore {
+
+	// Downloads the artifacts of `key` into `root`, returns true only if every file matched the manifest.
+	bool Fetch(std::string_view location, const Key& key, const std::filesystem::path& root)
+	{
+		HE_PROFILE_FUNCTION();
+
+		if (!key.IsValid())
+			return false;
+
+		bool fetched = false;
+		switch (GetBackend(location))
+		{
+		case Backend::None: return false;
+		case Backend::Directory: fetched = FetchFromDirectory(GetDirectoryRoot(location), key, root); break;
+		case Backend::Http: fetched = FetchFromHttp(location, key, root); break;
+		}
+
+		if (fetched)
+			HE_INFO("ArtifactStore : fetched {}", key.ToString());
+
+		return fetched;
+	}
+
+	// Publishes `files` (relative to `root`) under `key`.
+	bool Publish(std::string_view location, const Key& key, const std::filesystem::path& root, const std::vector<std::filesystem::path>& files)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto backend = GetBackend(location);
+		if (backend == Backend::None || files.empty() || !key.IsValid())
+			return false;
+
+		Manifest manifest;
+		if (!BuildManifest(root, files, manifest))
+			return false;
+
+		bool published = false;
+		switch (backend)
+		{
+		case Backend::None: break;
+		case Backend::Directory: published = PublishToDirectory(GetDirectoryRoot(location), key, root, manifest); break;
+		case Backend::Http: published = PublishToHttp(location, key, root, manifest); break;
+		}
+
+		if (published)
+			HE_INFO("ArtifactStore : published {}", key.ToString());
+
+		return published;
+	}
+}
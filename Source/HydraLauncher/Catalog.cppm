@@ -0,0 +1,288 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Catalog;
+
+import HE;
+import std;
+import simdjson;
+import Json;
+import Http;
+import Snapshot;
+
+// Revisioned remote catalog of plugins and templates.
+//
+//   GET <url>?since=<revision>   (no query on the first sync)
+//
+//   {
+//       "revision" : 42,              catalog revision this page belongs to
+//       "full" : false,               the pages replace the catalog instead of patching it, true when omitted
+//       "next" : "page-2.json",       optional, absolute or relative url of the next page
+//       "plugins" : [ ... ],          added or changed entries, { "name", "description", "URL" }
+//       "templates" : [ ... ],
+//       "removedPlugins" : [ "name" ],
+//       "removedTemplates" : [ "name" ]
+//   }
+//
+// A plain remoteInfo.json is a valid single full page, so a static file server works as a stand-in, and a
+// server that ignores `since` just sends the full catalog again.
+
+export namespace Catalog {
+
+	struct Entry
+	{
+		std::string name;
+		std::string description;
+		std::string URL;
+	};
+
+	struct Page
+	{
+		uint64_t revision = 0;
+		bool full = true;
+		std::string next;
+		std::vector<Entry> plugins;
+		std::vector<Entry> templates;
+		std::vector<std::string> removedPlugins;
+		std::vector<std::string> removedTemplates;
+	};
+}
+
+template<>
+struct Json::Schema<Catalog::Entry>
+{
+	static constexpr auto fields = std::tuple{
+		Json::MakeField("name", &Catalog::Entry::name),
+		Json::MakeField("description", &Catalog::Entry::description),
+		Json::MakeField("URL", &Catalog::Entry::URL),
+	};
+};
+
+template<>
+struct Json::Schema<Catalog::Page>
+{
+	static constexpr auto fields = std::tuple{
+		Json::MakeField("revision", &Catalog::Page::revision),
+		Json::MakeField("full", &Catalog::Page::full),
+		Json::MakeField("next", &Catalog::Page::next),
+		Json::MakeField("plugins", &Catalog::Page::plugins),
+		Json::MakeField("templates", &Catalog::Page::templates),
+		Json::MakeField("removedPlugins", &Catalog::Page::removedPlugins),
+		Json::MakeField("removedTemplates", &Catalog::Page::removedTemplates),
+	};
+};
+
+// Internal
+namespace Catalog {
+
+	constexpr uint32_t c_IndexSchema = 1;
+	constexpr uint32_t c_MaxPages = 10000;
+
+	struct IndexSection
+	{
+		enum : uint32_t
+		{
+			Meta,
+			Plugins,
+			Templates
+		};
+	};
+
+	struct MetaRecord
+	{
+		uint64_t revision;
+		uint32_t etag;
+		uint32_t lastModified;
+	};
+
+	struct EntryRecord
+	{
+		uint32_t name;
+		uint32_t description;
+		uint32_t URL;
+	};
+
+	// next page url, relative ones resolve against the page that named them
+	std::string Resolve(std::string_view base, std::string_view next)
+	{
+		if (next.find("://") != std::string_view::npos)
+			return std::string(next);
+
+		base = base.substr(0, base.find('?'));
+		size_t scheme = base.find("://");
+		size_t pathStart = scheme == std::string_view::npos ? 0 : base.find('/', scheme + 3);
+		if (pathStart == std::string_view::npos)
+			pathStart = base.size();
+
+		if (next.starts_with('/'))
+			return std::format("{}{}", base.substr(0, pathStart), next);
+
+		size_t slash = base.rfind('/');
+		if (slash == std::string_view::npos || slash < pathStart)
+			return std::format("{}/{}", base, next);
+
+		return std::format("{}{}", base.substr(0, slash + 1), next);
+	}
+}
+
+export namespace Catalog {
+
+	using EntryMap = std::map<std::string, Entry, std::less<>>;
+
+	// Local copy of the catalog, kept in a compact binary file next to db.json.
+	struct Index
+	{
+		uint64_t revision = 0;
+		std::string etag;
+		std::string lastModified;
+		EntryMap plugins;
+		EntryMap templates;
+
+		void Apply(Page& page)
+		{
+			for (auto& e : page.plugins)
+				plugins.insert_or_assign(e.name, e);
+			for (auto& e : page.templates)
+				templates.insert_or_assign(e.name, e);
+			for (const auto& name : page.removedPlugins)
+				plugins.erase(name);
+			for (const auto& name : page.removedTemplates)
+				templates.erase(name);
+		}
+
+		bool Load(const std::filesystem::path& filePath)
+		{
+			HE_PROFILE_FUNCTION();
+
+			Snapshot::Reader reader;
+			if (!reader.Open(filePath, c_IndexSchema))
+				return false;
+
+			auto meta = reader.GetSection<MetaRecord>(IndexSection::Meta);
+			if (meta.size() != 1)
+				return false;
+
+			revision = meta[0].revision;
+			etag = reader.GetString(meta[0].etag);
+			lastModified = reader.GetString(meta[0].lastModified);
+
+			auto read = [&](uint32_t section, EntryMap& map) {
+				map.clear();
+				for (const auto& r : reader.GetSection<EntryRecord>(section))
+				{
+					Entry e = { std::string(reader.GetString(r.name)), std::string(reader.GetString(r.description)), std::string(reader.GetString(r.URL)) };
+					map.emplace_hint(map.end(), e.name, std::move(e));
+				}
+			};
+
+			read(IndexSection::Plugins, plugins);
+			read(IndexSection::Templates, templates);
+			return true;
+		}
+
+		bool Save(const std::filesystem::path& filePath) const
+		{
+			HE_PROFILE_FUNCTION();
+
+			Snapshot::Writer writer;
+
+			MetaRecord meta = { revision, writer.Intern(etag), writer.Intern(lastModified) };
+			writer.AddSection<MetaRecord>(IndexSection::Meta, std::span(&meta, 1));
+
+			auto write = [&](uint32_t section, const EntryMap& map) {
+				std::vector<EntryRecord> records;
+				records.reserve(map.size());
+				for (const auto& [name, e] : map)
+					records.push_back({ writer.Intern(e.name), writer.Intern(e.description), writer.Intern(e.URL) });
+				writer.AddSection<EntryRecord>(section, records);
+			};
+
+			write(IndexSection::Plugins, plugins);
+			write(IndexSection::Templates, templates);
+			return writer.Write(filePath, c_IndexSchema);
+		}
+	};
+
+	enum class SyncResult : uint8_t
+	{
+		UpToDate,
+		Updated,
+		Failed
+	};
+
+	struct SyncSummary
+	{
+		SyncResult result = SyncResult::Failed;
+		bool reset = false; // the server sent a full catalog, entries the index no longer has are gone
+		uint32_t pages = 0;
+	};
+
+	// Brings index up to date with the server. onPage gets every page as soon as it parsed, before the next one
+	// is requested, and after index applied it. On failure index may hold part of an update, do not save it.
+	SyncSummary Sync(const std::string& url, Index& index, const std::function<void(Page& page)>& onPage)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		SyncSummary summary;
+
+		Http::Request request;
+		request.url = index.revision ? std::format("{}{}since={}", url, url.contains('?') ? "&" : "?", index.revision) : url;
+		request.etag = index.etag;
+		request.lastModified = index.lastModified;
+
+		simdjson::ondemand::document doc;
+		while (true)
+		{
+			auto response = Http::Get(request);
+			if (summary.pages == 0 && response.IsNotModified())
+			{
+				summary.result = SyncResult::UpToDate;
+				return summary;
+			}
+
+			if (!response.IsOk())
+			{
+				HE_ERROR("Catalog : {} status {} {}", request.url, response.status, response.error);
+				return summary;
+			}
+
+			Page page;
+			if (!Json::Parse(response.body, doc) || !Json::Read(doc, page))
+			{
+				HE_ERROR("Catalog : unable to parse {}", request.url);
+				return summary;
+			}
+
+			if (summary.pages == 0)
+			{
+				index.etag = response.etag;
+				index.lastModified = response.lastModified;
+
+				if (page.full)
+				{
+					summary.reset = true;
+					index.plugins.clear();
+					index.templates.clear();
+				}
+			}
+
+			index.Apply(page);
+			index.revision = page.revision;
+			onPage(page);
+
+			if (++summary.pages >= c_MaxPages || page.next.empty())
+				break;
+
+			request = { Resolve(request.url, page.next) };
+		}
+
+		summary.result = SyncResult::Updated;
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		HE_INFO("Catalog : revision {}, {} pages, {} plugins, {} templates in {:.3f}s", index.revision, summary.pages, index.plugins.size(), index.templates.size(), seconds);
+
+		return summary;
+	}
+}
@@ -0,0 +1,176 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module CopyEngine;
+
+import HE;
+import std;
+
+export namespace CopyEngine {
+
+	struct Progress
+	{
+		std::atomic<uint64_t> totalBytes = 0;
+		std::atomic<uint64_t> completedBytes = 0;
+		std::atomic<uint32_t> totalFiles = 0;
+		std::atomic<uint32_t> completedFiles = 0;
+		std::atomic<uint32_t> failedFiles = 0;
+		std::atomic<bool> running = false;
+
+		Progress() = default;
+		Progress(const Progress& other) { *this = other; }
+		Progress& operator=(const Progress& other)
+		{
+			totalBytes = other.totalBytes.load();
+			completedBytes = other.completedBytes.load();
+			totalFiles = other.totalFiles.load();
+			completedFiles = other.completedFiles.load();
+			failedFiles = other.failedFiles.load();
+			running = other.running.load();
+			return *this;
+		}
+
+		float GetFraction() const
+		{
+			uint64_t total = totalBytes.load();
+			if (total > 0)
+				return (float)((double)completedBytes.load() / (double)total);
+
+			uint32_t files = totalFiles.load();
+			return files > 0 ? (float)completedFiles.load() / (float)files : 0.0f;
+		}
+	};
+
+	struct Job
+	{
+		std::filesystem::path src;
+		std::filesystem::path dst;
+		uint64_t size = 0;
+		std::function<bool(const Job&)> op; // replaces the plain copy when set, dst may then be empty
+	};
+
+	// Worker count used when none is given, enough to keep an NVMe queue busy without oversubscribing.
+	uint32_t GetDefaultWorkerCount()
+	{
+		return std::clamp(std::thread::hardware_concurrency(), 1u, 16u);
+	}
+
+	// Fans file jobs across a fixed pool of workers. Copies go through the OS (copy_file / CopyFile2), so
+	// memory stays bounded by the job list no matter how large the files are.
+	class Queue
+	{
+	public:
+		std::vector<Job> jobs;
+		std::vector<std::filesystem::path> directories; // created up front, including empty ones
+
+		void Add(const std::filesystem::path& src, const std::filesystem::path& dst, uint64_t size = 0, std::function<bool(const Job&)> op = {})
+		{
+			jobs.push_back({ src, dst, size, std::move(op) });
+		}
+
+		// Queues every file under srcDir, mirrored into dstDir.
+		void AddDirectory(const std::filesystem::path& srcDir, const std::filesystem::path& dstDir)
+		{
+			std::error_code ec;
+			directories.push_back(dstDir);
+
+			for (auto it = std::filesystem::recursive_directory_iterator(srcDir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+			{
+				auto dst = dstDir / it->path().lexically_relative(srcDir);
+				if (it->is_directory(ec))
+				{
+					directories.push_back(dst);
+				}
+				else if (it->is_regular_file(ec))
+				{
+					uint64_t size = it->file_size(ec);
+					Add(it->path(), dst, ec ? 0 : size);
+				}
+			}
+		}
+
+		// Blocks until every job ran, returns false if any of them failed.
+		bool Run(Progress* progress = nullptr, uint32_t workerCount = 0)
+		{
+			HE_PROFILE_FUNCTION();
+
+			Progress localProgress;
+			Progress& p = progress ? *progress : localProgress;
+
+			// largest first, the long copies start early instead of trailing at the end
+			std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+
+			uint64_t totalBytes = 0;
+			for (const auto& job : jobs)
+				totalBytes += job.size;
+
+			p.totalBytes += totalBytes;
+			p.totalFiles += (uint32_t)jobs.size();
+			p.running = true;
+
+			{
+				std::error_code ec;
+				std::set<std::filesystem::path> parents(directories.begin(), directories.end());
+				for (const auto& job : jobs)
+				{
+					if (!job.dst.empty())
+						parents.insert(job.dst.parent_path());
+				}
+
+				for (const auto& dir : parents)
+					std::filesystem::create_directories(dir, ec);
+			}
+
+			std::atomic<size_t> next = 0;
+			auto worker = [this, &p, &next]() {
+				while (true)
+				{
+					size_t index = next.fetch_add(1);
+					if (index >= jobs.size())
+						break;
+
+					const Job& job = jobs[index];
+
+					bool ok;
+					if (job.op)
+					{
+						ok = job.op(job);
+					}
+					else
+					{
+						std::error_code ec;
+						ok = std::filesystem::copy_file(job.src, job.dst, std::filesystem::copy_options::overwrite_existing, ec);
+						if (ec)
+						{
+							HE_ERROR("CopyEngine : {} : {}", job.src.string(), ec.message());
+							ok = false;
+						}
+					}
+
+					if (!ok)
+						p.failedFiles++;
+
+					p.completedBytes += job.size;
+					p.completedFiles++;
+				}
+			};
+
+			if (workerCount == 0)
+				workerCount = GetDefaultWorkerCount();
+			workerCount = (uint32_t)std::min<size_t>(workerCount, jobs.size());
+
+			{
+				std::vector<std::jthread> threads;
+				for (uint32_t i = 1; i < workerCount; i++)
+					threads.emplace_back(worker);
+
+				worker();
+			}
+
+			p.running = false;
+
+			return p.failedFiles == 0;
+		}
+	};
+}
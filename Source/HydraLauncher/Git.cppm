@@ -27,6 +27,13 @@ export namespace Git {
 		std::string stepName;
 
 		CloneState cloneState;
+
+		// the stages of an engine install count steps from several threads at once
+		void CompleteSteps(size_t count = 1) { std::atomic_ref(completedSteps).fetch_add(count, std::memory_order_relaxed); }
+		void AddSteps(size_t count = 1) { std::atomic_ref(totalSteps).fetch_add(count, std::memory_order_relaxed); }
+
+		// called on the cloning thread after each file is written by checkout, path is relative to the repo
+		std::function<void(const char* path)> onCheckout;
 	};
 	
 	using ::git_repository;
@@ -49,10 +56,16 @@ namespace Git {
 	void CheckoutProgress(const char* path, size_t cur, size_t tot, void* payload)
 	{
 		ProgressInfo* progress = (ProgressInfo*)payload;
-		//if (path)
-		//{
-		//	HE_INFO("({}/{}) : {}", tot, cur, path);
-		//}
+		if (path && progress->onCheckout)
+			progress->onCheckout(path);
+	}
+
+	// libgit2's local transport has no shallow fetch, local mirrors are cloned whole
+	int FetchDepth(const char* url)
+	{
+		std::string_view str = url ? url : "";
+		std::error_code ec;
+		return str.starts_with("file://") || std::filesystem::exists(str, ec) ? 0 : 1;
 	}
 }
 
@@ -103,7 +116,7 @@ export namespace Git {
 			progress->cloneState = CloneState::Cloning;
 
 			git_submodule_update_options opts = GIT_SUBMODULE_UPDATE_OPTIONS_INIT;
-			opts.fetch_opts.depth = 1;
+			opts.fetch_opts.depth = FetchDepth(git_submodule_url(sm));
 			opts.checkout_opts.checkout_strategy = GIT_CHECKOUT_SAFE;
 			opts.checkout_opts.progress_cb = CheckoutProgress;
 			opts.checkout_opts.progress_payload = progress;
@@ -111,7 +124,7 @@ export namespace Git {
 			opts.fetch_opts.callbacks.payload = progress;
 
 			HE_INFO("Updating submodule: {}", name);
-			progress->completedSteps++;
+			progress->CompleteSteps();
 			progress->stepName = name;
 
 			progress->fetchProgress = { 0 };
@@ -121,7 +134,7 @@ export namespace Git {
 			git_repository* sub_repo = nullptr;
 			if (git_submodule_open(&sub_repo, sm) == 0 && sub_repo)
 			{
-				progress->totalSteps += GetSubmodulesCount(sub_repo);
+				progress->AddSteps(GetSubmodulesCount(sub_repo));
 
 				err |= IntrnalUpdateAllSubmodules(sub_repo, progress);
 				git_repository_free(sub_repo);
@@ -162,7 +175,7 @@ export namespace Git {
 		git_clone_options clone_opts = GIT_CLONE_OPTIONS_INIT;
 		git_checkout_options checkout_opts = GIT_CHECKOUT_OPTIONS_INIT;
 
-		clone_opts.fetch_opts.depth = 1;
+		clone_opts.fetch_opts.depth = FetchDepth(url);
 		checkout_opts.checkout_strategy = GIT_CHECKOUT_SAFE;
 		checkout_opts.progress_cb = CheckoutProgress;
 		checkout_opts.progress_payload = &progress;
@@ -172,7 +185,7 @@ export namespace Git {
 		progress.cloneState = CloneState::Cloning;
 
 		HE_INFO("Clone : {}", path);
-		progress.completedSteps++;
+		progress.CompleteSteps();
 		err = git_clone(&repo, url, path, &clone_opts);
 
 		if (err != 0)
@@ -202,7 +215,7 @@ export namespace Git {
 
 		if (repo && err == 0)
 		{
-			progress.totalSteps += GetSubmodulesCount(repo);
+			progress.AddSteps(GetSubmodulesCount(repo));
 
 			err = UpdateAllSubmodules(repo, progress);
 		}
@@ -216,7 +229,7 @@ export namespace Git {
 		return err == 0 ? CloneState::Completed : CloneState::Faild;
 	}
 
-	std::string GetCurrentCommitId(const std::filesystem::path& repoPath)
+	std::string GetCurrentCommitId(const std::filesystem::path& repoPath, size_t length = 7)
 	{
 		git_repository* repo = nullptr;
 		auto fileStr = repoPath.string();
@@ -269,6 +282,6 @@ export namespace Git {
 		git_reference_free(headRef);
 		git_repository_free(repo);
 
-		return std::string(oidStr,7);
+		return std::string(oidStr, std::min(length, (size_t)GIT_OID_HEXSZ));
 	}
 }
\ No newline at end of file
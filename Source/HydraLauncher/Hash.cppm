@@ -0,0 +1,203 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Hash;
+
+import HE;
+import std;
+
+// Internal
+namespace Hash {
+
+	constexpr uint64_t c_Prime1 = 0x9E3779B185EBCA87ULL;
+	constexpr uint64_t c_Prime2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr uint64_t c_Prime3 = 0x165667B19E3779F9ULL;
+	constexpr uint64_t c_Prime4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr uint64_t c_Prime5 = 0x27D4EB2F165667C5ULL;
+
+	inline uint64_t Read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+	inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+	inline uint64_t Round(uint64_t acc, uint64_t input)
+	{
+		acc += input * c_Prime2;
+		acc = std::rotl(acc, 31);
+		return acc * c_Prime1;
+	}
+
+	inline uint64_t MergeRound(uint64_t acc, uint64_t val)
+	{
+		acc ^= Round(0, val);
+		return acc * c_Prime1 + c_Prime4;
+	}
+
+	inline uint64_t Finalize(uint64_t h, const uint8_t* p, size_t len)
+	{
+		while (len >= 8)
+		{
+			h ^= Round(0, Read64(p));
+			h = std::rotl(h, 27) * c_Prime1 + c_Prime4;
+			p += 8; len -= 8;
+		}
+
+		if (len >= 4)
+		{
+			h ^= uint64_t(Read32(p)) * c_Prime1;
+			h = std::rotl(h, 23) * c_Prime2 + c_Prime3;
+			p += 4; len -= 4;
+		}
+
+		while (len > 0)
+		{
+			h ^= (*p) * c_Prime5;
+			h = std::rotl(h, 11) * c_Prime1;
+			p++; len--;
+		}
+
+		h ^= h >> 33;
+		h *= c_Prime2;
+		h ^= h >> 29;
+		h *= c_Prime3;
+		h ^= h >> 32;
+
+		return h;
+	}
+}
+
+export namespace Hash {
+
+	// Streaming XXH64, used to fingerprint files the launcher moves around (artifacts, staged output).
+	class XXH64
+	{
+	public:
+		XXH64(uint64_t seed = 0) { Reset(seed); }
+
+		void Reset(uint64_t seed = 0)
+		{
+			v[0] = seed + c_Prime1 + c_Prime2;
+			v[1] = seed + c_Prime2;
+			v[2] = seed;
+			v[3] = seed - c_Prime1;
+			this->seed = seed;
+			totalLength = 0;
+			bufferSize = 0;
+		}
+
+		void Update(const void* data, size_t size)
+		{
+			const uint8_t* p = (const uint8_t*)data;
+			const uint8_t* end = p + size;
+			totalLength += size;
+
+			if (bufferSize + size < 32)
+			{
+				std::memcpy(buffer + bufferSize, p, size);
+				bufferSize += (uint32_t)size;
+				return;
+			}
+
+			if (bufferSize)
+			{
+				uint32_t fill = 32 - bufferSize;
+				std::memcpy(buffer + bufferSize, p, fill);
+				Consume(buffer);
+				p += fill;
+				bufferSize = 0;
+			}
+
+			while (p + 32 <= end)
+			{
+				Consume(p);
+				p += 32;
+			}
+
+			bufferSize = (uint32_t)(end - p);
+			if (bufferSize)
+				std::memcpy(buffer, p, bufferSize);
+		}
+
+		uint64_t Digest() const
+		{
+			uint64_t h;
+			if (totalLength >= 32)
+			{
+				h = std::rotl(v[0], 1) + std::rotl(v[1], 7) + std::rotl(v[2], 12) + std::rotl(v[3], 18);
+				h = MergeRound(h, v[0]);
+				h = MergeRound(h, v[1]);
+				h = MergeRound(h, v[2]);
+				h = MergeRound(h, v[3]);
+			}
+			else
+			{
+				h = seed + c_Prime5;
+			}
+
+			h += totalLength;
+
+			return Finalize(h, buffer, bufferSize);
+		}
+
+	private:
+		void Consume(const uint8_t* p)
+		{
+			v[0] = Round(v[0], Read64(p));
+			v[1] = Round(v[1], Read64(p + 8));
+			v[2] = Round(v[2], Read64(p + 16));
+			v[3] = Round(v[3], Read64(p + 24));
+		}
+
+		uint64_t v[4];
+		uint64_t seed;
+		uint64_t totalLength;
+		uint8_t buffer[32];
+		uint32_t bufferSize;
+	};
+
+	uint64_t Compute(const void* data, size_t size, uint64_t seed = 0)
+	{
+		XXH64 state(seed);
+		state.Update(data, size);
+		return state.Digest();
+	}
+
+	uint64_t Compute(std::string_view str, uint64_t seed = 0)
+	{
+		return Compute(str.data(), str.size(), seed);
+	}
+
+	// returns false if the file can't be read
+	bool ComputeFile(const std::filesystem::path& path, uint64_t& outHash)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		constexpr size_t bufferSize = 1 << 16;
+		static thread_local std::vector<char> buffer(bufferSize);
+
+		XXH64 state;
+		while (file)
+		{
+			file.read(buffer.data(), bufferSize);
+			state.Update(buffer.data(), (size_t)file.gcount());
+		}
+
+		outHash = state.Digest();
+		return !file.bad();
+	}
+
+	std::string ToString(uint64_t hash)
+	{
+		return std::format("{:016x}", hash);
+	}
+
+	bool FromString(std::string_view str, uint64_t& outHash)
+	{
+		if (str.size() != 16)
+			return false;
+
+		auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), outHash, 16);
+		return ec == std::errc() && ptr == str.data() + str.size();
+	}
+}
@@ -0,0 +1,697 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#ifdef HE_PLATFORM_WINDOWS
+#include <windows.h>
+#include <winhttp.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+export module Http;
+
+import HE;
+import std;
+import Zip;
+import Utils;
+
+export namespace Http {
+
+	struct Request
+	{
+		std::string url;
+		std::string etag;                                             // sent as If-None-Match
+		std::string lastModified;                                     // sent as If-Modified-Since
+		std::chrono::milliseconds timeout = std::chrono::seconds(15); // whole request, redirects included
+		uint32_t maxRedirects = 5;
+	};
+
+	struct Response
+	{
+		int status = 0;           // 0 when no response was received, see error
+		std::string body;         // content encoding already removed
+		std::string etag;
+		std::string lastModified;
+		std::string error;
+
+		bool IsOk() const { return status >= 200 && status < 300 && error.empty(); }
+		bool IsNotModified() const { return status == 304; }
+	};
+}
+
+// Internal
+namespace Http {
+
+	using Clock = std::chrono::steady_clock;
+
+	bool IEquals(std::string_view a, std::string_view b)
+	{
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower((uint8_t)x) == std::tolower((uint8_t)y); });
+	}
+
+	std::string_view Trim(std::string_view str)
+	{
+		while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+			str.remove_prefix(1);
+		while (!str.empty() && (str.back() == ' ' || str.back() == '\t' || str.back() == '\r'))
+			str.remove_suffix(1);
+		return str;
+	}
+
+	// we only advertise gzip, zstd has no in-process decoder here
+	constexpr const char* c_AcceptEncoding = "gzip";
+
+	bool Decode(std::string_view encoding, Response& response)
+	{
+		encoding = Trim(encoding);
+		if (encoding.empty() || IEquals(encoding, "identity"))
+			return true;
+
+		if (IEquals(encoding, "gzip") || IEquals(encoding, "x-gzip"))
+		{
+			std::string decoded;
+			if (!Zip::Gunzip((const uint8_t*)response.body.data(), response.body.size(), decoded))
+			{
+				response.error = "invalid gzip body";
+				return false;
+			}
+
+			response.body = std::move(decoded);
+			return true;
+		}
+
+		response.error = std::format("unsupported content encoding {}", encoding);
+		return false;
+	}
+
+	// file:// urls are read from disk, the query is ignored as a static file server would
+	Response GetFile(std::string_view url)
+	{
+		url.remove_prefix(std::string_view("file://").size());
+		url = url.substr(0, url.find_first_of("?#"));
+
+		// file:///C:/dir
+		if (url.size() > 2 && url[0] == '/' && url[2] == ':')
+			url.remove_prefix(1);
+
+		Response response;
+		std::ifstream file(std::filesystem::path(url), std::ios::binary);
+		if (!file.is_open())
+		{
+			response.status = 404;
+			return response;
+		}
+
+		response.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		response.status = file.bad() ? 500 : 200;
+		return response;
+	}
+
+#ifndef HE_PLATFORM_WINDOWS
+
+	struct Url
+	{
+		std::string host;
+		std::string port = "80";
+		std::string target = "/";
+
+		// http only, https goes through GetWithCurl as no TLS stack is linked on this platform
+		static bool Parse(std::string_view url, Url& out)
+		{
+			constexpr std::string_view c_Scheme = "http://";
+			if (url.size() < c_Scheme.size() || !IEquals(url.substr(0, c_Scheme.size()), c_Scheme))
+				return false;
+
+			url.remove_prefix(c_Scheme.size());
+			size_t slash = url.find_first_of("/?");
+			std::string_view authority = url.substr(0, slash);
+			if (slash != std::string_view::npos)
+				out.target = url[slash] == '/' ? std::string(url.substr(slash)) : "/" + std::string(url.substr(slash));
+
+			size_t colon = authority.rfind(':');
+			if (colon != std::string_view::npos && authority.find(']', colon) == std::string_view::npos)
+			{
+				out.port = authority.substr(colon + 1);
+				authority = authority.substr(0, colon);
+			}
+
+			if (authority.size() > 2 && authority.front() == '[' && authority.back() == ']')
+				authority = authority.substr(1, authority.size() - 2);
+
+			out.host = authority;
+			return !out.host.empty();
+		}
+	};
+
+	int Remaining(Clock::time_point deadline)
+	{
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+		return (int)std::clamp<int64_t>(ms, 0, std::numeric_limits<int>::max());
+	}
+
+	class Socket
+	{
+	public:
+		~Socket() { if (fd >= 0) close(fd); }
+
+		bool Connect(const Url& url, Clock::time_point deadline, std::string& error)
+		{
+			addrinfo hints = {};
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+
+			addrinfo* list = nullptr;
+			if (int r = getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &list); r != 0)
+			{
+				error = std::format("unable to resolve {}, {}", url.host, gai_strerror(r));
+				return false;
+			}
+
+			for (addrinfo* ai = list; ai && fd < 0; ai = ai->ai_next)
+			{
+				fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+				if (fd < 0)
+					continue;
+
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+				bool connected = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+				if (!connected && errno == EINPROGRESS && Wait(POLLOUT, deadline))
+				{
+					int soError = 0;
+					socklen_t len = sizeof(soError);
+					connected = getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &len) == 0 && soError == 0;
+				}
+
+				if (!connected)
+				{
+					close(fd);
+					fd = -1;
+				}
+			}
+
+			freeaddrinfo(list);
+
+			if (fd < 0)
+				error = std::format("unable to connect to {}:{}", url.host, url.port);
+
+			return fd >= 0;
+		}
+
+		bool Send(std::string_view data, Clock::time_point deadline)
+		{
+			while (!data.empty())
+			{
+				ssize_t n = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+				if (n > 0)
+					data.remove_prefix(n);
+				else if (n < 0 && errno != EAGAIN && errno != EINTR)
+					return false;
+				else if (!Wait(POLLOUT, deadline))
+					return false;
+			}
+
+			return true;
+		}
+
+		// reads until the server closes the connection, which it does since we ask for Connection: close
+		bool ReceiveAll(std::string& out, Clock::time_point deadline)
+		{
+			char buffer[64 * 1024];
+			while (true)
+			{
+				ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+				if (n > 0)
+					out.append(buffer, n);
+				else if (n == 0)
+					return true;
+				else if (errno != EAGAIN && errno != EINTR)
+					return false;
+				else if (!Wait(POLLIN, deadline))
+					return false;
+			}
+		}
+
+	private:
+		bool Wait(short events, Clock::time_point deadline)
+		{
+			pollfd p = { fd, events, 0 };
+			int r;
+			do r = poll(&p, 1, Remaining(deadline));
+			while (r < 0 && errno == EINTR);
+
+			return r > 0;
+		}
+
+		int fd = -1;
+	};
+
+	bool Dechunk(std::string& body)
+	{
+		std::string out;
+		size_t pos = 0;
+		while (true)
+		{
+			size_t eol = body.find("\r\n", pos);
+			if (eol == std::string::npos)
+				return false;
+
+			size_t size = 0;
+			auto [ptr, ec] = std::from_chars(body.data() + pos, body.data() + eol, size, 16);
+			if (ec != std::errc() || ptr == body.data() + pos)
+				return false;
+
+			pos = eol + 2;
+			if (size == 0)
+				break;
+
+			if (pos + size > body.size())
+				return false;
+
+			out.append(body, pos, size);
+			pos += size + 2;
+		}
+
+		body = std::move(out);
+		return true;
+	}
+
+	std::string ShellQuote(std::string_view str)
+	{
+		std::string quoted = "'";
+		for (char c : str)
+			quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+
+		return quoted + "'";
+	}
+
+	// https through the curl executable, as the launcher did before this module. curl follows the redirects and
+	// removes the content encoding itself, the headers of the last response are read back from a file
+	Response GetWithCurl(const Request& request, std::string_view url, Clock::time_point deadline)
+	{
+		static std::atomic<uint32_t> counter = 0;
+		auto base = std::filesystem::temp_directory_path() / std::format("HydraLauncher-http-{}-{}", getpid(), counter++);
+		auto bodyPath = std::filesystem::path(base).concat(".body");
+		auto headerPath = std::filesystem::path(base).concat(".headers");
+
+		Response response;
+		double seconds = std::max(Remaining(deadline), 1) / 1000.0;
+		std::string cmd = std::format(
+			"curl -sS -L --compressed --max-redirs {} --max-time {:.3f} -o {} -D {}",
+			request.maxRedirects, seconds, ShellQuote(bodyPath.string()), ShellQuote(headerPath.string())
+		);
+		if (!request.etag.empty())
+			cmd += " -H " + ShellQuote("If-None-Match: " + request.etag);
+		if (!request.lastModified.empty())
+			cmd += " -H " + ShellQuote("If-Modified-Since: " + request.lastModified);
+		cmd += " " + ShellQuote(url);
+
+		int exitCode = Utils::RunProcess(cmd.c_str());
+
+		std::string headers;
+		if (std::ifstream file(headerPath, std::ios::binary); file.is_open())
+			headers.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		if (std::ifstream file(bodyPath, std::ios::binary); file.is_open())
+			response.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		std::error_code ec;
+		std::filesystem::remove(headerPath, ec);
+		std::filesystem::remove(bodyPath, ec);
+
+		if (exitCode != 0)
+		{
+			response.body.clear();
+			response.error = exitCode == 28 ? "timed out" : exitCode < 0 ? "unable to start curl" : std::format("curl exited with {}", exitCode);
+			return response;
+		}
+
+		// one block per response, redirects first
+		size_t start = headers.rfind("HTTP/");
+		while (start != std::string::npos && start > 0 && headers[start - 1] != '\n')
+			start = headers.rfind("HTTP/", start - 1);
+
+		if (start == std::string::npos)
+		{
+			response.error = "malformed response";
+			return response;
+		}
+
+		std::string_view block(headers.data() + start, headers.size() - start);
+		size_t space = block.find(' ');
+		if (space == std::string_view::npos || std::from_chars(block.data() + space + 1, block.data() + block.size(), response.status).ec != std::errc())
+		{
+			response.error = "malformed response";
+			return response;
+		}
+
+		while (!block.empty())
+		{
+			size_t eol = block.find('\n');
+			std::string_view line = block.substr(0, eol);
+			block = eol == std::string_view::npos ? std::string_view() : block.substr(eol + 1);
+
+			size_t colon = line.find(':');
+			if (colon == std::string_view::npos)
+				continue;
+
+			std::string_view name = Trim(line.substr(0, colon));
+			std::string_view value = Trim(line.substr(colon + 1));
+
+			if (IEquals(name, "ETag")) response.etag = value;
+			else if (IEquals(name, "Last-Modified")) response.lastModified = value;
+		}
+
+		return response;
+	}
+
+	bool IsHttps(std::string_view url)
+	{
+		return url.size() > 8 && IEquals(url.substr(0, 8), "https://");
+	}
+
+	Response Get(const Request& request, Clock::time_point deadline)
+	{
+		Response response;
+
+		std::string url = request.url;
+		for (uint32_t redirect = 0; ; redirect++)
+		{
+			if (IsHttps(url))
+			{
+				Request rest = request;
+				rest.maxRedirects = request.maxRedirects - redirect;
+				return GetWithCurl(rest, url, deadline);
+			}
+
+			Url parsed;
+			if (!Url::Parse(url, parsed))
+			{
+				response.error = std::format("unsupported url {}", url);
+				return response;
+			}
+
+			std::string host = parsed.host.find(':') != std::string::npos ? std::format("[{}]", parsed.host) : parsed.host;
+			if (parsed.port != "80")
+				host += ":" + parsed.port;
+
+			std::string req = std::format("GET {} HTTP/1.1\r\nHost: {}\r\nUser-Agent: HydraLauncher\r\nAccept-Encoding: {}\r\nConnection: close\r\n", parsed.target, host, c_AcceptEncoding);
+			if (!request.etag.empty())
+				req += std::format("If-None-Match: {}\r\n", request.etag);
+			if (!request.lastModified.empty())
+				req += std::format("If-Modified-Since: {}\r\n", request.lastModified);
+			req += "\r\n";
+
+			Socket socket;
+			std::string raw;
+			if (!socket.Connect(parsed, deadline, response.error))
+				return response;
+
+			if (!socket.Send(req, deadline) || !socket.ReceiveAll(raw, deadline))
+			{
+				response.error = Clock::now() >= deadline ? "timed out" : "connection failed";
+				return response;
+			}
+
+			size_t headerEnd = raw.find("\r\n\r\n");
+			if (headerEnd == std::string::npos || !raw.starts_with("HTTP/1.") || raw.size() < 12)
+			{
+				response.error = "malformed response";
+				return response;
+			}
+
+			std::from_chars(raw.data() + 9, raw.data() + 12, response.status);
+
+			std::string location;
+			std::string transferEncoding;
+			std::string contentEncoding;
+			size_t contentLength = std::string::npos;
+
+			size_t pos = raw.find("\r\n") + 2;
+			while (pos < headerEnd)
+			{
+				size_t eol = raw.find("\r\n", pos);
+				std::string_view line(raw.data() + pos, eol - pos);
+				pos = eol + 2;
+
+				size_t colon = line.find(':');
+				if (colon == std::string_view::npos)
+					continue;
+
+				std::string_view name = Trim(line.substr(0, colon));
+				std::string_view value = Trim(line.substr(colon + 1));
+
+				if (IEquals(name, "ETag")) response.etag = value;
+				else if (IEquals(name, "Last-Modified")) response.lastModified = value;
+				else if (IEquals(name, "Location")) location = value;
+				else if (IEquals(name, "Transfer-Encoding")) transferEncoding = value;
+				else if (IEquals(name, "Content-Encoding")) contentEncoding = value;
+				else if (IEquals(name, "Content-Length")) std::from_chars(value.data(), value.data() + value.size(), contentLength);
+			}
+
+			bool isRedirect = response.status == 301 || response.status == 302 || response.status == 303 || response.status == 307 || response.status == 308;
+			if (isRedirect && !location.empty())
+			{
+				if (redirect >= request.maxRedirects)
+				{
+					response.error = "too many redirects";
+					return response;
+				}
+
+				if (location.starts_with("/"))
+					url = std::format("http://{}{}", host, location);
+				else
+					url = location;
+
+				response = {};
+				continue;
+			}
+
+			response.body = raw.substr(headerEnd + 4);
+
+			if (IEquals(transferEncoding, "chunked"))
+			{
+				if (!Dechunk(response.body))
+				{
+					response.error = "malformed chunked body";
+					return response;
+				}
+			}
+			else if (contentLength != std::string::npos)
+			{
+				if (response.body.size() < contentLength)
+				{
+					response.error = "truncated body";
+					return response;
+				}
+
+				response.body.resize(contentLength);
+			}
+
+			Decode(contentEncoding, response);
+			return response;
+		}
+	}
+
+#else
+
+	struct Handle
+	{
+		HINTERNET h = nullptr;
+		~Handle() { if (h) WinHttpCloseHandle(h); }
+	};
+
+	// Owns a request handle and closes it once the deadline passes, which fails the WinHTTP call blocked on it.
+	// WinHTTP's own timeouts only bound each phase, this bounds the request as a whole like the socket client.
+	class Watchdog
+	{
+	public:
+		Watchdog(HINTERNET request, Clock::time_point deadline) : h(request)
+		{
+			thread = std::jthread([this, deadline]() {
+				std::unique_lock lock(mutex);
+				if (!cv.wait_until(lock, deadline, [this] { return done; }))
+				{
+					expired = true;
+					WinHttpCloseHandle(h);
+				}
+			});
+		}
+
+		~Watchdog()
+		{
+			{
+				std::lock_guard lock(mutex);
+				done = true;
+			}
+			cv.notify_all();
+			thread.join();
+
+			if (!expired)
+				WinHttpCloseHandle(h);
+		}
+
+		bool Expired()
+		{
+			std::lock_guard lock(mutex);
+			return expired;
+		}
+
+		HINTERNET h;
+
+	private:
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool done = false;
+		bool expired = false;
+		std::jthread thread;
+	};
+
+	std::wstring Widen(std::string_view str)
+	{
+		std::wstring out(MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), out.data(), (int)out.size());
+		return out;
+	}
+
+	std::string Narrow(std::wstring_view str)
+	{
+		std::string out(WideCharToMultiByte(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0, nullptr, nullptr), '\0');
+		WideCharToMultiByte(CP_UTF8, 0, str.data(), (int)str.size(), out.data(), (int)out.size(), nullptr, nullptr);
+		return out;
+	}
+
+	std::string QueryHeader(HINTERNET request, DWORD query)
+	{
+		DWORD size = 0;
+		WinHttpQueryHeaders(request, query, WINHTTP_HEADER_NAME_BY_INDEX, WINHTTP_NO_OUTPUT_BUFFER, &size, WINHTTP_NO_HEADER_INDEX);
+		if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || size == 0)
+			return {};
+
+		std::wstring value(size / sizeof(wchar_t), L'\0');
+		if (!WinHttpQueryHeaders(request, query, WINHTTP_HEADER_NAME_BY_INDEX, value.data(), &size, WINHTTP_NO_HEADER_INDEX))
+			return {};
+
+		value.resize(size / sizeof(wchar_t));
+		return Narrow(value);
+	}
+
+	// WinHTTP follows redirects itself, across hosts and to https
+	Response Get(const Request& request, Clock::time_point deadline)
+	{
+		Response response;
+		Watchdog* watchdog = nullptr;
+		auto fail = [&](const char* what) {
+			DWORD error = GetLastError();
+			response.status = 0;
+			response.error = watchdog && watchdog->Expired() ? "timed out" : std::format("{} failed, error {}", what, error);
+			return response;
+		};
+
+		std::wstring url = Widen(request.url);
+		URL_COMPONENTS components = {};
+		components.dwStructSize = sizeof(components);
+		components.dwHostNameLength = (DWORD)-1;
+		components.dwUrlPathLength = (DWORD)-1;
+		components.dwExtraInfoLength = (DWORD)-1;
+		if (!WinHttpCrackUrl(url.c_str(), (DWORD)url.size(), 0, &components))
+			return fail("WinHttpCrackUrl");
+
+		std::wstring host(components.lpszHostName, components.dwHostNameLength);
+		std::wstring target(components.lpszUrlPath, components.dwUrlPathLength + components.dwExtraInfoLength);
+
+		Handle session = { WinHttpOpen(L"HydraLauncher", WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0) };
+		if (!session.h)
+			return fail("WinHttpOpen");
+
+		// per phase, the watchdog below enforces the deadline
+		int timeout = (int)request.timeout.count();
+		WinHttpSetTimeouts(session.h, timeout, timeout, timeout, timeout);
+
+		DWORD maxRedirects = request.maxRedirects;
+		WinHttpSetOption(session.h, WINHTTP_OPTION_MAX_HTTP_AUTOMATIC_REDIRECTS, &maxRedirects, sizeof(maxRedirects));
+
+		Handle connection = { WinHttpConnect(session.h, host.c_str(), components.nPort, 0) };
+		if (!connection.h)
+			return fail("WinHttpConnect");
+
+		DWORD flags = components.nScheme == INTERNET_SCHEME_HTTPS ? WINHTTP_FLAG_SECURE : 0;
+		HINTERNET requestHandle = WinHttpOpenRequest(connection.h, L"GET", target.c_str(), nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
+		if (!requestHandle)
+			return fail("WinHttpOpenRequest");
+
+		Watchdog req(requestHandle, deadline);
+		watchdog = &req;
+
+		std::string headers = std::format("Accept-Encoding: {}\r\n", c_AcceptEncoding);
+		if (!request.etag.empty())
+			headers += std::format("If-None-Match: {}\r\n", request.etag);
+		if (!request.lastModified.empty())
+			headers += std::format("If-Modified-Since: {}\r\n", request.lastModified);
+
+		std::wstring wheaders = Widen(headers);
+		if (!WinHttpSendRequest(req.h, wheaders.c_str(), (DWORD)wheaders.size(), WINHTTP_NO_REQUEST_DATA, 0, 0, 0))
+			return fail("WinHttpSendRequest");
+
+		if (!WinHttpReceiveResponse(req.h, nullptr))
+			return fail("WinHttpReceiveResponse");
+
+		DWORD status = 0;
+		DWORD size = sizeof(status);
+		WinHttpQueryHeaders(req.h, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX, &status, &size, WINHTTP_NO_HEADER_INDEX);
+		response.status = (int)status;
+		response.etag = QueryHeader(req.h, WINHTTP_QUERY_ETAG);
+		response.lastModified = QueryHeader(req.h, WINHTTP_QUERY_LAST_MODIFIED);
+
+		while (true)
+		{
+			if (Clock::now() >= deadline)
+			{
+				response.status = 0;
+				response.error = "timed out";
+				return response;
+			}
+
+			DWORD available = 0;
+			if (!WinHttpQueryDataAvailable(req.h, &available))
+				return fail("WinHttpQueryDataAvailable");
+
+			if (available == 0)
+				break;
+
+			size_t offset = response.body.size();
+			response.body.resize(offset + available);
+
+			DWORD read = 0;
+			if (!WinHttpReadData(req.h, response.body.data() + offset, available, &read))
+				return fail("WinHttpReadData");
+
+			response.body.resize(offset + read);
+		}
+
+		Decode(QueryHeader(req.h, WINHTTP_QUERY_CONTENT_ENCODING), response);
+		return response;
+	}
+
+#endif
+}
+
+export namespace Http {
+
+	// Blocking GET, file:// urls included. A body that fails to decode is reported through error with the status kept.
+	Response Get(const Request& request)
+	{
+		HE_PROFILE_FUNCTION();
+
+		if (request.url.size() > 7 && IEquals(std::string_view(request.url).substr(0, 7), "file://"))
+			return GetFile(request.url);
+
+		return Get(request, Clock::now() + request.timeout);
+	}
+}
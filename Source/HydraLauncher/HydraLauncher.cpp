@@ -11,6 +11,24 @@ import simdjson;
 import ImGui;
 import Utils;
 import Git;
+import ArtifactStore;
+import Staging;
+import CopyEngine;
+import ResourcePack;
+import Integrity;
+import Package;
+import Zip;
+import Pipeline;
+import LibStore;
+import Persistence;
+import Json;
+import Snapshot;
+import Http;
+import Registry;
+import Catalog;
+import ProjectTemplate;
+import Ipc;
+import Rpc;
 
 using namespace HE;
 
@@ -65,6 +83,18 @@ struct FontSize
     };
 };
 
+// process exit codes of the headless commands
+struct ExitCode
+{
+    enum : int
+    {
+        Ok,
+        Failed,
+        Usage,
+        NotFound
+    };
+};
+
 struct CreateProjectStage
 {
     enum : uint8_t
@@ -110,6 +140,7 @@ struct InstallationState
         case Installing:   return "Installing";
         case Installed:	   return "Installed";
         case Wait:		   return "Wait";
+        case Build:		   return "Build";
         case Failed:	   return "Failed";
         }
 
@@ -123,6 +154,7 @@ struct InstallationState
         if (stateStr == "Installing")   return Installing;
         if (stateStr == "Installed")    return Installed;
         if (stateStr == "Wait")         return Wait;
+        if (stateStr == "Build")        return Build;
         if (stateStr == "Failed")       return Failed;
 
         HE_ASSERT(false);
@@ -175,6 +207,7 @@ struct Template
 {
     Info info;
     nvrhi::TextureHandle thumbnail;
+    std::filesystem::path thumbnailPath;
 };
 
 struct Project
@@ -185,8 +218,218 @@ struct Project
     std::filesystem::path buildDir;
     bool includSourceCode = false;
     bool isBuilding = false;
+    bool buildSucceeded = false; // result of the last build
 
     Utils::Process process;
+    CopyEngine::Progress stagingProgress;
+};
+
+struct UISettings
+{
+    float fontScale = 1.0f;
+    uint8_t selectedPage = 0;
+};
+
+// transient states (installing, building...) are saved as NotInstalled
+struct InstallationStateCodec
+{
+    static void Write(Json::Writer& writer, uint8_t state)
+    {
+        writer.String(InstallationState::ToString(state == InstallationState::Installed ? InstallationState::Installed : InstallationState::NotInstalled));
+    }
+
+    static bool Read(Json::Value value, uint8_t& state)
+    {
+        std::string_view str;
+        if (value.get_string().get(str) != simdjson::SUCCESS)
+            return false;
+
+        state = str == "Installed" ? InstallationState::Installed : InstallationState::NotInstalled;
+        return true;
+    }
+};
+
+template<>
+struct Json::Codec<Staging::Strategy>
+{
+    static void Write(Json::Writer& writer, Staging::Strategy strategy) { writer.String(Staging::ToString(strategy)); }
+
+    static bool Read(Json::Value value, Staging::Strategy& strategy)
+    {
+        std::string_view str;
+        if (value.get_string().get(str) != simdjson::SUCCESS)
+            return false;
+
+        strategy = Staging::StrategyFromString(str);
+        return true;
+    }
+};
+
+// plugin descriptors and template config.json
+template<>
+struct Json::Schema<Info>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("name", &Info::name),
+        Json::MakeField("description", &Info::description),
+        Json::MakeField("URL", &Info::URL),
+    };
+};
+
+// registry keys
+constexpr auto c_EngineKey = [](const Engine& e) -> std::string_view { return e.id; };
+constexpr auto c_ProjectKey = [](const Project& p) -> std::string_view { return p.path; };
+constexpr auto c_PluginKey = [](const Plugin& p) -> std::string_view { return p.info.name; };
+constexpr auto c_TemplateKey = [](const Template& t) -> std::string_view { return t.info.name; };
+
+// written as a plain array, db.json reads it back into a std::vector
+template<typename T, auto KeyOf>
+struct Json::Codec<Registry::Table<T, KeyOf>>
+{
+    static void Write(Json::Writer& writer, const Registry::Table<T, KeyOf>& table)
+    {
+        writer.BeginArray();
+        for (const auto& e : table)
+            writer.Value(e);
+        writer.EndArray();
+    }
+};
+
+
+template<>
+struct Json::Schema<UISettings>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("fontScale", &UISettings::fontScale),
+        Json::MakeField("selectedPage", &UISettings::selectedPage),
+    };
+};
+
+template<>
+struct Json::Schema<Engine>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("path", &Engine::path),
+        Json::MakeField<InstallationStateCodec>("state", &Engine::installationState),
+    };
+};
+
+// db.json entry, the .hproject file has its own field list
+template<>
+struct Json::Schema<Project>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("name", &Project::name),
+        Json::MakeField("path", &Project::path),
+        Json::MakeField("includSourceCode", &Project::includSourceCode),
+    };
+};
+
+// one headless command sent to the daemon, paths in args are relative to cwd
+struct HeadlessRequest
+{
+    std::string cwd;
+    std::vector<std::string> args;
+};
+
+template<>
+struct Json::Schema<HeadlessRequest>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("cwd", &HeadlessRequest::cwd),
+        Json::MakeField("args", &HeadlessRequest::args),
+    };
+};
+
+// the part of a headless result the client needs
+struct HeadlessResponse
+{
+    int exitCode = ExitCode::Failed;
+};
+
+template<>
+struct Json::Schema<HeadlessResponse>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("exitCode", &HeadlessResponse::exitCode),
+    };
+};
+
+// params of the automation api methods, each method reads the members it uses
+struct ApiParams
+{
+    std::string project; // path or name
+    std::string config = "Debug";
+    std::string name;
+    std::string directory;
+    std::string templateName;
+    std::string type; // Plugin or Template
+    uint32_t intervalMs = 250;
+    bool untilIdle = false;
+};
+
+template<>
+struct Json::Schema<ApiParams>
+{
+    static constexpr auto fields = std::tuple{
+        Json::MakeField("project", &ApiParams::project),
+        Json::MakeField("config", &ApiParams::config),
+        Json::MakeField("name", &ApiParams::name),
+        Json::MakeField("directory", &ApiParams::directory),
+        Json::MakeField("template", &ApiParams::templateName),
+        Json::MakeField("type", &ApiParams::type),
+        Json::MakeField("intervalMs", &ApiParams::intervalMs),
+        Json::MakeField("untilIdle", &ApiParams::untilIdle),
+    };
+};
+
+constexpr auto c_ProjectFileFields = std::tuple{
+    Json::MakeField("engineID", &Project::engineID),
+};
+
+// startup snapshot records, strings are indices into the snapshot string table.
+// bump c_SnapshotSchema whenever one of them changes
+constexpr uint32_t c_SnapshotSchema = 1;
+
+struct SnapshotSection
+{
+    enum : uint32_t
+    {
+        Settings, // one string, the ui and settings objects of db.json
+        Engines,
+        Projects,
+        Catalog
+    };
+};
+
+struct SnapshotEngine
+{
+    uint32_t path;
+    uint32_t id;
+    uint8_t state;
+    uint8_t pad[3] = {};
+};
+
+struct SnapshotProject
+{
+    uint32_t name;
+    uint32_t path;
+    uint32_t engineID;
+    uint8_t includSourceCode;
+    uint8_t pad[3] = {};
+};
+
+// installed and remote plugins and templates
+struct SnapshotInfo
+{
+    uint32_t name;
+    uint32_t description;
+    uint32_t URL;
+    uint32_t thumbnail;
+    uint8_t type; // RemoteType
+    uint8_t state;
+    uint8_t enabledByDefault;
+    uint8_t pad = 0;
 };
 
 constexpr const char* c_AppName = "Hydra Launcher";
@@ -194,12 +437,43 @@ constexpr const char* c_AppIconPath = "Resources/Icons/Hydra.png";
 
 constexpr const char* c_EngineRemoteRepo = "https://github.com/johmani/HydraEngine";
 constexpr const char* c_RemotePluginsURL = "https://drive.google.com/uc?export=download&id=1NCUiXzvrVO0Ujl47zZXacl2jcz3ZGGf_";
-constexpr const char* c_EngineLibRemoteRepo = "https://github.com/johmani/HydraEngineLibs_Windows_x64";
+constexpr const char* c_EngineLibRemoteRepo = "https://github.com/johmani/HydraEngineLibs_Windows_x64"; // other platforms set HYDRA_ENGINE_LIBS_URL
+
+// HYDRA_REMOTE_INFO_URL, HYDRA_ENGINE_URL and HYDRA_ENGINE_LIBS_URL point the launcher at mirrors, the offline
+// ones written by HydraLauncherFixtures for example
+static std::string GetRemoteURL(const char* variable, const char* url)
+{
+    const char* value = std::getenv(variable);
+    return value && *value ? value : url;
+}
+
+// HYDRA_APP_DATA moves db.json, the catalog and the installed plugins and templates elsewhere
+static std::filesystem::path GetAppDataDir()
+{
+    const char* value = std::getenv("HYDRA_APP_DATA");
+    return value && *value ? std::filesystem::path(value) : Utils::GetAppDataPath(c_AppName);
+}
 
 constexpr const char* c_VSwherePath = "C:\\Program Files (x86)\\Microsoft Visual Studio\\Installer\\vswhere.exe";
 constexpr const char* c_FindMsBuildCmd = "\"C:\\Program Files (x86)\\Microsoft Visual Studio\\Installer\\vswhere.exe\" -latest -products * -requires Microsoft.Component.MSBuild -find MSBuild\\**\\Bin\\MSBuild.exe";
 
 constexpr const char* c_ConfigStr[] = { "Debug", "Release", "Profile", "Dist" };
+constexpr const char* c_HeadlessCommands[] = { "list", "install-engine", "create-project", "build", "stage", "regenerate", "daemon", "stop-daemon" };
+constexpr const char* c_DaemonSocketName = "launcher.sock";
+constexpr auto c_DaemonTimeout = std::chrono::hours(12); // a forwarded command waits as long as a build may take
+constexpr const char* c_ApiSocketName = "api.sock";
+constexpr uint32_t c_ApiSessions = 16; // scripts served at once, a progress subscription holds one
+constexpr auto c_ApiIdleTimeout = std::chrono::minutes(30);
+constexpr auto c_ApiSendTimeout = std::chrono::seconds(10);
+constexpr uint32_t c_ExtractSlots = 2; // lib archives extracted at once during an engine install
+
+// premake action, it also names the toolchain of published artifacts. Visual Studio solutions built with MSBuild on
+// Windows, makefiles built with make elsewhere
+#ifdef HE_PLATFORM_WINDOWS
+constexpr const char* c_Toolchain = "vs2022";
+#else
+constexpr const char* c_Toolchain = "gmake2";
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 // Layer
@@ -242,6 +516,16 @@ public:
     bool openOutputDirAfterProjectBuild = false;
     bool buildAndRunProject = false;
     bool showBuildOutput = false;
+    bool packDistResources = false;
+    bool packageDist = false;
+    bool shareThirdPartyLibs = true;
+    Staging::Strategy stagingStrategy[4] = {
+        Staging::GetDefaultStrategy(false),
+        Staging::GetDefaultStrategy(false),
+        Staging::GetDefaultStrategy(false),
+        Staging::GetDefaultStrategy(true)
+    };
+    Staging::Strategy templateAssetStrategy = Staging::Strategy::Reflink;
 
     // Graphics
     nvrhi::TextureHandle icon, close, min, max, res;
@@ -249,25 +533,55 @@ public:
     nvrhi::CommandListHandle commandList;
 
     // Appliction
-    std::vector<Project> projects;
-    std::vector<Template> templates;
-    std::vector<Engine> instances;
-    std::vector<Plugin> plugins;
+    Registry::Table<Project, c_ProjectKey> projects;
+    Registry::Table<Template, c_TemplateKey> templates;
+    Registry::Table<Engine, c_EngineKey> instances;
+    Registry::Table<Plugin, c_PluginKey> plugins;
     uint32_t installedInstances = 0;
     uint32_t installedTemplates = 0;
     uint32_t installedPlugins = 0;
 
     std::filesystem::path appData;
-    std::filesystem::path remoteInfoFilePath;
+    std::filesystem::path catalogFilePath;
     std::filesystem::path databaseFilePath;
+    std::filesystem::path snapshotFilePath;
     std::filesystem::path templatesDir;
     std::filesystem::path pluginsDir;
+    std::filesystem::path libStoreDir;
+    std::filesystem::path socketFilePath;
+    std::filesystem::path apiSocketFilePath;
     std::string msBuildPath;
+    std::string artifactStore;
+
+    Persistence::Writer persistence;
+    Json::Writer databaseWriter;
+    std::atomic<bool> databaseDirty = false;
+    std::atomic<bool> snapshotStale = false;
+    Snapshot::Tracker snapshotSources;
+
+    // the engine and project paths of db.json as this process last read or wrote it, see MergeDatabase
+    std::mutex databaseMutex;
+    std::unordered_set<std::string> databaseEngines;
+    std::unordered_set<std::string> databaseProjects;
+    std::atomic<bool> databaseConflict = false;
 
     std::mutex templatesMutex;
     std::mutex pluginsMutex;
     std::mutex projectsMutex;
 
+    // no window, RHI or ImGui, background work runs inline on the calling thread
+    bool headless = false;
+    UISettings uiSettings;
+    std::string headlessCwd;
+    bool servingDaemon = false;
+    std::atomic<bool> daemonStop = false;
+
+    // automation api, its requests run on the UI thread between frames
+    Ipc::Server api;
+    std::atomic<bool> apiStopping = false;
+    std::mutex uiTasksMutex;
+    std::vector<std::function<void()>> uiTasks;
+
 
 #pragma region Engine Functions
 
@@ -277,27 +591,7 @@ public:
 
         device = RHI::GetDevice();
         Git::Init();
-
-        {
-            HE_PROFILE_SCOPE("init paths");
-
-            appData = Utils::GetAppDataPath(c_AppName);
-            remoteInfoFilePath = std::filesystem::absolute(appData / "remoteInfo.json").lexically_normal();
-            databaseFilePath = std::filesystem::absolute(appData / "db.json").lexically_normal();
-            templatesDir = std::filesystem::absolute(appData / "Templates").lexically_normal();
-            pluginsDir = std::filesystem::absolute(appData / "Plugins").lexically_normal();
-
-            std::filesystem::create_directories(templatesDir);
-            std::filesystem::create_directories(pluginsDir);
-
-            static std::string str;
-            Utils::ExecCommand(c_FindMsBuildCmd, &str, nullptr, true, false, [this]() {
-                if (!str.empty())
-                {
-                    msBuildPath = std::filesystem::path(str).parent_path().string();
-                }
-                });
-        }
+        InitPaths();
 
         commandList = device->createCommandList();
         commandList->open();
@@ -319,12 +613,17 @@ public:
         {
             HE_PROFILE_SCOPE("Load App info");
 
-            Deserialize();
-            FindAndAddPlugins();
-            FindAndAddTemplates();
-            GetRemoteInfo();
+            // the snapshot already holds the entries of the cached catalog
+            bool restored = LoadSnapshot();
+            if (!restored)
+                LoadState();
+
+            persistence.Start();
+            GetRemoteInfo(!restored);
         }
 
+        StartApi();
+
         commandList->close();
         device->executeCommandList(commandList);
 
@@ -349,6 +648,70 @@ public:
         }
     }
 
+    void InitPaths()
+    {
+        HE_PROFILE_FUNCTION();
+
+        // the benchmarks point it at a scratch directory first
+        if (appData.empty())
+            appData = GetAppDataDir();
+
+        catalogFilePath = std::filesystem::absolute(appData / "catalog.hcat").lexically_normal();
+        databaseFilePath = std::filesystem::absolute(appData / "db.json").lexically_normal();
+        snapshotFilePath = std::filesystem::absolute(appData / "state.hsnap").lexically_normal();
+        templatesDir = std::filesystem::absolute(appData / "Templates").lexically_normal();
+        pluginsDir = std::filesystem::absolute(appData / "Plugins").lexically_normal();
+        libStoreDir = std::filesystem::absolute(appData / "LibStore").lexically_normal();
+        socketFilePath = std::filesystem::absolute(appData / c_DaemonSocketName).lexically_normal();
+        apiSocketFilePath = std::filesystem::absolute(appData / c_ApiSocketName).lexically_normal();
+
+        std::filesystem::create_directories(templatesDir);
+        std::filesystem::create_directories(pluginsDir);
+
+        // what this process wrote is what its state holds
+        persistence.SetWriteFunction([this](const std::filesystem::path& path, const std::string& content) {
+            std::unique_lock lock(databaseMutex, std::defer_lock);
+            if (path == databaseFilePath)
+            {
+                lock.lock();
+
+                // another process wrote it since this one read it, the UI thread merges that first and writes again
+                if (!snapshotSources.Matches(Snapshot::Source::Stat(path)))
+                {
+                    databaseConflict = true;
+                    return;
+                }
+            }
+
+            if (!Utils::WriteFileAtomic(path, content))
+                HE_ERROR("Unable to open file for writing, {}", path.string());
+
+            snapshotSources.Record(path);
+
+            if (lock.owns_lock())
+            {
+                std::vector<Engine> writtenInstances;
+                std::vector<Project> writtenProjects;
+                simdjson::ondemand::document doc;
+                Json::Value root;
+                if (Json::Parse(content, doc) && doc.get_value().get(root) == simdjson::SUCCESS)
+                    ReadDatabaseLists(root, writtenInstances, writtenProjects);
+
+                SetDatabaseKeys(writtenInstances, writtenProjects);
+            }
+        });
+
+#ifdef HE_PLATFORM_WINDOWS
+        static std::string str;
+        Utils::ExecCommand(c_FindMsBuildCmd, &str, nullptr, !headless, false, [this]() {
+            if (!str.empty())
+            {
+                msBuildPath = std::filesystem::path(str).parent_path().string();
+            }
+            });
+#endif
+    }
+
     virtual void OnEvent(Event& e) override
     {
         DispatchEvent<WindowContentScaleEvent>(e, [this](Event& e) { Utils::Theme(); return false; });
@@ -358,6 +721,24 @@ public:
     {
         HE_PROFILE_FUNCTION();
 
+        StopApi();
+
+        if (!headless)
+            ImGui::GetIO().WantSaveIniSettings = true;
+
+        SubmitPendingWrites();
+        persistence.Stop();
+
+        // db.json was not written because another process changed it meanwhile
+        if (databaseConflict.exchange(false))
+        {
+            MergeDatabase();
+            SubmitPendingWrites();
+            persistence.Flush();
+        }
+
+        WriteSnapshot();
+
         Git::Shutdown();
     }
 
@@ -381,6 +762,17 @@ public:
     {
         HE_PROFILE_FUNCTION();
 
+        // the daemon or a headless command wrote db.json, its changes are merged before this process writes over it
+        if (databaseConflict.exchange(false) || !snapshotSources.Matches(Snapshot::Source::Stat(databaseFilePath)))
+            MergeDatabase();
+
+        SubmitPendingWrites();
+
+        if (snapshotStale.exchange(false))
+            ReloadState();
+
+        RunUITasks();
+
 #ifdef HE_DEBUG
         Application::GetWindow().SetTitle(std::format("Test {}, {}, {}", nvrhi::utils::GraphicsAPIToString(device->getGraphicsAPI()), Application::GetStats().FPS, Application::GetStats().CPUMainTime));
         if (Input::IsKeyPressed(Key::V))
@@ -452,6 +844,18 @@ public:
                             ImGui::SameLine(0, w - ImGui::CalcTextSize("Font Scale").x);
                             ImGui::DragFloat("##Font Scale", &ImGui::GetIO().FontGlobalScale, 0.01f, 0.1f, 2.0f);
                             if (ImGui::IsItemDeactivatedAfterEdit()) { Serialize(); }
+
+                            ImGui::TextUnformatted("Artifact Store");
+                            ImGui::SameLine(0, w - ImGui::CalcTextSize("Artifact Store").x);
+                            ImGui::SetNextItemWidth(300 * scale);
+                            ImGui::InputTextWithHint("##Artifact Store", "directory, file:// or http(s):// URL", &artifactStore);
+                            if (ImGui::IsItemDeactivatedAfterEdit()) { Serialize(); }
+                            ImGui::ToolTip("prebuilt engine binaries keyed by commit, toolchain and config");
+
+                            ImGui::TextUnformatted("Share Libs");
+                            ImGui::SameLine(0, w - ImGui::CalcTextSize("Share Libs").x);
+                            if (ImGui::Checkbox("##Share Libs", &shareThirdPartyLibs)) { Serialize(); }
+                            ImGui::ToolTip("extract ThirdParty/Lib once and hard link it into every engine instance");
                         }
 
                         ImGui::EndPopup();
@@ -477,6 +881,9 @@ public:
                     if (ImGui::MenuItem("  Add Project", "Ctrl + A", nullptr, installedInstances > 0))
                         AddProject();
 
+                    if (ImGui::MenuItem("  Convert Lib Zips To tar.zst"))
+                        ConvertLibZips();
+
                     ImGui::EndMenu();
                 }
 
@@ -491,6 +898,45 @@ public:
                     if (ImGui::MenuItem("  Show Build Output", nullptr, &showBuildOutput))
                         Serialize();
 
+                    if (ImGui::MenuItem("  Pack Dist Resources", nullptr, &packDistResources))
+                        Serialize();
+
+                    if (ImGui::MenuItem("  Package Dist Output", nullptr, &packageDist))
+                        Serialize();
+
+                    if (ImGui::BeginMenu("  Staging Strategy"))
+                    {
+                        for (int i = 0; i < 4; i++)
+                        {
+                            if (ImGui::BeginMenu(c_ConfigStr[i]))
+                            {
+                                for (uint8_t j = 0; j < (uint8_t)Staging::Strategy::Count; j++)
+                                {
+                                    if (ImGui::MenuItem(Staging::c_StrategyStr[j], nullptr, stagingStrategy[i] == (Staging::Strategy)j))
+                                    {
+                                        stagingStrategy[i] = (Staging::Strategy)j;
+                                        Serialize();
+                                    }
+                                }
+                                ImGui::EndMenu();
+                            }
+                        }
+                        ImGui::EndMenu();
+                    }
+
+                    if (ImGui::BeginMenu("  Template Assets Strategy"))
+                    {
+                        for (auto strategy : ProjectTemplate::c_AssetStrategies)
+                        {
+                            if (ImGui::MenuItem(Staging::ToString(strategy), nullptr, ProjectTemplate::ResolveAssetStrategy(templateAssetStrategy) == strategy))
+                            {
+                                templateAssetStrategy = strategy;
+                                Serialize();
+                            }
+                        }
+                        ImGui::EndMenu();
+                    }
+
                     ImGui::EndMenu();
                 }
 
@@ -759,6 +1205,9 @@ public:
                                                     ImGui::EndMenu();
                                                 }
 
+                                                if (ImGui::MenuItem("Verify Dist Output"))
+                                                    VerifyProjectOutput(project, 3);
+
                                                 ImGui::EndPopup();
                                             }
                                         }
@@ -805,6 +1254,14 @@ public:
                                             }
 
                                         }
+                                        else if (project.stagingProgress.running)
+                                        {
+                                            ImGui::ScopedColor sc(ImGuiCol_Text, colors[Color::Info]);
+                                            ImGui::ScopedFont sf(FontType::Blod, FontSize::BodySmall);
+
+                                            ImGui::ProgressBar(project.stagingProgress.GetFraction());
+                                            ImGui::Text("Staging %u/%u", project.stagingProgress.completedFiles.load(), project.stagingProgress.totalFiles.load());
+                                        }
                                     }
                                 }
 
@@ -1843,8 +2300,7 @@ public:
 
     void RemoveProject(int index)
     {
-        HE_VERIFY(index < projects.size());
-        projects.erase(projects.begin() + index);
+        projects.Remove(index);
         Serialize();
     }
 
@@ -1854,18 +2310,62 @@ public:
         return std::filesystem::exists(c_VSwherePath);
     }
 
+    // the file premake generates for a workspace in dir
+    static std::filesystem::path GetWorkspaceFile(const std::filesystem::path& dir, const std::string& name)
+    {
+#ifdef HE_PLATFORM_WINDOWS
+        return dir / (name + ".sln");
+#else
+        return dir / "Makefile";
+#endif
+    }
+
+    // builds one config of the workspace GetWorkspaceFile returns, run in GetBuildToolDir
+    std::string GetBuildCommand(const std::filesystem::path& dir, const std::string& name, uint8_t config)
+    {
+#ifdef HE_PLATFORM_WINDOWS
+        return std::format(
+            "\"{}\" \"{}\" /p:Configuration={} /verbosity:minimal",
+            (std::filesystem::path(msBuildPath) / "MSBuild.exe").string(),
+            GetWorkspaceFile(dir, name).string(),
+            c_ConfigStr[config]
+        );
+#else
+        std::string configName = c_ConfigStr[config];
+        std::ranges::transform(configName, configName.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return std::format("make -C \"{}\" config={} -j{}", dir.string(), configName, std::max(std::thread::hardware_concurrency(), 1u));
+#endif
+    }
+
+    const char* GetBuildToolDir() const
+    {
+        return msBuildPath.empty() ? nullptr : msBuildPath.c_str();
+    }
+
     const Engine* GetEngineInsByID(const std::string_view& id)
     {
-        for (auto& ins : instances)
-            if (ins.id == id)
-                return &ins;
+        return instances.Find(id);
+    }
 
-        return nullptr;
+    // background work of the commands, headless runs execute it inline so a command is done when it returns
+    template<typename F>
+    void Submit(F&& task)
+    {
+        if (headless)
+            task();
+        else
+            Jops::SubmitTask(std::forward<F>(task));
     }
 
-    void RunProjectPremake(Project& project)
+    bool RunProjectPremake(Project& project)
     {
         auto ins = GetEngineInsByID(project.engineID);
+        if (!ins)
+        {
+            HE_ERROR("{} : engine {} not found", project.name, project.engineID);
+            return false;
+        }
+
         auto premakeDir = (ins->path / "ThirdParty" / "Premake" / c_System).string();
         auto projectPremake = (std::filesystem::path(project.path) / "premake.lua").string();
 
@@ -1883,18 +2383,24 @@ public:
                 projectPremake, b2,
                 ins->path.string(), b3
             );
-            return;
+            return false;
         }
 
+        auto premake = std::filesystem::path(premakeDir) / std::format("premake5{}", c_ExecutableExtension);
         std::string cmd = std::format(
-            "premake5 --file=\"{}\" vs2022 --enginePath=\"{}\" --includSourceCode={}",
+            "\"{}\" --file=\"{}\" {} --enginePath=\"{}\" --includSourceCode={}",
+            premake.string(),
             projectPremake,
+            c_Toolchain,
             ins->path.string(),
             project.includSourceCode ? "true" : "false"
         );
 
-        Utils::ExecCommand(cmd.c_str(), nullptr, premakeDir.c_str(), false, showBuildOutput);
+        int exitCode = Utils::RunProcess(cmd.c_str(), premakeDir.c_str(), showBuildOutput);
+        if (exitCode != 0)
+            HE_ERROR("premake exited with {} for {}", exitCode, projectPremake);
 
+        return exitCode == 0;
     }
 
     void ChangeEngineForProject(Project& project, Engine& InstanceInfo)
@@ -1907,14 +2413,13 @@ public:
 
     void RemoveInstance(int index)
     {
-        HE_VERIFY(index < instances.size());
-        instances.erase(instances.begin() + index);
+        instances.Remove(index);
         Serialize();
     }
 
     void AddInstance()
     {
-        auto& ins = instances.emplace_back();
+        auto& ins = instances.Add();
         ins.path = "path";
         ins.installationState = InstallationState::NotInstalled;
 
@@ -1927,15 +2432,16 @@ public:
         {
             InstanceInfo.installationState = InstallationState::Wait;
 
-            Jops::SubmitTask([this, removeFromList, &InstanceInfo]()
+            Submit([this, removeFromList, &InstanceInfo]()
                 {
                     FileSystem::Delete(InstanceInfo.path);
+                    LibStore::Release(libStoreDir, LibStore::GetOwner(InstanceInfo.path));
+
+                    RecordEngineSources(InstanceInfo.path);
 
                     if (removeFromList)
                     {
-                        for (int i = 0; i < instances.size(); i++)
-                            if (&InstanceInfo == &instances[i])
-                                instances.erase(instances.begin() + i);
+                        instances.Remove(&InstanceInfo);
                     }
                     else
                     {
@@ -1948,7 +2454,7 @@ public:
 
     void Delete(Info& info, RemoteType type)
     {
-        Jops::SubmitTask([this, &info, type]() {
+        Submit([this, &info, type]() {
 
             std::filesystem::path path;
             switch (type)
@@ -1960,6 +2466,7 @@ public:
             {
                 info.installationState = InstallationState::Wait;
                 FileSystem::Delete(path);
+                RecordEntrySources(type, path);
                 info.installationState = InstallationState::NotInstalled;
             }
             });
@@ -1976,6 +2483,8 @@ public:
                 instanceInfo.path = std::filesystem::absolute(path);
                 instanceInfo.installationState = InstallationState::Installed;
                 instanceInfo.id = Git::GetCurrentCommitId(instanceInfo.path);
+                RecordEngineSources(instanceInfo.path);
+                instances.Reindex();
             }
             else // new
             {
@@ -1987,12 +2496,50 @@ public:
         }
     }
 
-    void BuildEngine(Engine& instanceInfo)
+    ArtifactStore::Key GetEngineArtifactKey(const Engine& instanceInfo, uint8_t config)
+    {
+        ArtifactStore::Key key;
+        key.commit = Git::GetCurrentCommitId(instanceInfo.path, std::string::npos);
+        key.toolchain = std::format("{}-{}-{}", c_Toolchain, c_System, c_Architecture);
+        key.config = c_ConfigStr[config];
+        return key;
+    }
+
+    // engine binaries of one config, relative to the engine root
+    std::vector<std::filesystem::path> CollectEngineArtifacts(const Engine& instanceInfo, uint8_t config)
+    {
+        std::vector<std::filesystem::path> files;
+        auto platform = std::format("{}-{}", c_System, c_Architecture);
+
+        auto addDirectory = [&](const std::filesystem::path& dir) {
+            if (!std::filesystem::exists(dir))
+                return;
+
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+            {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().lexically_relative(instanceInfo.path));
+            }
+        };
+
+        addDirectory(instanceInfo.path / "Build" / platform / c_ConfigStr[config] / "Bin");
+
+        auto enginePluginsDir = instanceInfo.path / "Plugins";
+        if (std::filesystem::exists(enginePluginsDir))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(enginePluginsDir))
+                addDirectory(entry.path() / "Binaries" / platform / c_ConfigStr[config]);
+        }
+
+        return files;
+    }
+
+    void BuildEngine(Engine& instanceInfo, bool useArtifactStore = false)
     {
         if (!std::filesystem::exists(instanceInfo.path))
             return;
 
-        Jops::SubmitTask([this, &instanceInfo]() {
+        Submit([this, &instanceInfo, useArtifactStore]() {
 
             instanceInfo.installationState = InstallationState::Build;
             instanceInfo.progress.fetchProgress.total_objects = 5;
@@ -2000,49 +2547,111 @@ public:
             instanceInfo.progress.totalSteps++;
             instanceInfo.progress.completedSteps++;
 
-            {
-                auto premake = (instanceInfo.path / "ThirdParty" / "Premake" / c_System).string();
-                auto enginePremake = instanceInfo.path / "premake.lua";
+            instanceInfo.progress.stepName = "Setup...";
+            bool ok = RunEnginePremake(instanceInfo);
+            instanceInfo.progress.fetchProgress.received_objects++;
 
-                instanceInfo.progress.stepName = "Setup...";
+            ok = ok && CompileEngine(instanceInfo, useArtifactStore);
+            if (!ok)
+                HE_ERROR("failed to build HydraEngine {}", instanceInfo.path.string());
 
-                std::string cmd = std::format("premake5{} --file=\"{}\" vs2022", c_ExecutableExtension, enginePremake.string());
-                auto originalPath = std::filesystem::current_path();
-                std::filesystem::current_path(premake);
-                std::system(cmd.c_str());
-                std::filesystem::current_path(originalPath);
+            instanceInfo.installationState = ok ? InstallationState::Installed : InstallationState::Failed;
+            Serialize();
 
-                instanceInfo.progress.fetchProgress.received_objects++;
-            }
+            instanceInfo.progress = {};
+            });
+    }
 
-            {
-                static const char* config[] = { "Debug", "Release", "Profile", "Dist" };
-                for (int i = 0; i < 4; i++)
-                {
-                    if (instanceInfo.progress.cloneState == Git::CloneState::Canceled)
-                        break;
+    // generates the engine solution, only needs the engine source tree.
+    // runs in the premake directory without touching the process working directory, so it can overlap other stages
+    bool RunEnginePremake(Engine& instanceInfo)
+    {
+        auto premakeDir = instanceInfo.path / "ThirdParty" / "Premake" / c_System;
+        auto premake = premakeDir / std::format("premake5{}", c_ExecutableExtension);
+        auto enginePremake = instanceInfo.path / "premake.lua";
+
+        std::string cmd = std::format("\"{}\" --file=\"{}\" {}", premake.string(), enginePremake.string(), c_Toolchain);
+        int exitCode = Utils::RunProcess(cmd.c_str(), premakeDir.string().c_str());
+        if (exitCode != 0)
+            HE_ERROR("premake exited with {} for {}", exitCode, enginePremake.string());
+
+        return exitCode == 0;
+    }
+
+    // builds or fetches every config, expects the solution and ThirdParty/Lib to be ready.
+    // true when every config was built or fetched
+    bool CompileEngine(Engine& instanceInfo, bool useArtifactStore)
+    {
+        bool ok = true;
+
+        useArtifactStore = useArtifactStore && !artifactStore.empty();
+
+        // without a commit there is no key to cache under
+        if (useArtifactStore && !GetEngineArtifactKey(instanceInfo, 0).IsValid())
+        {
+            HE_WARN("ArtifactStore : no commit for {}, building without the store", instanceInfo.path.string());
+            useArtifactStore = false;
+        }
 
-                    instanceInfo.progress.stepName = std::format("Build {}", config[i]);
-                    std::string cmd = std::format(
-                        "MSBuild \"{}/HydraEngine.sln\" /p:Configuration={} /verbosity:minimal",
-                        instanceInfo.path.string(),
-                        config[i]
-                    );
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            if (instanceInfo.progress.cloneState == Git::CloneState::Canceled)
+                break;
 
-                    auto originalPath = std::filesystem::current_path();
-                    std::filesystem::current_path(msBuildPath);
-                    std::system(cmd.c_str());
-                    std::filesystem::current_path(originalPath);
+            ArtifactStore::Key key;
+            if (useArtifactStore)
+            {
+                key = GetEngineArtifactKey(instanceInfo, i);
 
+                instanceInfo.progress.stepName = std::format("Fetch {}", c_ConfigStr[i]);
+                if (ArtifactStore::Fetch(artifactStore, key, instanceInfo.path))
+                {
                     instanceInfo.progress.fetchProgress.received_objects++;
+                    continue;
                 }
             }
 
-            instanceInfo.installationState = InstallationState::Installed;
-            Serialize();
+            instanceInfo.progress.stepName = std::format("Build {}", c_ConfigStr[i]);
+            std::string cmd = GetBuildCommand(instanceInfo.path, "HydraEngine", i);
 
-            instanceInfo.progress = {};
-            });
+            // the working directory is the child's own, other stages keep running in the launcher's
+            int result = Utils::RunProcess(cmd.c_str(), GetBuildToolDir(), showBuildOutput);
+            if (result != 0)
+            {
+                HE_ERROR("HydraEngine {} : build exited with {}", c_ConfigStr[i], result);
+                ok = false;
+            }
+
+            if (useArtifactStore && result == 0)
+            {
+                instanceInfo.progress.stepName = std::format("Publish {}", c_ConfigStr[i]);
+                ArtifactStore::Publish(artifactStore, key, instanceInfo.path, CollectEngineArtifacts(instanceInfo, i));
+            }
+
+            instanceInfo.progress.fetchProgress.received_objects++;
+        }
+
+        return ok && instanceInfo.progress.cloneState != Git::CloneState::Canceled;
+    }
+
+    std::filesystem::path GetProjectOutputDir(const Project& proj, uint8_t config)
+    {
+        if (proj.buildDir.empty())
+            return std::filesystem::path(proj.path) / "Build" / "Out" / c_ConfigStr[config];
+
+        return proj.buildDir / c_ConfigStr[config];
+    }
+
+    void VerifyProjectOutput(Project& proj, uint8_t config)
+    {
+        auto outputDir = GetProjectOutputDir(proj, config);
+        if (!std::filesystem::exists(outputDir))
+        {
+            HE_ERROR("output directory not exist {}", outputDir.string());
+            return;
+        }
+
+        Submit([outputDir]() { Integrity::Verify(outputDir); });
     }
 
     void BuildProject(Project& proj, uint8_t config)
@@ -2050,211 +2659,346 @@ public:
         if (!std::filesystem::exists(proj.path))
             return;
 
-        Jops::SubmitTask([this, &proj, config]() {
+        // building from the moment it is queued, so it can't be queued twice
+        proj.isBuilding = true;
+        proj.buildSucceeded = false;
 
-            proj.isBuilding = true;
+        Submit([this, &proj, config]() {
 
-            auto sln = std::filesystem::path(proj.path) / (proj.name + ".sln");
 
-            if (!std::filesystem::exists(sln))
+            auto workspace = GetWorkspaceFile(proj.path, proj.name);
+
+            if (!std::filesystem::exists(workspace))
             {
                 RunProjectPremake(proj);
             }
 
-            if (!std::filesystem::exists(sln))
+            if (!std::filesystem::exists(workspace))
             {
-                HE_ERROR("project not exist {}", sln.string());
+                HE_ERROR("project not exist {}", workspace.string());
+                proj.isBuilding = false;
                 return;
             }
 
             // build
-            std::string cmd = std::format("MSBuild \"{}\" /p:Configuration={} /verbosity:minimal", sln.string(), c_ConfigStr[config]);
-            proj.process.Start(cmd.c_str(), showBuildOutput, msBuildPath.c_str());
-            proj.process.Wait();
-
+            std::string cmd = GetBuildCommand(proj.path, proj.name, config);
+            proj.process.Start(cmd.c_str(), showBuildOutput, GetBuildToolDir());
+            int exitCode = proj.process.Wait();
+            if (exitCode != 0)
+                HE_ERROR("{} : build exited with {}", proj.name, exitCode);
+
+            // still building while staging, a poll that sees it done also sees the result. a failed build is not
+            // staged, Dist would otherwise checksum and package the previous binaries
+            proj.buildSucceeded = exitCode == 0 && StageProject(proj, config);
             proj.isBuilding = false;
 
-            auto projPath = std::filesystem::path(proj.path);
-            std::filesystem::path BuildDir = projPath / "Build" / std::format("{}-{}", c_System, c_Architecture) / c_ConfigStr[config] / "Bin";
-            std::filesystem::path projectPluginsDir = projPath / "Plugins";
-            std::filesystem::path projectResources = projPath / "Resources";
-
-            std::filesystem::path BuildTargetDir = projPath / "Build" / "Out" / c_ConfigStr[config];
-            std::filesystem::path pluginBin = std::filesystem::path("Binaries") / std::format("{}-{}", c_System, c_Architecture) / c_ConfigStr[config];
+            // interactive follow ups, never on an old executable
+            if (headless || !proj.buildSucceeded)
+                return;
 
-            std::filesystem::path currentOutputDir;
+            std::filesystem::path currentOutputDir = GetProjectOutputDir(proj, config);
 
-            if (proj.buildDir.empty())
-                currentOutputDir = BuildTargetDir;
-            else
-                currentOutputDir = proj.buildDir / c_ConfigStr[config];
+            if (openOutputDirAfterProjectBuild && std::filesystem::exists(currentOutputDir))
+                FileSystem::Open(currentOutputDir);
+
+            auto executable = currentOutputDir / (proj.name + c_ExecutableExtension);
+            auto executableStr = std::format("\"{}\"", executable.string());
+            if (buildAndRunProject && std::filesystem::exists(executable))
+                Utils::ExecCommand(executableStr.c_str(), nullptr, currentOutputDir.string().c_str(), true, showBuildOutput);
+            });
+    }
+
+    // copies the build output, resources and plugins of one config into its output directory
+    bool StageProject(Project& proj, uint8_t config)
+    {
+        HE_PROFILE_FUNCTION();
 
-            std::filesystem::create_directories(currentOutputDir);
+        auto projPath = std::filesystem::path(proj.path);
+        std::filesystem::path BuildDir = projPath / "Build" / std::format("{}-{}", c_System, c_Architecture) / c_ConfigStr[config] / "Bin";
+        std::filesystem::path projectPluginsDir = projPath / "Plugins";
+        std::filesystem::path projectResources = projPath / "Resources";
 
-            if (!std::filesystem::exists(BuildDir))
-            {
-                HE_ERROR("project BuildDir not exist {}", BuildDir.string());
-                return;
-            }
+        std::filesystem::path pluginBin = std::filesystem::path("Binaries") / std::format("{}-{}", c_System, c_Architecture) / c_ConfigStr[config];
 
-            auto copyOptions = std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing;
+        std::filesystem::path currentOutputDir = GetProjectOutputDir(proj, config);
 
-            // copy app binaries
-            for (const auto& entry : std::filesystem::directory_iterator(BuildDir))
+        std::filesystem::create_directories(currentOutputDir);
+
+        if (!std::filesystem::exists(BuildDir))
+        {
+            HE_ERROR("project BuildDir not exist {}", BuildDir.string());
+            return false;
+        }
+
+        Staging::Plan plan;
+
+        // app binaries
+        plan.AddDirectory(BuildDir, "", false, [](const std::filesystem::path& file) {
+            auto ext = file.extension();
+            return ext != ".exp" && ext != ".lib" && ext != ".pdb";
+        });
+
+        // Resources, packed into a single mappable archive for Dist when enabled
+        bool packResources = packDistResources && config == 3 && std::filesystem::exists(projectResources);
+        if (std::filesystem::exists(projectResources) && !packResources)
+            plan.AddDirectory(projectResources, "Resources");
+
+        // plugins
+        if (std::filesystem::exists(projectPluginsDir))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(projectPluginsDir))
             {
-                if (entry.is_regular_file() && entry.path().extension() != ".exp" && entry.path().extension() != ".lib" && entry.path().extension() != ".pdb")
+                auto name = entry.path().stem();
+                auto binDir = entry.path() / pluginBin;
+
+                auto pluginOutDir = std::filesystem::path("Plugins") / name;
+                auto pluginOutBinaries = pluginOutDir / pluginBin;
+
+                // desc
+                auto pluginsDescFilePath = entry.path() / (entry.path().stem().string() + Plugins::c_PluginDescriptorExtension);
+                plan.AddFile(pluginsDescFilePath, pluginOutDir / pluginsDescFilePath.filename());
+
+                // Assets
+                auto assetsDir = entry.path() / "Assets";
+                if (std::filesystem::exists(assetsDir))
+                    plan.AddDirectory(assetsDir, pluginOutDir / "Assets");
+
+                // plugins binaries
+                if (std::filesystem::exists(binDir))
+                {
+                    plan.AddDirectory(binDir, pluginOutBinaries, false, [](const std::filesystem::path& file) {
+                        return file.extension() == c_SharedLibExtension;
+                    });
+                }
+                else
                 {
-                    FileSystem::Copy(entry.path(), currentOutputDir, copyOptions);
+                    HE_ERROR("{} not exists", binDir.string());
                 }
             }
+        }
 
-            // copy Resources
-            if (std::filesystem::exists(projectResources))
-                FileSystem::Copy(projectResources, currentOutputDir / "Resources", copyOptions);
+        for (auto& dll : Utils::GetDepenDlls(!(bool)config))
+            plan.AddFile(dll, dll.filename());
 
-            // copy plugins
-            if (std::filesystem::exists(projectPluginsDir))
-            {
-                for (const auto& entry : std::filesystem::directory_iterator(projectPluginsDir))
-                {
-                    auto name = entry.path().stem();
-                    auto binDir = entry.path() / pluginBin;
+        proj.stagingProgress = {};
+        auto summary = Staging::Stage(plan, currentOutputDir, stagingStrategy[config], &proj.stagingProgress);
 
-                    auto pluginOutDir = currentOutputDir / "Plugins" / name;
-                    auto pluginOutBinaries = pluginOutDir / pluginBin;
+        auto packPath = currentOutputDir / "Resources.hpak";
+        if (packResources)
+            ResourcePack::Write(packPath, projectResources);
+        else if (std::filesystem::exists(packPath))
+            std::filesystem::remove(packPath);
 
-                    std::filesystem::create_directories(pluginOutBinaries);
+        if (config == 3)
+        {
+            // only what staging wrote is read again
+            Integrity::Generate(currentOutputDir, summary.skippedPaths);
 
-                    // copy desc
-                    auto pluginsDescFilePath = entry.path() / (entry.path().stem().string() + Plugins::c_PluginDescriptorExtension);
-                    FileSystem::Copy(pluginsDescFilePath, pluginOutDir, copyOptions);
+            if (packageDist)
+                Package::CreateArchive(currentOutputDir, currentOutputDir.parent_path() / std::format("{}-{}", proj.name, c_ConfigStr[config]), proj.name);
+        }
 
-                    // copy Assets
-                    auto assetsDir = entry.path() / "Assets";
-                    if (std::filesystem::exists(assetsDir))
-                        FileSystem::Copy(assetsDir, pluginOutDir / "Assets", copyOptions);
+        return summary.failedFiles == 0;
+    }
 
-                    // copy plugins binaries
-                    if (std::filesystem::exists(binDir))
-                    {
-                        for (const auto& e : std::filesystem::directory_iterator(binDir))
-                        {
-                            if (e.is_regular_file() && e.path().extension() == c_SharedLibExtension)
-                            {
-                                FileSystem::Copy(e.path(), pluginOutBinaries, copyOptions);
-                            }
-                        }
-                    }
-                    else
-                    {
-                        HE_ERROR("{} not exists", binDir.string());
-                    }
-                }
-            }
+    bool IsLibArchive(const std::filesystem::path& path)
+    {
+        return path.extension() == ".zip" || Package::IsTarArchive(path);
+    }
 
-            Utils::CopyDepenDlls(currentOutputDir, !(bool)config);
+    // extracts one lib archive, .zip entries are spread across workerCount workers, .tar.zst streams through zstd.
+    // with shared libs the archive is only extracted the first time any instance sees it.
+    // the archive is only deleted once extracted, a failed one stays for a retry
+    bool ExtractLib(Engine& instanceInfo, const std::filesystem::path& archive, const std::filesystem::path& lib, uint32_t workerCount, const Zip::ProgressCallback& onProgress)
+    {
+        auto extract = [&](const std::filesystem::path& outputDir) {
+            return archive.extension() == ".zip" ? Zip::Extract({ archive }, outputDir, onProgress, workerCount) : Package::ExtractArchive(archive, outputDir);
+        };
 
-            if (openOutputDirAfterProjectBuild && std::filesystem::exists(currentOutputDir))
-                FileSystem::Open(currentOutputDir);
+        bool ok = shareThirdPartyLibs ? LibStore::Install(libStoreDir, archive, lib, LibStore::GetOwner(instanceInfo.path), extract).succeeded : extract(lib);
+        if (ok)
+            FileSystem::Delete(archive);
+        else
+            HE_ERROR("failed to extract {}", archive.string());
 
-            auto executable = currentOutputDir / (proj.name + c_ExecutableExtension);
-            auto executableStr = std::format("\"{}\"", executable.string());
-            if (buildAndRunProject && std::filesystem::exists(executable))
-                Utils::ExecCommand(executableStr.c_str(), nullptr, currentOutputDir.string().c_str(), true, showBuildOutput);
-            });
+        instanceInfo.progress.CompleteSteps();
+
+        return ok;
+    }
+
+    // repacks every .zip of a lib folder next to it as .tar.zst, the zips are kept
+    void ConvertLibZips()
+    {
+        auto dir = FileDialog::SelectFolder();
+        if (dir.empty() || !std::filesystem::is_directory(dir))
+            return;
+
+        Submit([dir]() {
+            for (auto& file : std::filesystem::directory_iterator(dir))
+            {
+                if (file.is_regular_file() && file.path().extension() == ".zip")
+                {
+                    auto base = file.path();
+                    base.replace_extension();
+                    Package::ConvertZip(file.path(), base);
+                }
+            }
+        });
     }
 
+    // The install runs as a dependency graph instead of fixed phases :
+    //   clone engine -> premake --------------------------> compile
+    //                -> clone libs -> extract (per archive) -^
+    // premake overlaps the lib download and each archive is extracted on its own task as soon as it is checked out,
+    // while the rest of the libs still download. The engine is only Installed when every stage succeeded.
     void DownLoadEngine(Engine& instanceInfo)
     {
         if (!std::filesystem::exists(instanceInfo.path.parent_path()))
             return;
 
-        Jops::SubmitTask([this, &instanceInfo]()
+        instanceInfo.installationState = InstallationState::Installing;
+
+        Submit([this, &instanceInfo]()
             {
-                // 1. clone the engine
-                instanceInfo.installationState = InstallationState::Installing;
                 instanceInfo.progress.totalSteps = 3;
-                instanceInfo.progress.stepName = "HydraEngine";
-                auto state = Git::RecursiveClone(c_EngineRemoteRepo, instanceInfo.path.string().c_str(), instanceInfo.progress);
-                switch (state)
-                {
-                case Git::CloneState::Completed:
-                {
+
+                auto lib = instanceInfo.path / "ThirdParty" / "Lib";
+                auto canceled = [&]() { return instanceInfo.progress.cloneState == Git::CloneState::Canceled; };
+
+                Pipeline::Channel<std::filesystem::path> archives;
+                Pipeline::Graph graph;
+
+                auto cloneEngine = graph.Add("clone engine", [&]() {
+                    instanceInfo.progress.stepName = "HydraEngine";
+                    auto state = Git::RecursiveClone(GetRemoteURL("HYDRA_ENGINE_URL", c_EngineRemoteRepo).c_str(), instanceInfo.path.string().c_str(), instanceInfo.progress);
+                    if (state != Git::CloneState::Completed || canceled())
+                        return false;
+
                     instanceInfo.id = Git::GetCurrentCommitId(instanceInfo.path.string());
-                    break;
-                }
-                case Git::CloneState::Canceled:
-                {
-                    instanceInfo.installationState = InstallationState::NotInstalled;
-                    DeleteEngine(instanceInfo);
-                    break;
-                }
-                case Git::CloneState::Faild:
-                {
-                    instanceInfo.installationState = InstallationState::Failed;
-                    DeleteEngine(instanceInfo);
-                    break;
-                }
-                case Git::CloneState::None:
-                case Git::CloneState::Cloning: HE_ASSERT(false); break;
-                default: HE_ASSERT(false); break;
-                }
+                    instances.Reindex();
+                    return true;
+                });
 
-                // 2. clone libs
-                if (state == Git::CloneState::Completed)
-                {
+                auto premake = graph.Add("premake", [&]() { return RunEnginePremake(instanceInfo); }, { cloneEngine });
+
+                auto cloneLibs = graph.Add("clone libs", [&]() {
+                    std::set<std::filesystem::path> queued;
+                    auto queue = [&](const std::filesystem::path& archive) {
+                        if (IsLibArchive(archive) && std::filesystem::is_regular_file(archive) && queued.insert(archive).second)
+                        {
+                            instanceInfo.progress.AddSteps();
+                            archives.Push(archive);
+                        }
+                    };
+
+                    instanceInfo.progress.onCheckout = [&](const char* path) { queue(lib / path); };
                     instanceInfo.progress.stepName = "ThirdParty/Lib (this could take a while)";
-                    auto lib = instanceInfo.path / "ThirdParty" / "Lib";
-                    state = Git::RecursiveClone(c_EngineLibRemoteRepo, lib.string().c_str(), instanceInfo.progress);
-                    switch (state)
-                    {
-                    case Git::CloneState::Completed:
+                    auto state = Git::RecursiveClone(GetRemoteURL("HYDRA_ENGINE_LIBS_URL", c_EngineLibRemoteRepo).c_str(), lib.string().c_str(), instanceInfo.progress);
+                    instanceInfo.progress.onCheckout = {};
+
+                    // anything checkout did not report
+                    if (state == Git::CloneState::Completed)
                     {
-                        for (auto file : std::filesystem::directory_iterator(lib))
+                        for (auto& file : std::filesystem::directory_iterator(lib))
+                            queue(file.path());
+                    }
+
+                    archives.Close();
+                    return state == Git::CloneState::Completed && !canceled();
+                }, { cloneEngine });
+
+                // a fixed number of archives at once, splitting the copy engine's workers between them, so the next
+                // archive starts while the last entries of the previous one finish
+                auto extract = graph.Add("extract libs", [&]() {
+                    std::atomic<bool> ok = true;
+                    std::mutex stepMutex;
+                    std::atomic<uint64_t> totalBytes = 0;
+                    std::atomic<uint64_t> completedBytes = 0;
+                    uint32_t workerCount = std::max(CopyEngine::GetDefaultWorkerCount() / c_ExtractSlots, 1u);
+
+                    auto slot = [&]() {
+                        std::filesystem::path archive;
+                        while (archives.Pop(archive))
                         {
-                            if (file.is_regular_file() && file.path().extension() == ".zip")
+                            if (canceled())
+                                continue;
+
+                            uint64_t reported = 0;
+                            auto onProgress = [&](const Zip::ArchiveProgress& a, const Zip::ArchiveProgress&) {
+                                if (reported == 0)
+                                    totalBytes += a.totalBytes;
+
+                                completedBytes += a.completedBytes - reported;
+                                reported = a.completedBytes;
+
+                                std::lock_guard lock(stepMutex);
+                                instanceInfo.progress.fetchProgress.total_objects = (unsigned int)(totalBytes >> 10);
+                                instanceInfo.progress.fetchProgress.received_objects = (unsigned int)(completedBytes >> 10);
+                                instanceInfo.progress.stepName = std::format("Extracting {} {}/{}", a.archive.stem().string(), a.completedEntries, a.totalEntries);
+                            };
+
                             {
-                                auto& zip = file.path();
-                                instanceInfo.progress.stepName = "Extracting " + zip.stem().string() + " ...";
-                                FileSystem::ExtractZip(zip, lib);
-                                FileSystem::Delete(zip);
-                                instanceInfo.installationState = InstallationState::Installed;
-                                Serialize();
+                                std::lock_guard lock(stepMutex);
+                                instanceInfo.progress.stepName = std::format("Extracting {} ...", archive.filename().string());
                             }
+
+                            if (!ExtractLib(instanceInfo, archive, lib, workerCount, onProgress))
+                                ok = false;
                         }
-                        break;
-                    }
-                    case Git::CloneState::Canceled:
-                    {
-                        instanceInfo.installationState = InstallationState::NotInstalled;
-                        DeleteEngine(instanceInfo);
-                        break;
-                    }
-                    case Git::CloneState::Faild:
+                    };
+
                     {
-                        instanceInfo.installationState = InstallationState::Failed;
-                        DeleteEngine(instanceInfo);
-                        break;
-                    }
-                    case Git::CloneState::None:
-                    case Git::CloneState::Cloning: HE_ASSERT(false); break;
-                    default: HE_ASSERT(false); break;
+                        std::vector<std::jthread> slots;
+                        for (uint32_t i = 1; i < c_ExtractSlots; i++)
+                            slots.emplace_back(slot);
+
+                        slot();
                     }
-                }
 
-                instanceInfo.progress = { {0} };
+                    return ok && !canceled();
+                }, { cloneEngine });
 
-                // 3. build all config
-                if (state == Git::CloneState::Completed)
+                graph.Add("compile", [&]() {
+                    instanceInfo.installationState = InstallationState::Build;
+                    instanceInfo.progress.fetchProgress = {};
+                    instanceInfo.progress.fetchProgress.total_objects = 4;
+                    return CompileEngine(instanceInfo, true);
+                }, { premake, cloneLibs, extract });
+
+                bool ok = graph.Run();
+
+                if (canceled())
+                {
+                    instanceInfo.installationState = InstallationState::NotInstalled;
+                    DeleteEngine(instanceInfo);
+                }
+                else if (graph.GetState(cloneEngine) != Pipeline::TaskState::Succeeded || graph.GetState(cloneLibs) != Pipeline::TaskState::Succeeded)
+                {
+                    instanceInfo.installationState = InstallationState::Failed;
+                    DeleteEngine(instanceInfo);
+                }
+                else if (!ok)
+                {
+                    // the clones stay, with any archive that failed to extract
+                    HE_ERROR("failed to install HydraEngine {}", instanceInfo.path.string());
+                    instanceInfo.installationState = InstallationState::Failed;
+                }
+                else
                 {
-                    BuildEngine(instanceInfo);
+                    instanceInfo.installationState = InstallationState::Installed;
+                    Serialize();
                 }
+
+                RecordEngineSources(instanceInfo.path);
+                instanceInfo.progress = {};
             });
     }
 
     void DownLoad(Info& info, RemoteType type)
     {
-        Jops::SubmitTask([this, &info, type]() {
+        info.installationState = InstallationState::Installing;
+
+        Submit([this, &info, type]() {
 
             std::filesystem::path path;
             switch (type)
@@ -2263,8 +3007,6 @@ public:
             case RemoteType::Template: path = templatesDir / info.name; break;
             }
 
-
-            info.installationState = InstallationState::Installing;
             info.progress.totalSteps = 1;
             info.progress.stepName = info.name;
 
@@ -2292,6 +3034,8 @@ public:
             default: HE_ASSERT(false); break;
             }
 
+            RecordEntrySources(type, path);
+
             switch (type)
             {
             case RemoteType::Plugin: installedPlugins++; break;
@@ -2304,18 +3048,278 @@ public:
 
     bool IsPluginInstalled(const std::string_view& pluginName)
     {
-        for (auto& plugin : plugins)
-            if (pluginName == plugin.info.name)
-                return true;
-        return false;
+        return plugins.Contains(pluginName);
+    }
+
+    Template* GetTemplateByName(const std::string_view& templateName)
+    {
+        return templates.Find(templateName);
+    }
+
+    // full load from the source files, when there is no usable snapshot
+    void LoadState()
+    {
+        HE_PROFILE_FUNCTION();
+
+        // stat'ed before they are read, so a write in between shows up as a change
+        snapshotSources.Clear();
+        snapshotSources.Record(databaseFilePath);
+        snapshotSources.Record(catalogFilePath);
+        snapshotSources.Record(pluginsDir);
+        snapshotSources.Record(templatesDir);
+
+        Deserialize();
+        FindAndAddPlugins();
+        FindAndAddTemplates();
+
+        ForEachSource([this](const std::filesystem::path& path) { snapshotSources.RecordIfNew(path); });
+    }
+
+    // the snapshot was out of date, rebuild everything from the sources once no task uses the state
+    void ReloadState()
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto idle = [](uint8_t state) { return state == InstallationState::Installed || state == InstallationState::NotInstalled || state == InstallationState::Failed; };
+
+        bool busy = std::any_of(instances.begin(), instances.end(), [&](const Engine& e) { return !idle(e.installationState); });
+        busy |= std::any_of(projects.begin(), projects.end(), [](const Project& p) { return p.isBuilding; });
+        busy |= std::any_of(plugins.begin(), plugins.end(), [&](const Plugin& p) { return !idle(p.info.installationState); });
+        busy |= std::any_of(templates.begin(), templates.end(), [&](const Template& t) { return !idle(t.info.installationState); });
+        if (busy)
+        {
+            // retried every frame until the running tasks are done
+            snapshotStale = true;
+            return;
+        }
+
+        HE_INFO("launcher state changed on disk, reloading");
+
+        {
+            std::scoped_lock lock(pluginsMutex, templatesMutex);
+            instances.clear();
+            projects.clear();
+            plugins.clear();
+            templates.clear();
+            installedInstances = 0;
+            installedPlugins = 0;
+            installedTemplates = 0;
+            LoadState();
+        }
+
+        Catalog::Index index;
+        if (index.Load(catalogFilePath))
+            MergeCatalogIndex(index);
+    }
+
+    // Maps the snapshot written by the last session and restores the state from it without reading any of
+    // the source files, they are only stat'ed afterwards on a worker.
+    bool LoadSnapshot()
+    {
+        HE_PROFILE_FUNCTION();
+
+        Snapshot::Reader reader;
+        if (!reader.Open(snapshotFilePath, c_SnapshotSchema))
+            return false;
+
+        auto settings = reader.GetSection<uint32_t>(SnapshotSection::Settings);
+        simdjson::ondemand::document doc;
+        Json::Value root;
+        if (settings.size() != 1 || !Json::Parse(reader.GetString(settings[0]), doc) || doc.get_value().get(root) != simdjson::SUCCESS)
+            return false;
+
+        std::vector<Engine> unusedInstances;
+        std::vector<Project> unusedProjects;
+        ReadDatabase(root, unusedInstances, unusedProjects);
+
+        for (const auto& r : reader.GetSection<SnapshotEngine>(SnapshotSection::Engines))
+        {
+            Engine ins;
+            ins.path = reader.GetString(r.path);
+            ins.id = reader.GetString(r.id);
+            ins.installationState = r.state;
+            installedInstances += r.state == InstallationState::Installed;
+            instances.Add(std::move(ins));
+        }
+
+        projects.reserve(reader.GetSection<SnapshotProject>(SnapshotSection::Projects).size());
+        for (const auto& r : reader.GetSection<SnapshotProject>(SnapshotSection::Projects))
+        {
+            Project proj;
+            proj.name = reader.GetString(r.name);
+            proj.path = reader.GetString(r.path);
+            proj.engineID = reader.GetString(r.engineID);
+            proj.includSourceCode = r.includSourceCode;
+            projects.Add(std::move(proj));
+        }
+
+        for (const auto& r : reader.GetSection<SnapshotInfo>(SnapshotSection::Catalog))
+        {
+            Info info;
+            info.name = reader.GetString(r.name);
+            info.description = reader.GetString(r.description);
+            info.URL = reader.GetString(r.URL);
+            info.installationState = r.state;
+
+            bool installed = r.state == InstallationState::Installed;
+            if (r.type == (uint8_t)RemoteType::Plugin)
+            {
+                plugins.Add({ std::move(info), r.enabledByDefault != 0 });
+                installedPlugins += installed;
+            }
+            else
+            {
+                Template t;
+                t.info = std::move(info);
+                t.thumbnailPath = reader.GetString(r.thumbnail);
+                if (!t.thumbnailPath.empty() && device)
+                    t.thumbnail = Utils::LoadTexture(t.thumbnailPath, device, commandList);
+                templates.Add(std::move(t));
+                installedTemplates += installed;
+            }
+        }
+
+        {
+            std::lock_guard lock(databaseMutex);
+            SetDatabaseKeys(instances, projects);
+        }
+
+        // the state is the one resolved from these stats, whatever the disk holds now
+        auto sources = reader.GetSources();
+        snapshotSources.Clear();
+        for (const auto& s : sources)
+            snapshotSources.Record(s);
+
+        Submit([this, sources = std::move(sources)]() {
+            if (!Snapshot::IsFresh(sources))
+                snapshotStale = true;
+        });
+
+        return true;
+    }
+
+    void WriteSnapshot()
+    {
+        HE_PROFILE_FUNCTION();
+
+        Snapshot::Writer writer;
+
+        bool changed = false;
+        ForEachSource([&](const std::filesystem::path& path) {
+            auto s = Snapshot::Source::Stat(path);
+            changed |= !snapshotSources.Matches(s);
+            writer.AddSource(s);
+        });
+
+        // another process changed a source after this one read it, the state may predate that change
+        if (changed)
+        {
+            HE_INFO("launcher state changed on disk, not writing a snapshot");
+            std::error_code ec;
+            std::filesystem::remove(snapshotFilePath, ec);
+            return;
+        }
+
+        uint32_t settings = writer.Intern(SerializeDatabase(false));
+        writer.AddSection<uint32_t>(SnapshotSection::Settings, std::span(&settings, 1));
+
+        std::vector<SnapshotEngine> engines;
+        for (const auto& e : instances)
+        {
+            uint8_t state = e.installationState == InstallationState::Installed ? InstallationState::Installed : InstallationState::NotInstalled;
+            engines.push_back({ writer.Intern(e.path.string()), writer.Intern(e.id), state });
+        }
+        writer.AddSection<SnapshotEngine>(SnapshotSection::Engines, engines);
+
+        std::vector<SnapshotProject> projectRecords;
+        for (const auto& p : projects)
+            projectRecords.push_back({ writer.Intern(p.name), writer.Intern(p.path), writer.Intern(p.engineID), p.includSourceCode });
+        writer.AddSection<SnapshotProject>(SnapshotSection::Projects, projectRecords);
+
+        std::vector<SnapshotInfo> catalog;
+        {
+            std::scoped_lock lock(pluginsMutex, templatesMutex);
+
+            for (const auto& p : plugins)
+            {
+                uint8_t state = p.info.installationState == InstallationState::Installed ? InstallationState::Installed : InstallationState::NotInstalled;
+                catalog.push_back({ writer.Intern(p.info.name), writer.Intern(p.info.description), writer.Intern(p.info.URL), writer.Intern(""), (uint8_t)RemoteType::Plugin, state, p.enabledByDefault });
+            }
+
+            for (const auto& t : templates)
+            {
+                uint8_t state = t.info.installationState == InstallationState::Installed ? InstallationState::Installed : InstallationState::NotInstalled;
+                catalog.push_back({ writer.Intern(t.info.name), writer.Intern(t.info.description), writer.Intern(t.info.URL), writer.Intern(t.thumbnailPath.string()), (uint8_t)RemoteType::Template, state, 0 });
+            }
+        }
+        writer.AddSection<SnapshotInfo>(SnapshotSection::Catalog, catalog);
+
+        if (!writer.Write(snapshotFilePath, c_SnapshotSchema))
+            HE_ERROR("Unable to open file for writing, {}", snapshotFilePath.string());
+    }
+
+    // every file the state is resolved from
+    template<typename F>
+    void ForEachSource(F&& fn)
+    {
+        fn(databaseFilePath);
+
+        for (const auto& e : instances)
+        {
+            for (const auto& path : GetEngineSources(e.path))
+                fn(path);
+        }
+
+        for (const auto& p : projects)
+            fn(std::filesystem::path(p.path) / std::format("{}.hproject", p.name));
+
+        // remote entries are part of the catalog
+        fn(catalogFilePath);
+
+        // adding or removing a plugin or template changes its directory's mtime
+        fn(pluginsDir);
+        fn(templatesDir);
+
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(pluginsDir, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            for (const auto& path : GetEntrySources(RemoteType::Plugin, it->path()))
+                fn(path);
+        }
+
+        for (auto it = std::filesystem::directory_iterator(templatesDir, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            for (const auto& path : GetEntrySources(RemoteType::Template, it->path()))
+                fn(path);
+        }
+    }
+
+    // validity and current commit
+    static std::array<std::filesystem::path, 3> GetEngineSources(const std::filesystem::path& enginePath)
+    {
+        return { enginePath / "premake.lua", enginePath / ".git" / "HEAD", enginePath / ".git" / "logs" / "HEAD" };
+    }
+
+    static std::vector<std::filesystem::path> GetEntrySources(RemoteType type, const std::filesystem::path& dir)
+    {
+        if (type == RemoteType::Plugin)
+            return { dir / std::format("{}.hplugin", dir.stem().string()) };
+
+        return { dir / "config.json", dir / "thumbnail.jpg" };
+    }
+
+    // after this process changed them itself
+    void RecordEngineSources(const std::filesystem::path& enginePath)
+    {
+        for (const auto& path : GetEngineSources(enginePath))
+            snapshotSources.Record(path);
     }
 
-    Template* GetTemplateByName(const std::string_view& pluginName)
+    void RecordEntrySources(RemoteType type, const std::filesystem::path& dir)
     {
-        for (auto& t : templates)
-            if (pluginName == t.info.name)
-                return &t;
-        return nullptr;
+        snapshotSources.Record(type == RemoteType::Plugin ? pluginsDir : templatesDir);
+        for (const auto& path : GetEntrySources(type, dir))
+            snapshotSources.Record(path);
     }
 
     void FindAndAddTemplates()
@@ -2323,8 +3327,9 @@ public:
         templates.clear();
         for (auto entry : std::filesystem::directory_iterator(templatesDir))
         {
-            auto& t = templates.emplace_back();
+            Template t;
             DeserializeTemplate(entry.path() / "config.json", t);
+            templates.Add(std::move(t));
             installedTemplates++;
         }
     }
@@ -2338,30 +3343,47 @@ public:
 
             if (std::filesystem::exists(descFile))
             {
-                auto& p = plugins.emplace_back();
+                Plugin p;
                 DeserializePluginDesc(descFile, p);
+                plugins.Add(std::move(p));
                 installedPlugins++;
             }
         }
     }
 
-    void GetRemoteInfo()
+    // Merges the cached catalog, then syncs it with the server. Pages are merged as they arrive and a 304 leaves
+    // everything as is. The worker only downloads and parses, the merges run on the UI thread between two frames
+    // as the tables and the references the UI holds into them are its own.
+    void GetRemoteInfo(bool loadCached)
     {
-        Jops::SubmitTask([this]() {
+        Submit([this, loadCached]() {
 
-            // Load from existing file
-            if (std::filesystem::exists(remoteInfoFilePath))
-            {
-                DeserializeAndAddRemoteInfo();
-            }
+            Catalog::Index index;
+            if (index.Load(catalogFilePath) && loadCached)
+                PostToUI([this, page = MakeCatalogPage(index)]() mutable { MergeCatalogPage(page); });
+
+            std::string url = GetRemoteURL("HYDRA_REMOTE_INFO_URL", c_RemotePluginsURL);
+            auto summary = Catalog::Sync(url, index, [this](Catalog::Page& page) {
+                PostToUI([this, page = std::move(page)]() mutable { MergeCatalogPage(page); });
+            });
+            if (summary.result != Catalog::SyncResult::Updated)
+                return;
 
-            // Fetch updated file , Reload from updated file
+            if (summary.reset)
             {
-                std::string cmd = std::format("curl -L -o \"{}\" \"{}\"", remoteInfoFilePath.string(), c_RemotePluginsURL); // >nul 2>&1
-                Utils::ExecCommand(cmd.c_str(), nullptr, nullptr, true, false, [this]() {
-                    DeserializeAndAddRemoteInfo();
-                    });
+                std::unordered_set<std::string> pluginNames;
+                std::unordered_set<std::string> templateNames;
+                for (const auto& [name, e] : index.plugins)
+                    pluginNames.insert(name);
+                for (const auto& [name, e] : index.templates)
+                    templateNames.insert(name);
+
+                PostToUI([this, pluginNames = std::move(pluginNames), templateNames = std::move(templateNames)]() { PruneCatalog(pluginNames, templateNames); });
             }
+
+            if (!index.Save(catalogFilePath))
+                HE_ERROR("Unable to open file for writing, {}", catalogFilePath.string());
+            snapshotSources.Record(catalogFilePath);
             });
     }
 
@@ -2379,7 +3401,7 @@ public:
 
     void CreateNewProject(const std::string& name, const std::string& newProjectPath, int index)
     {
-        Jops::SubmitTask([this, &name, &newProjectPath, index]() {
+        Submit([this, name, newProjectPath, index]() {
 
             auto& t = templates[index];
 
@@ -2387,9 +3409,6 @@ public:
             normalizedName.erase(std::remove(normalizedName.begin(), normalizedName.end(), ' '), normalizedName.end());
 
             std::filesystem::path newProjectDirectory = std::filesystem::path(newProjectPath) / name;
-            std::filesystem::path premake = newProjectDirectory / "premake.lua";
-            std::filesystem::path source = newProjectDirectory / "Source";
-            std::filesystem::path cppFile = source / t.info.name / std::format("{}.cpp", t.info.name);
             std::filesystem::path projectPluginDir = newProjectDirectory / "Plugins";
 
             if (std::filesystem::exists(newProjectDirectory))
@@ -2400,32 +3419,51 @@ public:
 
             std::filesystem::create_directories(projectPluginDir);
 
-            FileSystem::Copy(templatesDir / t.info.name, newProjectDirectory);
-            FileSystem::Delete(newProjectDirectory / "thumbnail.jpg");
-            FileSystem::Delete(newProjectDirectory / "config.json");
-            FileSystem::Delete(newProjectDirectory / ".git");
-
-            FileSystem::GenerateFileWithReplacements(premake, premake, { { "PROJECT_NAME", name } });
-            FileSystem::GenerateFileWithReplacements(cppFile, cppFile, { { "PROJECT_NAME", normalizedName } });
-
-            FileSystem::Rename(cppFile, source / t.info.name / std::format("{}.cpp", normalizedName));
-            FileSystem::Rename(source / t.info.name, source / normalizedName);
-
+            // the template is instantiated in the same pass that copies the default plugins, renames and
+            // substitutions happen on the way instead of rewriting the copied files afterwards
+            ProjectTemplate::Options options;
+            options.templateDir = templatesDir / t.info.name;
+            options.outputDir = newProjectDirectory;
+            options.exclude = { ".git", "thumbnail.jpg", "config.json" };
+            // only the entry point and its directory carry the template name, as before
+            options.renames = {
+                { std::format("Source/{}", t.info.name), std::format("Source/{}", normalizedName) },
+                { std::format("Source/{0}/{0}.cpp", t.info.name), std::format("Source/{0}/{0}.cpp", normalizedName) },
+            };
+            options.tokens = { { "PROJECT_NAME", normalizedName } };
+            options.fileTokens["premake.lua"] = { { "PROJECT_NAME", name } };
+            options.strategy = templateAssetStrategy;
+
+            CopyEngine::Queue queue;
+            ProjectTemplate::Summary summary;
+            ProjectTemplate::Plan(options, queue, summary);
             for (int i = 0; i < plugins.size(); i++)
             {
                 if (!plugins[i].enabledByDefault)
                     continue;
 
-                FileSystem::Copy(pluginsDir / plugins[i].info.name, projectPluginDir / plugins[i].info.name);
+                queue.AddDirectory(pluginsDir / plugins[i].info.name, projectPluginDir / plugins[i].info.name);
+            }
+
+            // a half written project is not registered, and removed so creating it again is not refused
+            if (!queue.Run())
+            {
+                HE_ERROR("failed to copy some template files into {}", newProjectDirectory.string());
+                std::error_code ec;
+                std::filesystem::remove_all(newProjectDirectory, ec);
+                return;
             }
 
+            HE_INFO("{} : {} template files, {} linked, {} substituted, {} replacements", name, summary.files.load(), summary.linkedFiles.load(), summary.substitutedFiles.load(), summary.replacements.load());
+
             Project* proj = nullptr;
             {
                 std::lock_guard<std::mutex> lock(projectsMutex);
-                proj = &projects.emplace_back();
-                proj->name = name;
-                proj->path = newProjectDirectory.string();
-                proj->engineID = instances.size() >= 1 ? instances[0].id : "";
+                Project newProject;
+                newProject.name = name;
+                newProject.path = newProjectDirectory.string();
+                newProject.engineID = instances.size() >= 1 ? instances[0].id : "";
+                proj = &projects.Add(std::move(newProject));
             }
 
             Serialize();
@@ -2442,309 +3480,1327 @@ public:
         if (!std::filesystem::exists(projectDir / "premake.lua") && !std::filesystem::exists(projectDir / "Source"))
             return;
 
-        auto& proj = projects.emplace_back();
-        proj.name = projectDir.stem().string();
-        proj.path = projectDir.string();
+        Project newProject;
+        newProject.name = projectDir.stem().string();
+        newProject.path = projectDir.string();
+        auto& proj = projects.Add(std::move(newProject));
 
         DeserializeProject(proj);
 
         Serialize();
     }
 
+    // Safe from any thread and cheap : only marks the database dirty, the UI thread snapshots it next frame
+    // and the persistence thread writes it.
     void Serialize()
     {
-        HE_PROFILE_FUNCTION();
+        databaseDirty = true;
+    }
 
-        std::ofstream file(databaseFilePath);
-        if (!file.is_open())
-        {
-            HE_ERROR("Unable to open file for writing, {}", databaseFilePath.string());
-        }
+    // runs on the UI thread, which owns the launcher state and ImGui
+    void SubmitPendingWrites()
+    {
+        if (databaseDirty.exchange(false))
+            persistence.Submit(databaseFilePath, SerializeDatabase());
 
-        std::ostringstream oss;
-        oss << "{\n";
+        if (headless)
+            return;
 
+        auto& io = ImGui::GetIO();
+        if (io.WantSaveIniSettings)
         {
-            oss << "\t\"ui\" : {\n";
-            oss << "\t\t\"fontScale\" : " << ImGui::GetIO().FontGlobalScale << ",\n";
-            oss << "\t\t\"selectedPage\" : " << (int)selectedPage << "\n";
-            oss << "\t},\n";
+            persistence.Submit(appData / "layout.ini", ImGui::SaveIniSettingsToMemory());
+            io.WantSaveIniSettings = false;
         }
+    }
 
-        {
-            oss << "\t\"settings\" : {\n";
-            oss << "\t\t\"openOutputDirAfterProjectBuild\" : " << (openOutputDirAfterProjectBuild ? "true" : "false") << ",\n";
-            oss << "\t\t\"buildAndRunProject\" : " << (buildAndRunProject ? "true" : "false") << ",\n";
-            oss << "\t\t\"showBuildOutput\" : " << (showBuildOutput ? "true" : "false") << "\n";
-            oss << "\t},\n";
+    // db.json "settings"
+    static constexpr auto GetSettingsFields()
+    {
+        return std::tuple{
+            Json::MakeField("openOutputDirAfterProjectBuild", &HydraLauncher::openOutputDirAfterProjectBuild),
+            Json::MakeField("buildAndRunProject", &HydraLauncher::buildAndRunProject),
+            Json::MakeField("showBuildOutput", &HydraLauncher::showBuildOutput),
+            Json::MakeField("packDistResources", &HydraLauncher::packDistResources),
+            Json::MakeField("packageDist", &HydraLauncher::packageDist),
+            Json::MakeField("shareThirdPartyLibs", &HydraLauncher::shareThirdPartyLibs),
+            Json::MakeField("artifactStore", &HydraLauncher::artifactStore),
+            Json::MakeField("stagingStrategy", &HydraLauncher::stagingStrategy),
+            Json::MakeField("templateAssetStrategy", &HydraLauncher::templateAssetStrategy),
+        };
+    }
+
+    std::string SerializeDatabase(bool includeLists = true)
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto& writer = databaseWriter;
+        writer.Clear();
+        writer.BeginObject();
+        writer.Member("ui", GetUISettings());
+        writer.Key("settings");
+        Json::WriteObject(writer, *this, GetSettingsFields());
+        if (includeLists)
+        {
+            writer.Member("engine", instances);
+            writer.Member("projects", projects);
         }
+        writer.EndObject();
 
+        return writer.GetString();
+    }
+
+    // applies ui and settings, engines and projects are returned as stored
+    void ReadDatabase(Json::Value root, std::vector<Engine>& loadedInstances, std::vector<Project>& loadedProjects)
+    {
+        UISettings ui = GetUISettings();
+
+        Json::ForEachField(root, [&](std::string_view key, Json::Value value) {
+            if (key == "ui")
+                Json::Read(value, ui);
+            else if (key == "settings")
+                Json::ReadObject(value, *this, GetSettingsFields());
+            else if (key == "engine")
+                Json::Read(value, loadedInstances);
+            else if (key == "projects")
+                Json::Read(value, loadedProjects);
+            return true;
+        });
+
+        uiSettings = ui;
+        if (!headless)
         {
-            oss << "\t\"engine\" : [\n";
-            for (size_t i = 0; i < instances.size(); ++i)
-            {
-                uint8_t state = instances[i].installationState == InstallationState::Installed ? InstallationState::Installed : InstallationState::NotInstalled;
-
-                oss << "\t\t{\n";
-                oss << "\t\t\t\"path\" : " << instances[i].path << ",\n";
-                oss << "\t\t\t\"state\" : \"" << InstallationState::ToString(instances[i].installationState) << "\"\n";
-                oss << "\t\t}";
-                if (i < instances.size() - 1) oss << ",";
-                oss << "\n";
-            }
-            oss << "\t],\n";
+            ImGui::GetIO().FontGlobalScale = ui.fontScale;
+            selectedPage = ui.selectedPage;
         }
+    }
+
+    static void ReadDatabaseLists(Json::Value root, std::vector<Engine>& loadedInstances, std::vector<Project>& loadedProjects)
+    {
+        Json::ForEachField(root, [&](std::string_view key, Json::Value value) {
+            if (key == "engine")
+                Json::Read(value, loadedInstances);
+            else if (key == "projects")
+                Json::Read(value, loadedProjects);
+            return true;
+        });
+    }
+
+    // call with databaseMutex held
+    template<typename E, typename P>
+    void SetDatabaseKeys(const E& engines, const P& projectList)
+    {
+        databaseEngines.clear();
+        databaseProjects.clear();
+
+        for (const auto& e : engines)
+            databaseEngines.insert(e.path.string());
+
+        for (const auto& p : projectList)
+            databaseProjects.insert(p.path);
+    }
+
+    // Another process (the daemon, a headless command) wrote db.json since this one last read or wrote it. The
+    // engines and projects it added are loaded and the ones it removed are dropped, everything else keeps this
+    // process's values, and the result is written back. A removal waits while its entry is in use.
+    void MergeDatabase()
+    {
+        HE_PROFILE_FUNCTION();
+
+        std::lock_guard lock(databaseMutex);
+
+        auto source = Snapshot::Source::Stat(databaseFilePath);
+        if (snapshotSources.Matches(source))
+            return;
 
+        std::vector<Engine> diskInstances;
+        std::vector<Project> diskProjects;
         {
-            oss << "\t\"projects\" : [\n";
-            for (size_t i = 0; i < projects.size(); ++i)
+            simdjson::ondemand::document doc;
+            Json::Value root;
+            if (!Json::Load(databaseFilePath, doc) || doc.get_value().get(root) != simdjson::SUCCESS)
             {
-                oss << "\t\t{\n";
-                oss << "\t\t\t\"name\" : \"" << projects[i].name << "\",\n";
-                oss << "\t\t\t\"path\" : " << std::filesystem::path(projects[i].path).lexically_normal() << ",\n";
-                oss << "\t\t\t\"includSourceCode\" : " << (projects[i].includSourceCode ? "true" : "false") << "\n";
-                oss << "\t\t}";
-                if (i < projects.size() - 1) oss << ",";
-                oss << "\n";
+                // gone or unreadable, this process's state replaces it
+                snapshotSources.Record(source);
+                databaseDirty = true;
+                return;
             }
-            oss << "\t]\n";
+
+            ReadDatabaseLists(root, diskInstances, diskProjects);
+        }
+
+        HE_INFO("db.json changed on disk, merging");
+
+        std::unordered_set<std::string> diskEngineKeys;
+        std::unordered_set<std::string> diskProjectKeys;
+        for (const auto& e : diskInstances)
+            diskEngineKeys.insert(e.path.string());
+        for (const auto& p : diskProjects)
+            diskProjectKeys.insert(p.path);
+
+        for (auto& ins : diskInstances)
+        {
+            bool known = databaseEngines.contains(ins.path.string()) || std::any_of(instances.begin(), instances.end(), [&](const Engine& e) { return e.path == ins.path; });
+            if (known)
+                continue;
+
+            ResolveEngine(ins);
+            instances.Add(std::move(ins));
         }
 
-        oss << "}\n";
+        for (auto& proj : diskProjects)
+        {
+            bool known = databaseProjects.contains(proj.path) || std::any_of(projects.begin(), projects.end(), [&](const Project& p) { return p.path == proj.path; });
+            if (known)
+                continue;
+
+            if (std::filesystem::exists(proj.path))
+                DeserializeProject(proj);
+
+            projects.Add(std::move(proj));
+        }
+
+        // a building project holds its engine
+        bool deferred = false;
+        bool building = std::any_of(projects.begin(), projects.end(), [](const Project& p) { return p.isBuilding; });
+
+        instances.RemoveIf([&](const Engine& e) {
+            auto key = e.path.string();
+            if (!databaseEngines.contains(key) || diskEngineKeys.contains(key))
+                return false;
 
-        file << oss.str();
-        file.close();
+            deferred |= building || IsBusy(e.installationState);
+            return !building && !IsBusy(e.installationState);
+        });
 
-        std::string layoutPath = (appData / "layout.ini").lexically_normal().string();
-        ImGui::GetIO().IniFilename = nullptr;
-        ImGui::SaveIniSettingsToDisk(layoutPath.c_str());
+        projects.RemoveIf([&](const Project& p) {
+            if (!databaseProjects.contains(p.path) || diskProjectKeys.contains(p.path))
+                return false;
+
+            deferred |= p.isBuilding;
+            return !p.isBuilding;
+        });
+
+        // retried every frame, this process's writes are refused until then
+        if (deferred)
+            return;
+
+        SetDatabaseKeys(diskInstances, diskProjects);
+        snapshotSources.Record(source);
+        databaseDirty = true;
+    }
+
+    // headless runs write back the ui block as they read it
+    UISettings GetUISettings()
+    {
+        if (!headless)
+            uiSettings = { ImGui::GetIO().FontGlobalScale, selectedPage };
+
+        return uiSettings;
     }
 
     void Deserialize()
     {
         HE_PROFILE_FUNCTION();
 
-        static simdjson::dom::parser parser;
-        auto doc = parser.load(databaseFilePath.string());
+        simdjson::ondemand::document doc;
+        Json::Value root;
+        if (!Json::Load(databaseFilePath, doc) || doc.get_value().get(root) != simdjson::SUCCESS)
+            return;
+
+        std::vector<Engine> loadedInstances;
+        std::vector<Project> loadedProjects;
+        ReadDatabase(root, loadedInstances, loadedProjects);
+
+        {
+            std::lock_guard lock(databaseMutex);
+            SetDatabaseKeys(loadedInstances, loadedProjects);
+        }
 
-        // ui
+        installedInstances = 0;
+        for (auto& ins : loadedInstances)
         {
-            auto ui = doc["ui"];
-            if (!ui.error())
+            ResolveEngine(ins);
+            instances.Add(std::move(ins));
+        }
+
+        projects.reserve(projects.size() + loadedProjects.size());
+        for (auto& proj : loadedProjects)
+        {
+            if (std::filesystem::exists(proj.path))
+                DeserializeProject(proj);
+
+            projects.Add(std::move(proj));
+        }
+    }
+
+    // validity and current commit of an engine read from db.json
+    void ResolveEngine(Engine& ins)
+    {
+        RecordEngineSources(ins.path);
+        if (IsValidHydraDirectory(ins.path))
+        {
+            ins.id = Git::GetCurrentCommitId(ins.path.string());
+            installedInstances++;
+        }
+        else
+        {
+            ins.installationState = InstallationState::NotInstalled;
+        }
+    }
+
+    void SerializeProject(const Project& project)
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto filePath = std::filesystem::path(project.path) / std::format("{}.hproject", project.name);
+
+        Json::Writer writer;
+        Json::WriteObject(writer, project, c_ProjectFileFields);
+
+        if (!Utils::WriteFileAtomic(filePath, writer.GetString()))
+            HE_ERROR("Unable to open file for writing, {}", filePath.string());
+        snapshotSources.Record(filePath);
+    }
+
+    void DeserializeProject(Project& project)
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto filePath = std::filesystem::path(project.path) / std::format("{}.hproject", project.name);
+        snapshotSources.Record(filePath);
+
+        simdjson::ondemand::document doc;
+        if (Json::Load(filePath, doc))
+            Json::Read(doc, project, c_ProjectFileFields);
+    }
+
+    void DeserializePluginDesc(const std::filesystem::path& filePath, Plugin& desc)
+    {
+        HE_PROFILE_FUNCTION();
+
+        simdjson::ondemand::document doc;
+        if (!Json::Load(filePath, doc))
+            return;
+
+        Json::Read(doc, desc.info);
+        desc.info.installationState = InstallationState::Installed;
+    }
+
+    void DeserializeTemplate(const std::filesystem::path& filePath, Template& temp)
+    {
+        HE_PROFILE_FUNCTION();
+
+        simdjson::ondemand::document doc;
+        if (!Json::Load(filePath, doc))
+            return;
+
+        std::filesystem::path thumbnailPath = filePath.parent_path() / "thumbnail.jpg";
+        if (std::filesystem::exists(thumbnailPath))
+        {
+            if (device)
+                temp.thumbnail = Utils::LoadTexture(thumbnailPath, device, commandList);
+            temp.thumbnailPath = thumbnailPath;
+        }
+
+        Json::Read(doc, temp.info);
+        temp.info.installationState = InstallationState::Installed;
+    }
+
+    static Catalog::Page MakeCatalogPage(const Catalog::Index& index)
+    {
+        Catalog::Page page;
+        page.plugins.reserve(index.plugins.size());
+        page.templates.reserve(index.templates.size());
+
+        for (const auto& [name, e] : index.plugins)
+            page.plugins.push_back(e);
+        for (const auto& [name, e] : index.templates)
+            page.templates.push_back(e);
+
+        return page;
+    }
+
+    void MergeCatalogIndex(const Catalog::Index& index)
+    {
+        auto page = MakeCatalogPage(index);
+        MergeCatalogPage(page);
+    }
+
+    // Installed plugins keep their own descriptor and installed entries stay listed when the catalog drops them.
+    void MergeCatalogPage(Catalog::Page& page)
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto toInfo = [](Catalog::Entry& e) {
+            Info info;
+            info.name = std::move(e.name);
+            info.description = std::move(e.description);
+            info.URL = std::move(e.URL);
+            return info;
+        };
+
+        std::vector<Plugin> remotePlugins;
+        remotePlugins.reserve(page.plugins.size());
+        for (auto& e : page.plugins)
+            remotePlugins.push_back({ toInfo(e) });
+
+        std::vector<Template> remoteTemplates;
+        remoteTemplates.reserve(page.templates.size());
+        for (auto& e : page.templates)
+            remoteTemplates.emplace_back().info = toInfo(e);
+
+        auto isRemoved = [](const std::unordered_set<std::string_view>& removed, const Info& info) {
+            return info.installationState == InstallationState::NotInstalled && removed.contains(info.name);
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(pluginsMutex);
+            plugins.Merge(std::move(remotePlugins), [](Plugin& local, Plugin& remote) {
+                if (local.info.installationState != InstallationState::NotInstalled)
+                    return;
+
+                local.info.description = std::move(remote.info.description);
+                local.info.URL = std::move(remote.info.URL);
+            });
+
+            if (!page.removedPlugins.empty())
             {
-                ImGui::GetIO().FontGlobalScale = (float)ui["fontScale"].get_double().value();
-                selectedPage = (int)ui["selectedPage"].get_int64().value();
+                std::unordered_set<std::string_view> removed(page.removedPlugins.begin(), page.removedPlugins.end());
+                plugins.RemoveIf([&](const Plugin& p) { return isRemoved(removed, p.info); });
             }
         }
 
-        // settings
         {
-            auto settings = doc["settings"];
-            if (!settings.error())
+            std::lock_guard<std::mutex> lock(templatesMutex);
+            templates.Merge(std::move(remoteTemplates), [](Template& local, Template& remote) {
+                local.info.description = std::move(remote.info.description);
+                local.info.URL = std::move(remote.info.URL);
+            });
+
+            if (!page.removedTemplates.empty())
             {
-                openOutputDirAfterProjectBuild = settings["openOutputDirAfterProjectBuild"].get_bool().value();
-                buildAndRunProject = settings["buildAndRunProject"].get_bool().value();
-                showBuildOutput = settings["showBuildOutput"].get_bool().value();
+                std::unordered_set<std::string_view> removed(page.removedTemplates.begin(), page.removedTemplates.end());
+                templates.RemoveIf([&](const Template& t) { return isRemoved(removed, t.info); });
             }
         }
+    }
 
-        // engine
+    // after a full sync, drops the remote entries the catalog no longer has
+    void PruneCatalog(const std::unordered_set<std::string>& pluginNames, const std::unordered_set<std::string>& templateNames)
+    {
+        HE_PROFILE_FUNCTION();
+
+        std::scoped_lock lock(pluginsMutex, templatesMutex);
+        plugins.RemoveIf([&](const Plugin& p) { return p.info.installationState == InstallationState::NotInstalled && !pluginNames.contains(p.info.name); });
+        templates.RemoveIf([&](const Template& t) { return t.info.installationState == InstallationState::NotInstalled && !templateNames.contains(t.info.name); });
+    }
+
+#pragma endregion
+
+#pragma region Headless
+
+    struct HeadlessArgs
+    {
+        std::vector<std::string_view> positional; // the command first
+        std::map<std::string_view, std::string_view> options;
+    };
+
+    static bool IsHeadlessCommand(std::string_view command)
+    {
+        return std::ranges::find(c_HeadlessCommands, command) != std::end(c_HeadlessCommands);
+    }
+
+    // Runs one command on the same state and code paths as the UI, without window, RHI or ImGui, and prints
+    // its result as a single JSON line on stdout :
+    //
+    //   list
+    //   install-engine <directory>
+    //   create-project <name> <directory> [--template <name>] [--engine <id>]
+    //   build <project> [--config Debug|Release|Profile|Dist]
+    //   stage <project> [--config Debug|Release|Profile|Dist]
+    //   regenerate <project>
+    //   daemon
+    //   stop-daemon
+    //
+    // <project> is a project path or name. When a daemon is running the command is sent to it instead of
+    // loading the state here. Returns an ExitCode.
+    int RunHeadless(const std::vector<std::string_view>& args)
+    {
+        HE_PROFILE_FUNCTION();
+
+        HeadlessRequest request;
+        request.cwd = std::filesystem::current_path().string();
+        request.args.assign(args.begin(), args.end());
+
+        if (args[0] != "daemon")
         {
-            auto engine = doc["engine"].get_array();
-            if (!engine.error())
+            Json::Writer writer(true);
+            writer.Value(request);
+
+            std::string response;
+            auto socket = std::filesystem::absolute(GetAppDataDir() / c_DaemonSocketName).lexically_normal();
+            switch (Ipc::Call(socket, writer.GetString(), response, c_DaemonTimeout))
             {
-                installedInstances = 0;
-                for (auto e : engine)
-                {
-                    auto path = e["path"].get_c_str().value();
-                    auto state = e["state"].get_c_str().value();
+            case Ipc::CallResult::Answered:
+            {
+                std::puts(response.c_str());
 
-                    auto& ins = instances.emplace_back();
-                    ins.path = path;
-                    ins.installationState = InstallationState::fromString(state);
+                HeadlessResponse result;
+                simdjson::ondemand::document doc;
+                if (Json::Parse(response, doc))
+                    Json::Read(doc, result);
 
-                    if (IsValidHydraDirectory(path))
-                    {
-                        ins.id = Git::GetCurrentCommitId(path);
-                        installedInstances++;
-                    }
-                    else
-                    {
-                        ins.installationState = InstallationState::NotInstalled;
-                    }
-                }
+                return result.exitCode;
+            }
+            case Ipc::CallResult::Failed:
+            {
+                Json::Writer out(true);
+                out.BeginObject();
+                out.Key("command");
+                out.String(args[0]);
+                HeadlessError(out, ExitCode::Failed, "the daemon did not answer");
+                out.Key("ok");
+                out.Bool(false);
+                out.Member("exitCode", (int)ExitCode::Failed);
+                out.EndObject();
+                std::puts(out.GetString().c_str());
+                return ExitCode::Failed;
+            }
+            case Ipc::CallResult::NoServer:
+                break;
             }
         }
 
-        // projects
-        auto loadedProjects = doc["projects"].get_array();
-        if (!loadedProjects.error())
+        headless = true;
+        Git::Init();
+        InitPaths();
+
+        // the snapshot freshness check already ran inline
+        if (!LoadSnapshot())
+        {
+            LoadState();
+
+            Catalog::Index index;
+            if (index.Load(catalogFilePath))
+                MergeCatalogIndex(index);
+        }
+        else if (snapshotStale.exchange(false))
         {
-            projects.reserve(loadedProjects.size());
-            for (auto p : loadedProjects)
+            ReloadState();
+        }
+
+        if (args[0] == "daemon")
+            return RunDaemon();
+
+        persistence.Start();
+
+        int code = 0;
+        std::puts(ExecuteHeadless(request, code).c_str());
+
+        OnDetach();
+        return code;
+    }
+
+    // Serves the headless commands of other processes until stop-daemon, with the state, toolchain paths and
+    // git already loaded. Commands run one at a time, so clients never race each other on db.json : it is
+    // written before each answer, reloaded first when another process (the UI) wrote it meanwhile and merged
+    // when that happened while the command ran.
+    int RunDaemon()
+    {
+        HE_PROFILE_FUNCTION();
+
+        servingDaemon = true;
+        std::mutex commandMutex;
+
+        Ipc::Server server;
+        bool started = server.Start(socketFilePath, [&](std::string_view line) {
+            std::lock_guard lock(commandMutex);
+
+            HeadlessRequest request;
+            simdjson::ondemand::document doc;
+            if (Json::Parse(line, doc))
+                Json::Read(doc, request);
+
+            if (!snapshotSources.Matches(Snapshot::Source::Stat(databaseFilePath)))
+                ReloadState();
+
+            int code = 0;
+            auto output = ExecuteHeadless(request, code);
+
+            SubmitPendingWrites();
+            persistence.Flush();
+
+            if (databaseConflict.exchange(false))
             {
-                auto& proj = projects.emplace_back();
+                MergeDatabase();
+                SubmitPendingWrites();
+                persistence.Flush();
+            }
 
-                proj.name = p["name"].get_c_str().value();
-                proj.path = p["path"].get_c_str().value();
-                proj.includSourceCode = !p["includSourceCode"].error() ? p["includSourceCode"].get_bool().value() : proj.includSourceCode;
+            return output;
+        });
 
-                if (std::filesystem::exists(proj.path))
-                {
-                    DeserializeProject(proj);
-                }
+        Json::Writer out(true);
+        out.BeginObject();
+        out.Key("command");
+        out.String("daemon");
+        out.Member("socket", socketFilePath);
+        out.Key("ok");
+        out.Bool(started);
+        out.EndObject();
+        std::puts(out.GetString().c_str());
+        std::fflush(stdout);
+
+        if (started)
+            daemonStop.wait(false);
+
+        server.Stop();
+        OnDetach();
+
+        return started ? ExitCode::Ok : ExitCode::Failed;
+    }
+
+    std::string ExecuteHeadless(const HeadlessRequest& request, int& code)
+    {
+        headlessCwd = request.cwd;
+        std::vector<std::string_view> args(request.args.begin(), request.args.end());
+
+        Json::Writer out(true);
+        out.BeginObject();
+        out.Key("command");
+        out.String(args.empty() ? "" : args[0]);
+
+        code = args.empty() ? HeadlessError(out, ExitCode::Usage, "no command") : RunHeadlessCommand(args, out);
+
+        out.Key("ok");
+        out.Bool(code == ExitCode::Ok);
+        out.Member("exitCode", code);
+        out.EndObject();
+
+        return out.GetString();
+    }
+
+    // relative to the directory the command was started in, which is not the daemon's
+    std::filesystem::path ResolvePath(std::string_view path)
+    {
+        return (std::filesystem::path(headlessCwd) / path).lexically_normal();
+    }
+
+    int RunHeadlessCommand(const std::vector<std::string_view>& args, Json::Writer& out)
+    {
+        HeadlessArgs parsed;
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            if (!args[i].starts_with("--"))
+            {
+                parsed.positional.push_back(args[i]);
+                continue;
             }
+
+            if (i + 1 >= args.size())
+                return HeadlessError(out, ExitCode::Usage, std::format("missing value for {}", args[i]));
+
+            parsed.options[args[i]] = args[i + 1];
+            i++;
         }
+
+        uint8_t config = BuildConfig::Debug;
+        if (auto it = parsed.options.find("--config"); it != parsed.options.end() && !ParseConfig(it->second, config))
+            return HeadlessError(out, ExitCode::Usage, std::format("unknown config {}", it->second));
+
+        auto command = parsed.positional[0];
+        if (command == "list")
+            return HeadlessList(out);
+
+        // a client only sends this straight to the socket, RunHeadless starts daemons itself
+        if (command == "daemon")
+            return HeadlessError(out, ExitCode::Failed, "a daemon is already running");
+
+        if (command == "stop-daemon")
+        {
+            if (servingDaemon && !daemonStop.exchange(true))
+            {
+                daemonStop.notify_all();
+                return ExitCode::Ok;
+            }
+
+            return HeadlessError(out, ExitCode::NotFound, "no daemon is running");
+        }
+
+        if (command == "install-engine")
+            return HeadlessInstallEngine(parsed, out);
+
+        if (command == "create-project")
+            return HeadlessCreateProject(parsed, out);
+
+        if (parsed.positional.size() < 2)
+            return HeadlessError(out, ExitCode::Usage, std::format("usage : {} <project>", command));
+
+        Project* proj = FindProject(parsed.positional[1]);
+        if (!proj)
+            return HeadlessError(out, ExitCode::NotFound, std::format("project not found {}", parsed.positional[1]));
+
+        bool ok = false;
+        if (command == "build")
+        {
+            BuildProject(*proj, config);
+            ok = proj->buildSucceeded;
+        }
+        else if (command == "stage")
+        {
+            ok = StageProject(*proj, config);
+        }
+        else if (command == "regenerate")
+        {
+            ok = RunProjectPremake(*proj);
+        }
+
+        out.Key("project");
+        WriteHeadless(out, *proj);
+
+        if (command != "regenerate")
+        {
+            out.Key("config");
+            out.String(c_ConfigStr[config]);
+            out.Member("outputDir", GetProjectOutputDir(*proj, config));
+        }
+
+        return ok ? ExitCode::Ok : ExitCode::Failed;
     }
 
-    void SerializeProject(const Project& project)
+    int HeadlessList(Json::Writer& out)
     {
-        HE_PROFILE_FUNCTION();
+        out.Key("engines");
+        out.BeginArray();
+        for (const auto& e : instances)
+            WriteHeadless(out, e);
+        out.EndArray();
+
+        out.Key("projects");
+        out.BeginArray();
+        for (const auto& p : projects)
+            WriteHeadless(out, p);
+        out.EndArray();
+
+        std::scoped_lock lock(pluginsMutex, templatesMutex);
+
+        out.Key("templates");
+        out.BeginArray();
+        for (const auto& t : templates)
+            WriteHeadless(out, t.info);
+        out.EndArray();
+
+        out.Key("plugins");
+        out.BeginArray();
+        for (const auto& p : plugins)
+            WriteHeadless(out, p.info);
+        out.EndArray();
+
+        return ExitCode::Ok;
+    }
 
-        auto filePath = std::filesystem::path(project.path) / std::format("{}.hproject", project.name);
+    // clones and builds the engine into <directory>/HydraEngine, or registers the engine already there
+    int HeadlessInstallEngine(const HeadlessArgs& args, Json::Writer& out)
+    {
+        if (args.positional.size() < 2)
+            return HeadlessError(out, ExitCode::Usage, "usage : install-engine <directory>");
 
-        std::ofstream file(filePath);
-        if (!file.is_open())
+        auto dir = ResolvePath(args.positional[1]);
+        Engine& ins = RegisterEngine(dir);
+        if (ins.installationState != InstallationState::Installed)
         {
-            HE_ERROR("Unable to open file for writing, {}", filePath.string());
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            DownLoadEngine(ins);
         }
 
-        std::ostringstream oss;
-        oss << "{\n";
+        Serialize();
+
+        out.Key("engine");
+        WriteHeadless(out, ins);
 
+        return ins.installationState == InstallationState::Installed ? ExitCode::Ok : ExitCode::Failed;
+    }
+
+    int HeadlessCreateProject(const HeadlessArgs& args, Json::Writer& out)
+    {
+        if (args.positional.size() < 3)
+            return HeadlessError(out, ExitCode::Usage, "usage : create-project <name> <directory> [--template <name>] [--engine <id>]");
+
+        std::string name(args.positional[1]);
+        std::string directory = ResolvePath(args.positional[2]).string();
+
+        auto templateName = args.options.contains("--template") ? args.options.at("--template") : std::string_view();
+        int templateIndex = FindInstalledTemplate(templateName);
+        if (templateIndex < 0)
+            return HeadlessError(out, ExitCode::NotFound, std::format("template not installed {}", templateName));
+
+        Engine* engine = nullptr;
+        if (auto id = args.options.find("--engine"); id != args.options.end())
         {
-            oss << "\t\"engineID\" : \"" << project.engineID << "\"\n";
+            engine = instances.Find(id->second);
+            if (!engine)
+                return HeadlessError(out, ExitCode::NotFound, std::format("engine not found {}", id->second));
         }
 
-        oss << "}\n";
+        auto projectDir = std::filesystem::path(directory) / name;
+        if (std::filesystem::exists(projectDir))
+            return HeadlessError(out, ExitCode::Failed, std::format("project directory already exists {}", projectDir.string()));
+
+        CreateNewProject(name, directory, templateIndex);
 
-        file << oss.str();
-        file.close();
+        Project* proj = projects.Find(projectDir.string());
+        if (!proj)
+            return HeadlessError(out, ExitCode::Failed, "project creation failed");
+
+        if (engine)
+            ChangeEngineForProject(*proj, *engine);
+
+        out.Key("project");
+        WriteHeadless(out, *proj);
+
+        return ExitCode::Ok;
     }
 
-    void DeserializeProject(Project& project)
+    // the engine in dir or dir/HydraEngine, added when new and marked installed when its files are there
+    Engine& RegisterEngine(const std::filesystem::path& dir)
     {
-        HE_PROFILE_FUNCTION();
+        auto enginePath = IsValidHydraDirectory(dir) ? dir : dir / "HydraEngine";
 
-        auto filePath = std::filesystem::path(project.path) / std::format("{}.hproject", project.name);
+        auto it = std::find_if(instances.begin(), instances.end(), [&](const Engine& e) { return e.path == enginePath; });
+        Engine& ins = it != instances.end() ? *it : instances.Add();
+        ins.path = enginePath;
 
-        static simdjson::dom::parser parser;
-        auto doc = parser.load(filePath.string());
+        if (!IsBusy(ins.installationState) && IsValidHydraDirectory(ins.path))
+        {
+            ins.installationState = InstallationState::Installed;
+            ins.id = Git::GetCurrentCommitId(ins.path.string());
+            RecordEngineSources(ins.path);
+            instances.Reindex();
+        }
 
-        if (doc.error())
-            return;
+        return ins;
+    }
+
+    // index of the installed template called name, or of the first installed one when name is empty, -1 if none
+    int FindInstalledTemplate(std::string_view name)
+    {
+        auto it = std::find_if(templates.begin(), templates.end(), [&](const Template& t) {
+            return t.info.installationState == InstallationState::Installed && (name.empty() || t.info.name == name);
+        });
+
+        return it != templates.end() ? (int)(it - templates.begin()) : -1;
+    }
+
+    static bool ParseConfig(std::string_view str, uint8_t& config)
+    {
+        auto found = std::ranges::find(c_ConfigStr, str);
+        if (found == std::end(c_ConfigStr))
+            return false;
+
+        config = (uint8_t)(found - std::begin(c_ConfigStr));
+        return true;
+    }
+
+    // installing, building, deleting
+    static bool IsBusy(uint8_t state)
+    {
+        return state == InstallationState::Installing || state == InstallationState::Build || state == InstallationState::Wait;
+    }
+
+    // by path first, then by name
+    Project* FindProject(std::string_view pathOrName)
+    {
+        if (Project* proj = projects.Find(ResolvePath(pathOrName).string()))
+            return proj;
+
+        auto it = std::find_if(projects.begin(), projects.end(), [&](const Project& p) { return p.name == pathOrName || p.path == pathOrName; });
+        return it != projects.end() ? &*it : nullptr;
+    }
+
+    static int HeadlessError(Json::Writer& out, int code, std::string_view message)
+    {
+        out.Key("error");
+        out.String(message);
+        return code;
+    }
 
-        if (!doc["engineID"].error())
+    static void WriteHeadless(Json::Writer& out, const Engine& e)
+    {
+        out.BeginObject();
+        out.Member("id", e.id);
+        out.Member("path", e.path);
+        out.Key("state");
+        out.String(InstallationState::ToString(e.installationState));
+        out.EndObject();
+    }
+
+    static void WriteHeadless(Json::Writer& out, const Project& p)
+    {
+        out.BeginObject();
+        out.Member("name", p.name);
+        out.Member("path", p.path);
+        out.Member("engineID", p.engineID);
+        out.Member("includSourceCode", p.includSourceCode);
+        out.EndObject();
+    }
+
+    static void WriteHeadless(Json::Writer& out, const Info& info)
+    {
+        out.BeginObject();
+        out.Member("name", info.name);
+        out.Member("URL", info.URL);
+        out.Key("state");
+        out.String(InstallationState::ToString(info.installationState));
+        out.EndObject();
+    }
+
+#pragma endregion
+
+#pragma region Automation API
+
+    // JSON-RPC 2.0 on a local socket next to db.json, one request or batch per line (see Rpc). Methods :
+    //
+    //   BuildProject      { project, config }
+    //   RunProjectPremake { project }
+    //   DownLoad          { type : Plugin|Template, name }
+    //   DownLoadEngine    { directory }
+    //   CreateNewProject  { name, directory, template }
+    //   List, GetProgress
+    //   Subscribe         { intervalMs, untilIdle }
+    //
+    // The work is queued exactly as from the UI and the result is what was queued, its progress comes from
+    // GetProgress or Subscribe. Application errors use the ExitCode values.
+    void StartApi()
+    {
+        apiStopping = false;
+        if (!api.Start(apiSocketFilePath, [this](Ipc::Connection& connection) { ServeApi(connection); }, c_ApiSessions))
+            HE_ERROR("automation api unavailable on {}", apiSocketFilePath.string());
+    }
+
+    void StopApi()
+    {
+        apiStopping = true;
+        api.Stop();
+    }
+
+    void ServeApi(Ipc::Connection& connection)
+    {
+        std::string line;
+        while (connection.Receive(line, c_ApiIdleTimeout))
         {
-            project.engineID = doc["engineID"].get_c_str().value();
+            Rpc::Message<ApiParams> message;
+            if (!Rpc::Parse(line, message))
+            {
+                Json::Writer out(true);
+                Rpc::WriteError(out, "null", Rpc::ErrorCode::ParseError, "parse error");
+                if (!connection.Send(out.GetString(), c_ApiSendTimeout))
+                    return;
+
+                continue;
+            }
+
+            const auto& first = message.requests[0];
+            if (!message.batch && first.method == "Subscribe" && first.error == Rpc::ErrorCode::None)
+            {
+                if (!StreamProgress(connection, first))
+                    return;
+
+                continue;
+            }
+
+            // a whole batch runs between two frames, hundreds of builds are queued at once
+            auto response = RunOnUI([this, message = std::move(message)]() { return ExecuteApi(message); });
+            if (!response)
+                return;
+
+            if (!response->empty() && !connection.Send(*response, c_ApiSendTimeout))
+                return;
         }
     }
 
-    void DeserializePluginDesc(const std::filesystem::path& filePath, Plugin& desc)
+    // Runs task between two frames, where the tables are only touched by the UI, and waits for its result.
+    // Empty once the api stops, no task runs after that.
+    template<typename F>
+    std::optional<std::invoke_result_t<F&>> RunOnUI(F&& task)
     {
-        HE_PROFILE_FUNCTION();
+        using R = std::invoke_result_t<F&>;
 
-        static simdjson::dom::parser parser;
-        auto doc = parser.load(filePath.string());
+        auto promise = std::make_shared<std::promise<R>>();
+        auto future = promise->get_future();
+        {
+            std::lock_guard lock(uiTasksMutex);
+            uiTasks.emplace_back([promise, task = std::forward<F>(task)]() mutable { promise->set_value(task()); });
+        }
 
-        if (doc.error())
-            return;
+        while (future.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+        {
+            if (apiStopping)
+                return std::nullopt;
+        }
 
-        std::string_view name;
-        desc.info.name = (doc["name"].get(name) != simdjson::SUCCESS) ? "" : name;
+        return future.get();
+    }
 
-        std::string_view description;
-        desc.info.description = (doc["description"].get(description) != simdjson::SUCCESS) ? "" : description;
+    // runs task between two frames without waiting for it, at once when there are no frames
+    void PostToUI(std::function<void()> task)
+    {
+        if (headless)
+        {
+            task();
+            return;
+        }
 
-        std::string_view URL;
-        desc.info.URL = (doc["URL"].get(URL) != simdjson::SUCCESS) ? "" : URL;
+        std::lock_guard lock(uiTasksMutex);
+        uiTasks.emplace_back(std::move(task));
+    }
 
-        desc.info.installationState = InstallationState::Installed;
+    void RunUITasks()
+    {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard lock(uiTasksMutex);
+            tasks.swap(uiTasks);
+        }
+
+        for (auto& task : tasks)
+            task();
     }
 
-    void DeserializeTemplate(const std::filesystem::path& filePath, Template& temp)
+    // the response line, empty when every request was a notification
+    std::string ExecuteApi(const Rpc::Message<ApiParams>& message)
     {
         HE_PROFILE_FUNCTION();
 
-        static simdjson::dom::parser parser;
-        auto doc = parser.load(filePath.string());
+        Json::Writer out(true);
+        if (message.batch)
+            out.BeginArray();
 
-        if (doc.error())
-            return;
+        bool answered = false;
+        for (const auto& request : message.requests)
+        {
+            Rpc::Result result;
+            if (request.error != Rpc::ErrorCode::None)
+                result.Fail(request.error, request.error == Rpc::ErrorCode::InvalidParams ? "invalid params" : "invalid request");
+            else
+                CallApi(request, result);
 
-        nvrhi::TextureHandle texture;
+            // a notification that could not be read is still answered
+            if (request.IsNotification() && request.error == Rpc::ErrorCode::None)
+                continue;
 
-        std::filesystem::path thumbnailPath = filePath.parent_path() / "thumbnail.jpg";
-        if (std::filesystem::exists(thumbnailPath))
-            texture = Utils::LoadTexture(thumbnailPath, device, commandList);
+            Rpc::WriteResponse(out, request.id, result);
+            answered = true;
+        }
 
-        temp.info.name = doc["name"].get_c_str().value();
-        temp.info.description = doc["description"].get_c_str().value();
-        temp.info.URL = doc["URL"].get_c_str().value();
-        temp.info.installationState = InstallationState::Installed;
-        temp.thumbnail = texture;
+        if (message.batch)
+            out.EndArray();
+
+        return answered ? out.GetString() : std::string();
     }
 
-    void DeserializeAndAddRemoteInfo()
+    void CallApi(const Rpc::Request<ApiParams>& request, Rpc::Result& result)
     {
-        HE_PROFILE_FUNCTION();
+        const auto& method = request.method;
+        const auto& params = request.params;
+        auto& out = result.value;
 
-        static simdjson::dom::parser parser;
+        if (method == "List")
+        {
+            out.BeginObject();
+            HeadlessList(out);
+            out.EndObject();
+            return;
+        }
 
-        auto doc = parser.load(remoteInfoFilePath.string());
+        if (method == "GetProgress")
+        {
+            std::set<std::string> active;
+            WriteProgress(out, active);
+            return;
+        }
+
+        if (method == "Subscribe")
+            return result.Fail(Rpc::ErrorCode::InvalidRequest, "Subscribe must be sent alone");
 
-        auto pluginsArray = doc["plugins"].get_array();
-        if (!pluginsArray.error())
+        if (method == "BuildProject" || method == "RunProjectPremake")
         {
-            plugins.reserve(pluginsArray.size());
-            for (auto p : pluginsArray)
+            Project* proj = FindProject(params.project);
+            if (!proj || !std::filesystem::exists(proj->path))
+                return result.Fail(ExitCode::NotFound, std::format("project not found {}", params.project));
+
+            if (proj->isBuilding)
+                return result.Fail(ExitCode::Failed, std::format("{} is already building", proj->name));
+
+            if (method == "BuildProject")
             {
-                Plugin plugin;
-                plugin.info.name = p["name"].get_c_str().value();
-                plugin.info.description = p["description"].get_c_str().value();
-                plugin.info.URL = p["URL"].get_c_str().value();
+                uint8_t config;
+                if (!ParseConfig(params.config, config))
+                    return result.Fail(Rpc::ErrorCode::InvalidParams, std::format("unknown config {}", params.config));
 
-                if (IsPluginInstalled(plugin.info.name))
-                    continue;
+                BuildProject(*proj, config);
+            }
+            else
+            {
+                // busy like a build, so neither can start while premake writes the solution
+                proj->isBuilding = true;
+                Submit([this, proj]() {
+                    RunProjectPremake(*proj);
+                    proj->isBuilding = false;
+                });
+            }
+
+            WriteHeadless(out, *proj);
+            return;
+        }
 
-                std::lock_guard<std::mutex> lock(pluginsMutex);
-                plugins.push_back(std::move(plugin));
+        if (method == "DownLoad")
+        {
+            bool plugin = params.type == "Plugin";
+            if (!plugin && params.type != "Template")
+                return result.Fail(Rpc::ErrorCode::InvalidParams, "type must be Plugin or Template");
+
+            Info* info = nullptr;
+            {
+                std::scoped_lock lock(pluginsMutex, templatesMutex);
+                if (Plugin* p = plugin ? plugins.Find(params.name) : nullptr)
+                    info = &p->info;
+                else if (Template* t = plugin ? nullptr : templates.Find(params.name))
+                    info = &t->info;
             }
+
+            if (!info)
+                return result.Fail(ExitCode::NotFound, std::format("{} not found {}", params.type, params.name));
+
+            if (info->installationState == InstallationState::Installed || IsBusy(info->installationState))
+                return result.Fail(ExitCode::Failed, std::format("{} is already {}", info->name, InstallationState::ToString(info->installationState)));
+
+            DownLoad(*info, plugin ? RemoteType::Plugin : RemoteType::Template);
+            WriteHeadless(out, *info);
+            return;
         }
 
-        auto templatesArray = doc["templates"].get_array();
-        if (!templatesArray.error())
+        if (method == "DownLoadEngine")
         {
-            std::lock_guard<std::mutex> lock(templatesMutex);
-            templates.reserve(templatesArray.size());
-            for (auto t : templatesArray)
+            if (params.directory.empty())
+                return result.Fail(Rpc::ErrorCode::InvalidParams, "missing directory");
+
+            auto dir = std::filesystem::path(params.directory).lexically_normal();
+            Engine& ins = RegisterEngine(dir);
+            if (IsBusy(ins.installationState))
+                return result.Fail(ExitCode::Failed, std::format("{} is already {}", ins.path.string(), InstallationState::ToString(ins.installationState)));
+
+            if (ins.installationState != InstallationState::Installed)
             {
-                auto installedTemplate = GetTemplateByName(t["name"].get_c_str().value());
-                if (installedTemplate)
-                {
-                    installedTemplate->info.name = t["name"].get_c_str().value();
-                    installedTemplate->info.description = t["description"].get_c_str().value();
-                    installedTemplate->info.URL = t["URL"].get_c_str().value();
-                }
-                else
-                {
-                    auto& ins = templates.emplace_back();
-                    ins.info.name = t["name"].get_c_str().value();
-                    ins.info.description = t["description"].get_c_str().value();
-                    ins.info.URL = t["URL"].get_c_str().value();
-                }
+                std::error_code ec;
+                std::filesystem::create_directories(dir, ec);
+                DownLoadEngine(ins);
             }
+
+            Serialize();
+            WriteHeadless(out, ins);
+            return;
+        }
+
+        if (method == "CreateNewProject")
+        {
+            if (params.name.empty() || params.directory.empty())
+                return result.Fail(Rpc::ErrorCode::InvalidParams, "missing name or directory");
+
+            int templateIndex = FindInstalledTemplate(params.templateName);
+            if (templateIndex < 0)
+                return result.Fail(ExitCode::NotFound, std::format("template not installed {}", params.templateName));
+
+            auto projectDir = (std::filesystem::path(params.directory) / params.name).lexically_normal();
+            if (std::filesystem::exists(projectDir))
+                return result.Fail(ExitCode::Failed, std::format("project directory already exists {}", projectDir.string()));
+
+            CreateNewProject(params.name, params.directory, templateIndex);
+
+            out.BeginObject();
+            out.Member("name", params.name);
+            out.Member("path", projectDir);
+            out.Member("template", templates[templateIndex].info.name);
+            out.EndObject();
+            return;
         }
+
+        result.Fail(Rpc::ErrorCode::MethodNotFound, std::format("unknown method {}", method));
+    }
+
+    // Subscribe : answers, then sends a "progress" notification with the GetProgress result every intervalMs
+    // until the client sends its next line or hangs up, or after the first idle one with untilIdle. False when
+    // the connection is done.
+    bool StreamProgress(Ipc::Connection& connection, const Rpc::Request<ApiParams>& request)
+    {
+        auto interval = std::chrono::milliseconds(std::clamp<uint32_t>(request.params.intervalMs, 50, 10000));
+        auto active = std::make_shared<std::set<std::string>>(); // only touched on the UI thread
+
+        if (!request.IsNotification())
+        {
+            Rpc::Result result;
+            result.value.Bool(true);
+
+            Json::Writer out(true);
+            Rpc::WriteResponse(out, request.id, result);
+            if (!connection.Send(out.GetString(), c_ApiSendTimeout))
+                return false;
+        }
+
+        while (true)
+        {
+            auto notification = RunOnUI([this, active]() {
+                Json::Writer params(true);
+                bool idle = WriteProgress(params, *active);
+
+                Json::Writer out(true);
+                Rpc::WriteNotification(out, "progress", params.GetString());
+                return std::pair{ out.GetString(), idle };
+            });
+
+            if (!notification || !connection.Send(notification->first, c_ApiSendTimeout))
+                return false;
+
+            if (request.params.untilIdle && notification->second)
+                return true;
+
+            if (connection.WaitInput(interval))
+                return true;
+
+            if (connection.IsStopping())
+                return false;
+        }
+    }
+
+    // Operations in flight, read from the same state the tables draw, and once more the ones that ended since
+    // the previous call with the same active set. Returns true when nothing is in flight.
+    bool WriteProgress(Json::Writer& out, std::set<std::string>& active)
+    {
+        HE_PROFILE_FUNCTION();
+
+        std::set<std::string> current;
+        auto track = [&](std::string_view kind, std::string_view key, bool busy) {
+            if (!busy && active.empty())
+                return false;
+
+            auto id = std::format("{}:{}", kind, key);
+            bool ended = !busy && active.contains(id);
+            if (busy)
+                current.insert(std::move(id));
+
+            return busy || ended;
+        };
+
+        out.BeginObject();
+        out.Key("items");
+        out.BeginArray();
+
+        for (const auto& e : instances)
+        {
+            if (!track("engine", e.path.string(), IsBusy(e.installationState)))
+                continue;
+
+            out.BeginObject();
+            out.Key("kind");
+            out.String("engine");
+            out.Member("id", e.id);
+            out.Member("path", e.path);
+            out.Key("state");
+            out.String(InstallationState::ToString(e.installationState));
+            WriteProgress(out, e.progress);
+            out.EndObject();
+        }
+
+        {
+            std::scoped_lock lock(pluginsMutex, templatesMutex);
+
+            auto info = [&](std::string_view kind, const Info& i) {
+                if (!track(kind, i.name, IsBusy(i.installationState)))
+                    return;
+
+                out.BeginObject();
+                out.Key("kind");
+                out.String(kind);
+                out.Member("name", i.name);
+                out.Key("state");
+                out.String(InstallationState::ToString(i.installationState));
+                WriteProgress(out, i.progress);
+                out.EndObject();
+            };
+
+            for (const auto& p : plugins)
+                info("plugin", p.info);
+
+            for (const auto& t : templates)
+                info("template", t.info);
+        }
+
+        for (const auto& p : projects)
+        {
+            if (!track("project", p.path, p.isBuilding || p.stagingProgress.running))
+                continue;
+
+            out.BeginObject();
+            out.Key("kind");
+            out.String("project");
+            out.Member("name", p.name);
+            out.Member("path", p.path);
+            out.Member("building", p.isBuilding);
+            out.Member("staging", p.stagingProgress.running.load());
+            out.Member("buildSucceeded", p.buildSucceeded);
+            out.Member("completedFiles", p.stagingProgress.completedFiles.load());
+            out.Member("totalFiles", p.stagingProgress.totalFiles.load());
+            out.Member("completedBytes", p.stagingProgress.completedBytes.load());
+            out.Member("totalBytes", p.stagingProgress.totalBytes.load());
+            out.EndObject();
+        }
+
+        out.EndArray();
+
+        bool idle = current.empty();
+        out.Member("idle", idle);
+        out.EndObject();
+
+        active = std::move(current);
+        return idle;
+    }
+
+    static void WriteProgress(Json::Writer& out, const Git::ProgressInfo& progress)
+    {
+        out.Member("step", progress.stepName);
+        out.Member("completedSteps", progress.completedSteps);
+        out.Member("totalSteps", progress.totalSteps);
+        out.Member("receivedObjects", progress.fetchProgress.received_objects);
+        out.Member("totalObjects", progress.fetchProgress.total_objects);
     }
 
 #pragma endregion
 
 };
 
+// HydraLauncherBench compiles this file with its own entry point
+#ifndef HE_LAUNCHER_BENCH
 HE::ApplicationContext* HE::CreateApplication(ApplicationCommandLineArgs args)
 {
     HE_PROFILE_FUNCTION();
 
+    // headless commands run and exit before any window or device exists
+    if (args.count > 1 && HydraLauncher::IsHeadlessCommand(args[1]))
+    {
+        std::vector<std::string_view> commandArgs;
+        for (int i = 1; i < args.count; i++)
+            commandArgs.push_back(args[i]);
+
+        int code = 0;
+        {
+            HydraLauncher launcher;
+            code = launcher.RunHeadless(commandArgs);
+        }
+
+        std::exit(code);
+    }
+
     ApplicationDesc desc;
     desc.deviceDesc.api = {
         nvrhi::GraphicsAPI::D3D11,
@@ -2752,7 +4808,7 @@ HE::ApplicationContext* HE::CreateApplication(ApplicationCommandLineArgs args)
         nvrhi::GraphicsAPI::VULKAN,
     };
 
-    auto log = (Utils::GetAppDataPath(c_AppName) / c_AppName).string();
+    auto log = (GetAppDataDir() / c_AppName).string();
 
     desc.windowDesc.swapChainDesc.swapChainFormat = nvrhi::Format::SRGBA8_UNORM;
     desc.windowDesc.customTitlebar = true;
@@ -2768,4 +4824,5 @@ HE::ApplicationContext* HE::CreateApplication(ApplicationCommandLineArgs args)
     return ctx;
 }
 
-#include "HydraEngine/EntryPoint.h"
\ No newline at end of file
+#include "HydraEngine/EntryPoint.h"
+#endif
\ No newline at end of file
@@ -0,0 +1,347 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Integrity;
+
+import HE;
+import std;
+import Hash;
+import Utils;
+import CopyEngine;
+
+export namespace Integrity {
+
+	constexpr const char* c_ManifestFileName = ".hintegrity";
+	constexpr const char* c_ManifestHeader = "HydraIntegrity 1";
+	constexpr uint64_t c_ChunkSize = 4ull << 20;
+
+	struct Entry
+	{
+		std::string path; // relative to the output directory, '/' separated
+		uint64_t size = 0;
+		uint64_t hash = 0;
+	};
+
+	// Sorted file list closed by a root hash over every entry line, so a corrupt or truncated manifest fails to load.
+	// The root is an unkeyed checksum anyone can recompute : it detects corruption, not deliberate tampering.
+	struct Manifest
+	{
+		std::vector<Entry> entries;
+		uint64_t root = 0;
+
+		static std::string FormatEntry(const Entry& e) { return std::format("{} {} {}\n", Hash::ToString(e.hash), e.size, e.path); }
+
+		uint64_t ComputeRoot() const
+		{
+			Hash::XXH64 state;
+			state.Update(c_ManifestHeader, std::strlen(c_ManifestHeader));
+			for (const auto& e : entries)
+			{
+				auto line = FormatEntry(e);
+				state.Update(line.data(), line.size());
+			}
+
+			return state.Digest();
+		}
+
+		bool Write(const std::filesystem::path& filePath) const
+		{
+			std::ofstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+			{
+				HE_ERROR("Unable to open file for writing, {}", filePath.string());
+				return false;
+			}
+
+			file << c_ManifestHeader << "\n";
+			for (const auto& e : entries)
+				file << FormatEntry(e);
+			file << "root " << Hash::ToString(root) << "\n";
+
+			return file.good();
+		}
+
+		bool Read(const std::filesystem::path& filePath)
+		{
+			entries.clear();
+			root = 0;
+
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+				return false;
+
+			std::string line;
+			if (!std::getline(file, line) || line != c_ManifestHeader)
+				return false;
+
+			bool closed = false;
+			while (std::getline(file, line))
+			{
+				std::string_view view = line;
+				if (view.starts_with("root "))
+				{
+					closed = Hash::FromString(view.substr(5), root);
+					break;
+				}
+
+				size_t p0 = view.find(' ');
+				size_t p1 = view.find(' ', p0 + 1);
+				if (p0 == std::string_view::npos || p1 == std::string_view::npos)
+					return false;
+
+				Entry e;
+				auto sizeStr = view.substr(p0 + 1, p1 - p0 - 1);
+				if (!Hash::FromString(view.substr(0, p0), e.hash) || std::from_chars(sizeStr.data(), sizeStr.data() + sizeStr.size(), e.size).ec != std::errc())
+					return false;
+
+				e.path = view.substr(p1 + 1);
+				entries.push_back(std::move(e));
+			}
+
+			return closed && root == ComputeRoot();
+		}
+	};
+
+	struct Report
+	{
+		std::vector<std::string> missing;
+		std::vector<std::string> modified;
+		std::vector<std::string> unexpected;
+		bool manifestValid = false;
+		uint32_t fileCount = 0;
+		uint64_t byteCount = 0;
+		double seconds = 0.0;
+
+		bool Passed() const { return manifestValid && missing.empty() && modified.empty() && unexpected.empty(); }
+	};
+}
+
+// Internal
+namespace Integrity {
+
+	bool IsIgnored(std::string_view relative)
+	{
+		return relative == c_ManifestFileName || relative == ".hstage";
+	}
+
+	std::vector<Entry> ListFiles(const std::filesystem::path& dir)
+	{
+		std::vector<Entry> files;
+
+		std::error_code ec;
+		for (auto it = std::filesystem::recursive_directory_iterator(dir, std::filesystem::directory_options::follow_directory_symlink, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			if (!it->is_regular_file(ec))
+				continue;
+
+			Entry e;
+			e.path = it->path().lexically_relative(dir).generic_string();
+			if (IsIgnored(e.path))
+				continue;
+
+			e.size = it->file_size(ec);
+			files.push_back(std::move(e));
+		}
+
+		std::sort(files.begin(), files.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+		return files;
+	}
+
+	// Files are split into fixed chunks hashed independently, so one multi-GB file still spreads across
+	// every worker. The file hash is XXH64 over the chunk digests.
+	bool HashFiles(const std::filesystem::path& dir, std::vector<Entry>& files, std::vector<bool>* readable = nullptr)
+	{
+		struct Chunk
+		{
+			size_t file;
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		std::vector<size_t> firstChunk(files.size() + 1);
+		std::vector<Chunk> chunks;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			firstChunk[i] = chunks.size();
+			uint64_t offset = 0;
+			do
+			{
+				uint64_t size = std::min(c_ChunkSize, files[i].size - offset);
+				chunks.push_back({ i, offset, size });
+				offset += size;
+			} while (offset < files[i].size);
+		}
+		firstChunk[files.size()] = chunks.size();
+
+		std::vector<uint64_t> digests(chunks.size());
+		std::vector<uint8_t> failed(chunks.size(), 0);
+
+		CopyEngine::Queue queue;
+		queue.jobs.reserve(chunks.size());
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			queue.Add(dir / files[chunks[i].file].path, {}, chunks[i].size, [&, i](const CopyEngine::Job& job) {
+				const Chunk& chunk = chunks[i];
+
+				static thread_local std::vector<char> buffer(1 << 20);
+
+				std::ifstream file(job.src, std::ios::binary);
+				file.seekg(chunk.offset);
+
+				Hash::XXH64 state(chunk.offset / c_ChunkSize);
+				uint64_t remaining = chunk.size;
+				while (remaining > 0 && file)
+				{
+					file.read(buffer.data(), (std::streamsize)std::min<uint64_t>(remaining, buffer.size()));
+					state.Update(buffer.data(), (size_t)file.gcount());
+					remaining -= (uint64_t)file.gcount();
+				}
+
+				digests[i] = state.Digest();
+				failed[i] = remaining > 0;
+
+				return remaining == 0;
+			});
+		}
+
+		bool ok = queue.Run();
+
+		for (size_t i = 0; i < files.size(); i++)
+			files[i].hash = Hash::Compute(digests.data() + firstChunk[i], (firstChunk[i + 1] - firstChunk[i]) * sizeof(uint64_t));
+
+		if (readable)
+		{
+			readable->resize(files.size());
+			for (size_t i = 0; i < files.size(); i++)
+				(*readable)[i] = std::none_of(failed.begin() + firstChunk[i], failed.begin() + firstChunk[i + 1], [](uint8_t f) { return f != 0; });
+		}
+
+		return ok;
+	}
+}
+
+export namespace Integrity {
+
+	// Hashes the files under outputDir and writes the manifest next to them. Files listed in `unchanged` (relative,
+	// '/' separated) keep the hash of the previous manifest when their size still matches, the rest are read.
+	bool Generate(const std::filesystem::path& outputDir, const std::vector<std::string>& unchanged = {})
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+
+		Manifest manifest;
+		manifest.entries = ListFiles(outputDir);
+
+		Manifest previous;
+		std::unordered_map<std::string_view, const Entry*> reusable;
+		if (!unchanged.empty() && previous.Read(outputDir / c_ManifestFileName))
+		{
+			std::unordered_set<std::string_view> untouched(unchanged.begin(), unchanged.end());
+			for (const auto& e : previous.entries)
+			{
+				if (untouched.contains(e.path))
+					reusable[e.path] = &e;
+			}
+		}
+
+		std::vector<Entry> pending;
+		std::vector<size_t> pendingIndices;
+		for (size_t i = 0; i < manifest.entries.size(); i++)
+		{
+			Entry& e = manifest.entries[i];
+			auto it = reusable.find(e.path);
+			if (it != reusable.end() && it->second->size == e.size)
+			{
+				e.hash = it->second->hash;
+				continue;
+			}
+
+			pending.push_back(e);
+			pendingIndices.push_back(i);
+		}
+
+		if (!HashFiles(outputDir, pending))
+		{
+			HE_ERROR("Integrity : unable to read every file in {}", outputDir.string());
+			return false;
+		}
+
+		for (size_t i = 0; i < pending.size(); i++)
+			manifest.entries[pendingIndices[i]].hash = pending[i].hash;
+
+		manifest.root = manifest.ComputeRoot();
+		if (!manifest.Write(outputDir / c_ManifestFileName))
+			return false;
+
+		uint64_t bytes = 0;
+		for (const auto& e : manifest.entries)
+			bytes += e.size;
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		HE_INFO("Integrity {} : {} files ({}), {} hashed, root {} in {:.3f}s", outputDir.string(), manifest.entries.size(), Utils::FormatBytes(bytes), pending.size(), Hash::ToString(manifest.root), seconds);
+
+		return true;
+	}
+
+	// Re-hashes outputDir and compares it against its manifest.
+	Report Verify(const std::filesystem::path& outputDir)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		Report report;
+
+		Manifest manifest;
+		report.manifestValid = manifest.Read(outputDir / c_ManifestFileName);
+		if (!report.manifestValid)
+		{
+			HE_ERROR("Integrity : missing or corrupt manifest in {}", outputDir.string());
+			return report;
+		}
+
+		auto files = ListFiles(outputDir);
+		std::vector<bool> readable;
+		HashFiles(outputDir, files, &readable);
+
+		std::unordered_map<std::string_view, size_t> actual;
+		for (size_t i = 0; i < files.size(); i++)
+			actual[files[i].path] = i;
+
+		for (const auto& e : manifest.entries)
+		{
+			auto it = actual.find(e.path);
+			if (it == actual.end())
+			{
+				report.missing.push_back(e.path);
+				continue;
+			}
+
+			const Entry& f = files[it->second];
+			if (!readable[it->second] || f.size != e.size || f.hash != e.hash)
+				report.modified.push_back(e.path);
+
+			report.fileCount++;
+			report.byteCount += f.size;
+			actual.erase(it);
+		}
+
+		for (const auto& [path, index] : actual)
+			report.unexpected.emplace_back(path);
+		std::sort(report.unexpected.begin(), report.unexpected.end());
+
+		report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (const auto& path : report.missing) HE_ERROR("Integrity : missing {}", path);
+		for (const auto& path : report.modified) HE_ERROR("Integrity : modified {}", path);
+		for (const auto& path : report.unexpected) HE_WARN("Integrity : unexpected {}", path);
+
+		if (report.Passed())
+			HE_INFO("Integrity {} : {} files ({}) verified in {:.3f}s", outputDir.string(), report.fileCount, Utils::FormatBytes(report.byteCount), report.seconds);
+		else
+			HE_ERROR("Integrity {} : {} missing, {} modified, {} unexpected", outputDir.string(), report.missing.size(), report.modified.size(), report.unexpected.size());
+
+		return report;
+	}
+}
@@ -0,0 +1,416 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#ifdef HE_PLATFORM_WINDOWS
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+export module Ipc;
+
+import HE;
+import std;
+import Pipeline;
+
+// Local line exchanges over a Unix domain socket (AF_UNIX, also on Windows 10+). A plain Server connection
+// carries one request line from the client and one response line back, then closes, a session Server hands
+// the whole connection to its handler.
+
+// Internal
+namespace Ipc {
+
+	using Clock = std::chrono::steady_clock;
+
+#ifdef HE_PLATFORM_WINDOWS
+	using Fd = SOCKET;
+	constexpr Fd c_InvalidFd = INVALID_SOCKET;
+	constexpr int c_SendFlags = 0;
+
+	void CloseFd(Fd fd) { closesocket(fd); }
+	int Poll(pollfd* fds, uint32_t count, int timeout) { return WSAPoll(fds, count, timeout); }
+	bool Interrupted() { return false; }
+	bool WouldBlock() { int e = WSAGetLastError(); return e == WSAEWOULDBLOCK || e == WSAEINTR; }
+
+	bool InitSockets()
+	{
+		static bool initialized = []() {
+			WSADATA data;
+			return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+		}();
+
+		return initialized;
+	}
+
+	void SetNonBlocking(Fd fd)
+	{
+		u_long mode = 1;
+		ioctlsocket(fd, FIONBIO, &mode);
+	}
+
+	// not inherited by the processes the launcher starts
+	Fd OpenSocket() { return WSASocketW(AF_UNIX, SOCK_STREAM, 0, nullptr, 0, WSA_FLAG_NO_HANDLE_INHERIT); }
+
+	Fd AcceptFd(Fd listener)
+	{
+		Fd fd = accept(listener, nullptr, nullptr);
+		if (fd != c_InvalidFd)
+			SetHandleInformation((HANDLE)fd, HANDLE_FLAG_INHERIT, 0);
+
+		return fd;
+	}
+#else
+	using Fd = int;
+	constexpr Fd c_InvalidFd = -1;
+	constexpr int c_SendFlags = MSG_NOSIGNAL;
+
+	void CloseFd(Fd fd) { close(fd); }
+	int Poll(pollfd* fds, uint32_t count, int timeout) { return poll(fds, count, timeout); }
+	bool Interrupted() { return errno == EINTR; }
+	bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+	bool InitSockets() { return true; }
+	void SetNonBlocking(Fd fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+	// not inherited by the processes the launcher starts
+	Fd OpenSocket() { return socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0); }
+	Fd AcceptFd(Fd listener) { return accept4(listener, nullptr, nullptr, SOCK_CLOEXEC); }
+#endif
+
+	constexpr size_t c_MaxLine = 16 * 1024 * 1024;
+	constexpr uint32_t c_Workers = 4;
+	constexpr auto c_StopPoll = std::chrono::milliseconds(100); // how long a session may take to notice Stop
+
+	int Remaining(Clock::time_point deadline)
+	{
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+		return (int)std::clamp<int64_t>(ms, 0, std::numeric_limits<int>::max());
+	}
+
+	bool MakeAddress(const std::filesystem::path& path, sockaddr_un& address)
+	{
+		auto str = path.string();
+		if (str.size() >= sizeof(address.sun_path))
+		{
+			HE_ERROR("Ipc : socket path too long {}", str);
+			return false;
+		}
+
+		address = {};
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, str.c_str(), str.size());
+		return true;
+	}
+
+	class Stream
+	{
+	public:
+		explicit Stream(Fd fd = c_InvalidFd) : fd(fd) {}
+		Stream(const Stream&) = delete;
+		Stream& operator=(const Stream&) = delete;
+		~Stream() { if (fd != c_InvalidFd) CloseFd(fd); }
+
+		bool Connect(const std::filesystem::path& path)
+		{
+			sockaddr_un address;
+			if (!InitSockets() || !MakeAddress(path, address))
+				return false;
+
+			fd = OpenSocket();
+			if (fd == c_InvalidFd)
+				return false;
+
+			// connecting to a local socket never blocks for long, only the exchange is bounded
+			if (connect(fd, (const sockaddr*)&address, sizeof(address)) != 0)
+				return false;
+
+			SetNonBlocking(fd);
+			return true;
+		}
+
+		bool SendLine(std::string_view data, Clock::time_point deadline)
+		{
+			std::string line(data);
+			line += '\n';
+
+			std::string_view rest = line;
+			while (!rest.empty())
+			{
+				auto n = send(fd, rest.data(), (int)rest.size(), c_SendFlags);
+				if (n > 0)
+					rest.remove_prefix(n);
+				else if (n < 0 && !WouldBlock())
+					return Fail();
+				else if (!Wait(POLLOUT, deadline))
+					return false;
+			}
+
+			return true;
+		}
+
+		// bytes past the line are kept for the next call
+		bool ReceiveLine(std::string& out, Clock::time_point deadline)
+		{
+			char buffer[64 * 1024];
+			while (true)
+			{
+				if (size_t eol = pending.find('\n'); eol != std::string::npos)
+				{
+					out.assign(pending, 0, eol);
+					pending.erase(0, eol + 1);
+					return true;
+				}
+
+				if (pending.size() > c_MaxLine)
+					return false;
+
+				auto n = recv(fd, buffer, (int)sizeof(buffer), 0);
+				if (n > 0)
+					pending.append(buffer, n);
+				else if (n == 0 || !WouldBlock())
+					return Fail();
+				else if (!Wait(POLLIN, deadline))
+					return false;
+			}
+		}
+
+		// a line or the peer's hang up is waiting
+		bool HasInput(Clock::time_point deadline)
+		{
+			return closed || pending.find('\n') != std::string::npos || Wait(POLLIN, deadline) || closed;
+		}
+
+		// hung up or broken, nothing more goes through
+		bool IsClosed() const { return closed; }
+
+	private:
+		bool Fail()
+		{
+			closed = true;
+			return false;
+		}
+
+		// false on timeout, and closes on an error or a hang up with nothing left to read
+		bool Wait(short events, Clock::time_point deadline)
+		{
+			pollfd p = { fd, events, 0 };
+			int r;
+			do r = Poll(&p, 1, Remaining(deadline));
+			while (r < 0 && Interrupted());
+
+			if (r < 0 || (p.revents & (POLLERR | POLLNVAL)) || ((p.revents & POLLHUP) && !(p.revents & events)))
+				return Fail();
+
+			return r > 0;
+		}
+
+		Fd fd = c_InvalidFd;
+		std::string pending;
+		bool closed = false;
+	};
+}
+
+export namespace Ipc {
+
+	// one connection of a session Server, waits give up early once the server stops
+	class Connection
+	{
+	public:
+		Connection(Stream& stream, const std::atomic<bool>& stopping) : stream(stream), stopping(stopping) {}
+
+		// false on timeout, hang up or Stop, a line already sent is still received after Stop
+		bool Receive(std::string& line, std::chrono::milliseconds timeout)
+		{
+			auto deadline = Clock::now() + timeout;
+			do
+			{
+				if (stream.ReceiveLine(line, std::min(deadline, Clock::now() + c_StopPoll)))
+					return true;
+
+				if (stream.IsClosed() || Clock::now() >= deadline)
+					return false;
+			}
+			while (!stopping);
+
+			return false;
+		}
+
+		bool Send(std::string_view line, std::chrono::milliseconds timeout)
+		{
+			return stream.SendLine(line, Clock::now() + timeout);
+		}
+
+		// true as soon as the client sent a line or hung up, false after timeout
+		bool WaitInput(std::chrono::milliseconds timeout)
+		{
+			auto deadline = Clock::now() + timeout;
+			while (!stopping && Clock::now() < deadline)
+			{
+				if (stream.HasInput(std::min(deadline, Clock::now() + c_StopPoll)))
+					return true;
+			}
+
+			return false;
+		}
+
+		bool IsStopping() const { return stopping; }
+
+	private:
+		Stream& stream;
+		const std::atomic<bool>& stopping;
+	};
+
+	using Handler = std::function<std::string(std::string_view request)>;
+	using SessionHandler = std::function<void(Connection& connection)>;
+
+	enum class CallResult : uint8_t
+	{
+		Answered,
+		NoServer, // nothing listens on the path, the caller can do the work itself
+		Failed    // the server took the request but did not answer in time or went away
+	};
+
+	// sends one request and waits for its response
+	CallResult Call(const std::filesystem::path& path, std::string_view request, std::string& response, std::chrono::milliseconds timeout)
+	{
+		HE_PROFILE_FUNCTION();
+
+		Stream stream;
+		if (!stream.Connect(path))
+			return CallResult::NoServer;
+
+		auto deadline = Clock::now() + timeout;
+		response.clear();
+		if (!stream.SendLine(request, deadline) || !stream.ReceiveLine(response, deadline))
+			return CallResult::Failed;
+
+		return CallResult::Answered;
+	}
+
+	// Accepts connections on one thread and serves them on a few workers, handler may be called from several
+	// of them at once.
+	class Server
+	{
+	public:
+		~Server() { Stop(); }
+
+		// Fails when another server answers on path. A socket file left behind by a crashed server is replaced.
+		bool Start(const std::filesystem::path& path, Handler handler, std::chrono::milliseconds requestTimeout = std::chrono::seconds(10))
+		{
+			return Start(path, [handler = std::move(handler), requestTimeout](Connection& connection) {
+				std::string request;
+				if (!connection.Receive(request, requestTimeout))
+					return;
+
+				// the response may take as long as the work, a build for example
+				connection.Send(handler(request), requestTimeout);
+			}, c_Workers);
+		}
+
+		// Each connection goes to handler until it returns, at most `workers` of them at once, the others wait
+		// to be accepted.
+		bool Start(const std::filesystem::path& path, SessionHandler handler, uint32_t workers)
+		{
+			sockaddr_un address;
+			if (!InitSockets() || !MakeAddress(path, address))
+				return false;
+
+			{
+				Stream probe;
+				if (probe.Connect(path))
+				{
+					HE_ERROR("Ipc : a server already listens on {}", path.string());
+					return false;
+				}
+			}
+
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+
+			listener = OpenSocket();
+			if (listener == c_InvalidFd)
+				return false;
+
+			if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0)
+			{
+				HE_ERROR("Ipc : unable to listen on {}", path.string());
+				CloseFd(listener);
+				listener = c_InvalidFd;
+				return false;
+			}
+
+			SetNonBlocking(listener);
+			this->path = path;
+			this->handler = std::move(handler);
+			stopping = false;
+
+			for (uint32_t i = 0; i < workers; i++)
+				this->workers.emplace_back([this]() { Serve(); });
+
+			acceptor = std::jthread([this](std::stop_token token) { Accept(token); });
+			return true;
+		}
+
+		// Stops accepting, lets the requests already accepted finish and removes the socket file. Sessions see
+		// Connection::IsStopping and their waits return.
+		void Stop()
+		{
+			if (listener == c_InvalidFd)
+				return;
+
+			acceptor.request_stop();
+			acceptor.join();
+			stopping = true;
+			connections.Close();
+			workers.clear();
+
+			CloseFd(listener);
+			listener = c_InvalidFd;
+
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+		}
+
+	private:
+		void Accept(std::stop_token token)
+		{
+			while (!token.stop_requested())
+			{
+				pollfd p = { listener, POLLIN, 0 };
+				if (Poll(&p, 1, 100) <= 0)
+					continue;
+
+				Fd fd = AcceptFd(listener);
+				if (fd != c_InvalidFd)
+					connections.Push(fd);
+			}
+		}
+
+		void Serve()
+		{
+			Fd fd;
+			while (connections.Pop(fd))
+			{
+				Stream stream(fd);
+				SetNonBlocking(fd);
+
+				Connection connection(stream, stopping);
+				handler(connection);
+			}
+		}
+
+		std::filesystem::path path;
+		SessionHandler handler;
+		std::atomic<bool> stopping = false;
+		Fd listener = c_InvalidFd;
+		Pipeline::Channel<Fd> connections;
+		std::vector<std::jthread> workers;
+		std::jthread acceptor;
+	};
+}
@@ -0,0 +1,474 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Json;
+
+import HE;
+import std;
+import simdjson;
+
+// Field descriptors for launcher types, one Writer and one on-demand reader driven by them.
+//
+//   template<> struct Json::Schema<Engine>
+//   {
+//       static constexpr auto fields = std::tuple{
+//           Json::MakeField("path", &Engine::path),
+//           Json::MakeField<StateCodec>("state", &Engine::installationState),
+//       };
+//   };
+//
+// Missing keys keep the member's current value and unknown keys are skipped, so older files still load.
+
+export namespace Json {
+
+	// Read/Write for one C++ type, specialize it (or pass a codec to MakeField) for custom representations.
+	template<typename T>
+	struct Codec;
+
+	template<typename T>
+	struct Schema;
+
+	template<typename T>
+	concept Described = requires { Schema<T>::fields; };
+
+	template<typename Class, typename Member, typename C = Codec<Member>>
+	struct Field
+	{
+		using CodecType = C;
+
+		std::string_view name;
+		Member Class::* member;
+	};
+
+	template<typename Class, typename Member>
+	constexpr Field<Class, Member> MakeField(std::string_view name, Member Class::* member) { return { name, member }; }
+
+	template<typename C, typename Class, typename Member>
+	constexpr Field<Class, Member, C> MakeField(std::string_view name, Member Class::* member) { return { name, member }; }
+
+	// Tab-indented output in the layout the launcher files always had, or a single line when compact (line
+	// delimited protocols). Clear keeps the buffer's capacity, so a long-lived Writer does not allocate once
+	// warmed up.
+	class Writer
+	{
+	public:
+		explicit Writer(bool compact = false) : compact(compact) {}
+
+		void Clear()
+		{
+			buffer.clear();
+			depth = 0;
+			first = true;
+			afterKey = false;
+		}
+
+		const std::string& GetString() const { return buffer; }
+
+		void BeginObject() { Open('{'); }
+		void EndObject() { Close('}'); }
+		void BeginArray() { Open('['); }
+		void EndArray() { Close(']'); }
+
+		void Key(std::string_view key)
+		{
+			Separator();
+			Quote(key);
+			buffer += " : ";
+			afterKey = true;
+		}
+
+		void Null() { Separator(); buffer += "null"; }
+		void Bool(bool value) { Separator(); buffer += value ? "true" : "false"; }
+
+		template<typename T>
+		void Number(T value)
+		{
+			Separator();
+
+			char tmp[32];
+			auto result = std::to_chars(tmp, tmp + sizeof(tmp), value);
+			buffer.append(tmp, result.ptr);
+		}
+
+		void String(std::string_view value) { Separator(); Quote(value); }
+
+		// an already encoded value, written as is
+		void Raw(std::string_view json) { Separator(); buffer += json; }
+
+		template<typename T>
+		void Value(const T& value) { Codec<T>::Write(*this, value); }
+
+		template<typename T>
+		void Member(std::string_view key, const T& value)
+		{
+			Key(key);
+			Value(value);
+		}
+
+	private:
+		void Open(char c)
+		{
+			Separator();
+			buffer += c;
+			depth++;
+			first = true;
+		}
+
+		void Close(char c)
+		{
+			depth--;
+			if (!first)
+				NewLine();
+
+			buffer += c;
+			first = false;
+
+			if (depth == 0 && !compact)
+				buffer += '\n';
+		}
+
+		void Separator()
+		{
+			if (afterKey)
+			{
+				afterKey = false;
+				return;
+			}
+
+			if (depth == 0)
+				return;
+
+			if (!first)
+				buffer += ',';
+
+			NewLine();
+			first = false;
+		}
+
+		void NewLine()
+		{
+			if (compact)
+				return;
+
+			buffer += '\n';
+			buffer.append(depth, '\t');
+		}
+
+		void Quote(std::string_view str)
+		{
+			static constexpr char c_Hex[] = "0123456789abcdef";
+
+			buffer += '"';
+			for (char c : str)
+			{
+				switch (c)
+				{
+				case '"':  buffer += "\\\""; break;
+				case '\\': buffer += "\\\\"; break;
+				case '\b': buffer += "\\b"; break;
+				case '\f': buffer += "\\f"; break;
+				case '\n': buffer += "\\n"; break;
+				case '\r': buffer += "\\r"; break;
+				case '\t': buffer += "\\t"; break;
+				default:
+					if ((uint8_t)c < 0x20)
+					{
+						buffer += "\\u00";
+						buffer += c_Hex[(uint8_t)c >> 4];
+						buffer += c_Hex[(uint8_t)c & 0xF];
+					}
+					else
+					{
+						buffer += c;
+					}
+				}
+			}
+			buffer += '"';
+		}
+
+		std::string buffer;
+		uint32_t depth = 0;
+		bool first = true;
+		bool afterKey = false;
+		bool compact = false;
+	};
+
+	using Value = simdjson::ondemand::value;
+
+	// Calls fn(key, value) for each member of an object in document order, fn returns false to stop.
+	template<typename Fn>
+	bool ForEachField(Value value, Fn&& fn)
+	{
+		simdjson::ondemand::object object;
+		if (value.get_object().get(object) != simdjson::SUCCESS)
+			return false;
+
+		for (auto field : object)
+		{
+			std::string_view key;
+			Value fieldValue;
+			if (field.unescaped_key().get(key) != simdjson::SUCCESS || field.value().get(fieldValue) != simdjson::SUCCESS)
+				return false;
+
+			if (!fn(key, fieldValue))
+				return false;
+		}
+
+		return true;
+	}
+
+	template<typename T, typename... Fields>
+	void WriteObject(Writer& writer, const T& object, const std::tuple<Fields...>& fields)
+	{
+		writer.BeginObject();
+		std::apply([&](const auto&... field) {
+			((writer.Key(field.name), std::remove_cvref_t<decltype(field)>::CodecType::Write(writer, object.*(field.member))), ...);
+		}, fields);
+		writer.EndObject();
+	}
+
+	// A field that fails to read (wrong type) keeps its current value.
+	template<typename T, typename... Fields>
+	bool ReadObject(Value value, T& object, const std::tuple<Fields...>& fields)
+	{
+		return ForEachField(value, [&](std::string_view key, Value fieldValue) {
+			std::apply([&](const auto&... field) {
+				bool matched = false;
+				((!matched && field.name == key ? (matched = true, std::remove_cvref_t<decltype(field)>::CodecType::Read(fieldValue, object.*(field.member))) : false), ...);
+			}, fields);
+			return true;
+		});
+	}
+
+	template<>
+	struct Codec<bool>
+	{
+		static void Write(Writer& writer, bool value) { writer.Bool(value); }
+		static bool Read(Value value, bool& out) { return value.get_bool().get(out) == simdjson::SUCCESS; }
+	};
+
+	template<typename T> requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+	struct Codec<T>
+	{
+		static void Write(Writer& writer, T value) { writer.Number(value); }
+
+		static bool Read(Value value, T& out)
+		{
+			if constexpr (std::is_signed_v<T>)
+			{
+				int64_t v;
+				if (value.get_int64().get(v) != simdjson::SUCCESS || !std::in_range<T>(v))
+					return false;
+				out = (T)v;
+			}
+			else
+			{
+				uint64_t v;
+				if (value.get_uint64().get(v) != simdjson::SUCCESS || !std::in_range<T>(v))
+					return false;
+				out = (T)v;
+			}
+
+			return true;
+		}
+	};
+
+	template<typename T> requires std::is_floating_point_v<T>
+	struct Codec<T>
+	{
+		static void Write(Writer& writer, T value) { writer.Number(value); }
+
+		static bool Read(Value value, T& out)
+		{
+			double v;
+			if (value.get_double().get(v) != simdjson::SUCCESS)
+				return false;
+
+			out = (T)v;
+			return true;
+		}
+	};
+
+	template<>
+	struct Codec<std::string>
+	{
+		static void Write(Writer& writer, const std::string& value) { writer.String(value); }
+
+		static bool Read(Value value, std::string& out)
+		{
+			std::string_view v;
+			if (value.get_string().get(v) != simdjson::SUCCESS)
+				return false;
+
+			out = v;
+			return true;
+		}
+	};
+
+	template<>
+	struct Codec<std::filesystem::path>
+	{
+		static void Write(Writer& writer, const std::filesystem::path& value) { writer.String(value.string()); }
+
+		static bool Read(Value value, std::filesystem::path& out)
+		{
+			std::string_view v;
+			if (value.get_string().get(v) != simdjson::SUCCESS)
+				return false;
+
+			out = v;
+			return true;
+		}
+	};
+
+	template<typename T>
+	struct Codec<std::vector<T>>
+	{
+		static void Write(Writer& writer, const std::vector<T>& value)
+		{
+			writer.BeginArray();
+			for (const auto& e : value)
+				writer.Value(e);
+			writer.EndArray();
+		}
+
+		// replaces the content, elements that fail to read are dropped
+		static bool Read(Value value, std::vector<T>& out)
+		{
+			simdjson::ondemand::array array;
+			if (value.get_array().get(array) != simdjson::SUCCESS)
+				return false;
+
+			out.clear();
+			for (auto element : array)
+			{
+				Value v;
+				if (element.get(v) != simdjson::SUCCESS)
+					return false;
+
+				T e{};
+				if (Codec<T>::Read(v, e))
+					out.push_back(std::move(e));
+			}
+
+			return true;
+		}
+	};
+
+	template<typename T, size_t N>
+	struct Codec<T[N]>
+	{
+		static void Write(Writer& writer, const T(&value)[N])
+		{
+			writer.BeginArray();
+			for (const auto& e : value)
+				writer.Value(e);
+			writer.EndArray();
+		}
+
+		// extra elements are ignored, missing ones keep their value
+		static bool Read(Value value, T(&out)[N])
+		{
+			simdjson::ondemand::array array;
+			if (value.get_array().get(array) != simdjson::SUCCESS)
+				return false;
+
+			size_t i = 0;
+			for (auto element : array)
+			{
+				Value v;
+				if (element.get(v) != simdjson::SUCCESS)
+					return false;
+
+				if (i < N)
+					Codec<T>::Read(v, out[i]);
+				i++;
+			}
+
+			return true;
+		}
+	};
+
+	template<Described T>
+	struct Codec<T>
+	{
+		static void Write(Writer& writer, const T& value) { WriteObject(writer, value, Schema<T>::fields); }
+		static bool Read(Value value, T& out) { return ReadObject(value, out, Schema<T>::fields); }
+	};
+
+	template<typename T>
+	bool Read(Value value, T& out) { return Codec<T>::Read(value, out); }
+
+	// Per-thread parser and padded read buffer, reused by every Load/Parse on that thread, so concurrent loads
+	// never share a parser. A document is valid until the next Load/Parse on the same thread.
+	class ThreadParser
+	{
+	public:
+		static ThreadParser& Get()
+		{
+			static thread_local ThreadParser parser;
+			return parser;
+		}
+
+		// sized for `size` bytes plus simdjson's padding, anything past the content is zeroed
+		char* Prepare(size_t size)
+		{
+			// a buffer that grew past this is released on the next smaller document, so one large file does not pin memory
+			constexpr size_t c_RetainedCapacity = 1 << 20;
+
+			if (size < c_RetainedCapacity && buffer.capacity() > c_RetainedCapacity)
+			{
+				buffer = {};
+				parser = simdjson::ondemand::parser();
+			}
+
+			buffer.resize(size + simdjson::SIMDJSON_PADDING);
+			std::memset(buffer.data() + size, 0, simdjson::SIMDJSON_PADDING);
+			return buffer.data();
+		}
+
+		bool Iterate(size_t size, simdjson::ondemand::document& doc)
+		{
+			return parser.iterate(buffer.data(), size, buffer.size()).get(doc) == simdjson::SUCCESS;
+		}
+
+	private:
+		simdjson::ondemand::parser parser;
+		std::vector<char> buffer;
+	};
+
+	bool Load(const std::filesystem::path& filePath, simdjson::ondemand::document& doc)
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+
+		size_t size = (size_t)file.tellg();
+		file.seekg(0);
+
+		auto& parser = ThreadParser::Get();
+		return file.read(parser.Prepare(size), (std::streamsize)size) && parser.Iterate(size, doc);
+	}
+
+	bool Parse(std::string_view text, simdjson::ondemand::document& doc)
+	{
+		auto& parser = ThreadParser::Get();
+		std::memcpy(parser.Prepare(text.size()), text.data(), text.size());
+		return parser.Iterate(text.size(), doc);
+	}
+
+	// Reads a whole document into out, either through its Schema or an explicit field list.
+	template<typename T, typename... Fields>
+	bool Read(simdjson::ondemand::document& doc, T& out, const std::tuple<Fields...>& fields)
+	{
+		Value value;
+		return doc.get_value().get(value) == simdjson::SUCCESS && ReadObject(value, out, fields);
+	}
+
+	template<Described T>
+	bool Read(simdjson::ondemand::document& doc, T& out)
+	{
+		return Read(doc, out, Schema<T>::fields);
+	}
+}
@@ -0,0 +1,452 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#ifdef HE_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+export module LibStore;
+
+import HE;
+import std;
+import Hash;
+import Utils;
+import CopyEngine;
+import Staging;
+
+// Content-addressed store for extracted ThirdParty libraries, shared by every engine instance.
+//
+//   objects/<hh>/<hash>-<size>   one file per unique content
+//   archives/<hash>              "<object> <path>" lines, what an archive extracts to
+//   refs/<owner>                 archives used by one engine instance
+//   lock                         held while refs, archives or objects change
+//
+// An archive already in the store is never extracted again, the instance is populated with links.
+// Install and Release of every process take turns on the lock, so a Release never sees objects whose archive is
+// not written yet. Extracting, hashing and linking run outside of it.
+
+export namespace LibStore {
+
+	constexpr const char* c_ArchiveHeader = "HydraLibArchive 1";
+
+	struct Summary
+	{
+		uint32_t fileCount = 0;
+		uint32_t newObjects = 0;   // contents that were not in the store yet
+		uint64_t newBytes = 0;
+		uint32_t linkedFiles = 0;  // hard links, the rest were copied
+		bool extracted = false;    // false when the archive was already in the store
+		bool succeeded = false;
+	};
+
+	using ExtractFn = std::function<bool(const std::filesystem::path& outputDir)>;
+}
+
+// Internal
+namespace LibStore {
+
+	struct File
+	{
+		std::string object;
+		std::string path; // relative to the lib directory, '/' separated
+	};
+
+	// Exclusive lock on the store, across the threads of this process and across processes.
+	class StoreLock
+	{
+	public:
+		explicit StoreLock(const std::filesystem::path& root) : guard(GetMutex())
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(root, ec);
+			auto path = root / "lock";
+
+#ifdef HE_PLATFORM_WINDOWS
+			handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			OVERLAPPED overlapped = {};
+			if (handle != INVALID_HANDLE_VALUE && !LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+			{
+				CloseHandle(handle);
+				handle = INVALID_HANDLE_VALUE;
+			}
+
+			if (handle == INVALID_HANDLE_VALUE)
+				HE_ERROR("LibStore : unable to lock {}, only this process is excluded", path.string());
+#else
+			fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+			while (fd >= 0 && flock(fd, LOCK_EX) != 0)
+			{
+				if (errno != EINTR)
+				{
+					close(fd);
+					fd = -1;
+				}
+			}
+
+			if (fd < 0)
+				HE_ERROR("LibStore : unable to lock {}, only this process is excluded", path.string());
+#endif
+		}
+
+		~StoreLock()
+		{
+#ifdef HE_PLATFORM_WINDOWS
+			if (handle != INVALID_HANDLE_VALUE)
+				CloseHandle(handle); // releases the lock
+#else
+			if (fd >= 0)
+				close(fd); // releases the lock
+#endif
+		}
+
+		StoreLock(const StoreLock&) = delete;
+		StoreLock& operator=(const StoreLock&) = delete;
+
+	private:
+		static std::mutex& GetMutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		std::lock_guard<std::mutex> guard;
+#ifdef HE_PLATFORM_WINDOWS
+		HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+		int fd = -1;
+#endif
+	};
+
+	std::filesystem::path GetObjectPath(const std::filesystem::path& root, std::string_view object)
+	{
+		return root / "objects" / std::string(object.substr(0, 2)) / std::string(object);
+	}
+
+	bool ReadArchive(const std::filesystem::path& filePath, std::vector<File>& files)
+	{
+		files.clear();
+
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		std::string line;
+		if (!std::getline(file, line) || line != c_ArchiveHeader)
+			return false;
+
+		while (std::getline(file, line))
+		{
+			size_t space = line.find(' ');
+			if (space == std::string::npos || space + 1 >= line.size())
+				return false;
+
+			File f{ line.substr(0, space) };
+			if (!Utils::IsContainedPath(std::string_view(line).substr(space + 1), f.path))
+			{
+				HE_ERROR("LibStore : invalid path in archive {}, {}", filePath.string(), line.substr(space + 1));
+				return false;
+			}
+
+			files.push_back(std::move(f));
+		}
+
+		return true;
+	}
+
+	bool WriteArchive(const std::filesystem::path& filePath, const std::vector<File>& files)
+	{
+		auto tmpPath = filePath;
+		tmpPath += ".tmp";
+
+		{
+			std::ofstream file(tmpPath, std::ios::binary);
+			if (!file.is_open())
+			{
+				HE_ERROR("Unable to open file for writing, {}", tmpPath.string());
+				return false;
+			}
+
+			file << c_ArchiveHeader << "\n";
+			for (const auto& f : files)
+				file << f.object << " " << f.path << "\n";
+
+			if (!file.good())
+				return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, filePath, ec);
+		return !ec;
+	}
+
+	std::set<std::string> ReadRefs(const std::filesystem::path& filePath)
+	{
+		std::set<std::string> refs;
+		std::ifstream file(filePath);
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (!line.empty())
+				refs.insert(line);
+		}
+
+		return refs;
+	}
+
+	bool AddRef(const std::filesystem::path& root, const std::string& owner, const std::string& archive)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(root / "refs", ec);
+
+		auto refsPath = root / "refs" / owner;
+		auto refs = ReadRefs(refsPath);
+		if (!refs.insert(archive).second)
+			return true;
+
+		std::ofstream file(refsPath, std::ios::binary | std::ios::trunc);
+		for (const auto& ref : refs)
+			file << ref << "\n";
+
+		return file.good();
+	}
+
+	// Names the object of every file extracted to tmpDir, sorted by path.
+	bool HashExtracted(const std::filesystem::path& tmpDir, std::vector<File>& files)
+	{
+		std::vector<std::filesystem::path> paths;
+		std::error_code ec;
+		for (auto it = std::filesystem::recursive_directory_iterator(tmpDir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			if (it->is_regular_file(ec))
+				paths.push_back(it->path());
+		}
+
+		files.resize(paths.size());
+
+		CopyEngine::Queue queue;
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			queue.Add(paths[i], {}, 0, [&, i](const CopyEngine::Job& job) {
+				uint64_t hash = 0;
+				std::error_code ec;
+				uint64_t size = std::filesystem::file_size(job.src, ec);
+				if (ec || !Hash::ComputeFile(job.src, hash))
+				{
+					HE_ERROR("LibStore : unable to read {}", job.src.string());
+					return false;
+				}
+
+				files[i].path = job.src.lexically_relative(tmpDir).generic_string();
+				files[i].object = std::format("{}-{}", Hash::ToString(hash), size);
+				return true;
+			});
+		}
+
+		bool ok = queue.Run();
+		std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.path < b.path; });
+		return ok;
+	}
+
+	// Moves the contents the store does not have yet into objects/, renames only. Called under the store lock.
+	bool AddObjects(const std::filesystem::path& root, const std::filesystem::path& tmpDir, const std::vector<File>& files, Summary& summary)
+	{
+		for (const auto& f : files)
+		{
+			std::error_code ec;
+			auto objectPath = GetObjectPath(root, f.object);
+			if (std::filesystem::exists(objectPath, ec))
+				continue;
+
+			// two files of the same archive may share a content, the first one is moved
+			std::filesystem::create_directories(objectPath.parent_path(), ec);
+			std::filesystem::rename(tmpDir / f.path, objectPath, ec);
+			if (ec)
+			{
+				HE_ERROR("LibStore : {} : {}", objectPath.string(), ec.message());
+				return false;
+			}
+
+			summary.newObjects++;
+			summary.newBytes += std::filesystem::file_size(objectPath, ec);
+		}
+
+		return true;
+	}
+
+	bool Populate(const std::filesystem::path& root, const std::vector<File>& files, const std::filesystem::path& outputDir, Summary& summary)
+	{
+		std::atomic<uint32_t> linked = 0;
+
+		CopyEngine::Queue queue;
+		for (const auto& f : files)
+		{
+			queue.Add(GetObjectPath(root, f.object), outputDir / f.path, 0, [&linked](const CopyEngine::Job& job) {
+				// libs are only read by the engine build, so sharing the inode is safe. falls back to a copy across volumes
+				std::error_code ec;
+				auto used = Staging::Materialize(job.src, job.dst, Staging::Strategy::HardLink, ec);
+				if (ec)
+				{
+					HE_ERROR("LibStore : {} : {}", job.dst.string(), ec.message());
+					return false;
+				}
+
+				if (used != Staging::Strategy::Copy)
+					linked++;
+
+				return true;
+			});
+		}
+
+		bool ok = queue.Run();
+		summary.linkedFiles = linked;
+		return ok;
+	}
+}
+
+export namespace LibStore {
+
+	// Stable owner name for an engine instance.
+	std::string GetOwner(const std::filesystem::path& instancePath)
+	{
+		return Hash::ToString(Hash::Compute(std::filesystem::absolute(instancePath).lexically_normal().generic_string()));
+	}
+
+	// Places the content of `archive` under outputDir through the store. extract is only called when the store
+	// has never seen this archive, it must unpack it into the directory it is given.
+	Summary Install(const std::filesystem::path& root, const std::filesystem::path& archive, const std::filesystem::path& outputDir, const std::string& owner, const ExtractFn& extract)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		Summary summary;
+
+		uint64_t archiveHash = 0;
+		if (!Hash::ComputeFile(archive, archiveHash))
+		{
+			HE_ERROR("LibStore : unable to read {}", archive.string());
+			return summary;
+		}
+
+		std::error_code ec;
+		auto archiveKey = Hash::ToString(archiveHash);
+		auto archivePath = root / "archives" / archiveKey;
+		std::filesystem::create_directories(archivePath.parent_path(), ec);
+
+		std::vector<File> files;
+		bool known = false;
+		{
+			// referenced before anything is written, a Release never deletes a known archive we now use
+			StoreLock lock(root);
+			if (!AddRef(root, owner, archiveKey))
+				return summary;
+
+			known = ReadArchive(archivePath, files) && std::all_of(files.begin(), files.end(), [&](const File& f) {
+				std::error_code ec;
+				return std::filesystem::exists(GetObjectPath(root, f.object), ec);
+			});
+		}
+
+		if (!known)
+		{
+			summary.extracted = true;
+
+			auto tmpDir = root / "tmp" / std::format("{}-{:x}", archiveKey, std::chrono::steady_clock::now().time_since_epoch().count());
+			std::filesystem::create_directories(tmpDir, ec);
+
+			// new objects and the archive that references them appear together, under the lock
+			bool ok = extract(tmpDir) && HashExtracted(tmpDir, files);
+			if (ok)
+			{
+				StoreLock lock(root);
+				ok = AddObjects(root, tmpDir, files, summary) && WriteArchive(archivePath, files);
+			}
+
+			std::filesystem::remove_all(tmpDir, ec);
+
+			if (!ok)
+			{
+				HE_ERROR("LibStore : unable to add {}", archive.string());
+				return summary;
+			}
+		}
+
+		summary.fileCount = (uint32_t)files.size();
+		summary.succeeded = Populate(root, files, outputDir, summary);
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		HE_INFO(
+			"LibStore : {} {} files, {} new ({}), {} linked in {:.3f}s",
+			archive.filename().string(),
+			summary.fileCount,
+			summary.newObjects,
+			Utils::FormatBytes(summary.newBytes),
+			summary.linkedFiles,
+			seconds
+		);
+
+		return summary;
+	}
+
+	// Drops the references of owner, then deletes every archive no instance uses and every object no
+	// remaining archive uses.
+	void Release(const std::filesystem::path& root, const std::string& owner)
+	{
+		HE_PROFILE_FUNCTION();
+
+		StoreLock lock(root);
+
+		std::error_code ec;
+		std::filesystem::remove(root / "refs" / owner, ec);
+
+		std::set<std::string> liveArchives;
+		for (auto it = std::filesystem::directory_iterator(root / "refs", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+		{
+			auto refs = ReadRefs(it->path());
+			liveArchives.insert(refs.begin(), refs.end());
+		}
+
+		std::unordered_map<std::string, uint32_t> refCounts;
+		uint32_t deletedArchives = 0;
+		for (auto it = std::filesystem::directory_iterator(root / "archives", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+		{
+			auto name = it->path().filename().string();
+			if (name.ends_with(".tmp"))
+				continue;
+
+			std::vector<File> files;
+			if (!liveArchives.contains(name) || !ReadArchive(it->path(), files))
+			{
+				std::error_code rec;
+				std::filesystem::remove(it->path(), rec);
+				deletedArchives++;
+				continue;
+			}
+
+			for (const auto& f : files)
+				refCounts[f.object]++;
+		}
+
+		uint32_t deletedObjects = 0;
+		uint64_t freedBytes = 0;
+		for (auto it = std::filesystem::recursive_directory_iterator(root / "objects", ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			if (!it->is_regular_file(ec) || refCounts.contains(it->path().filename().string()))
+				continue;
+
+			std::error_code rec;
+			uint64_t size = it->file_size(rec);
+			if (std::filesystem::remove(it->path(), rec))
+			{
+				deletedObjects++;
+				freedBytes += size;
+			}
+		}
+
+		HE_INFO("LibStore : released {}, removed {} archives and {} objects ({})", owner, deletedArchives, deletedObjects, Utils::FormatBytes(freedBytes));
+	}
+}
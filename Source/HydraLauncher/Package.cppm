@@ -0,0 +1,696 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#include <stdio.h>
+
+export module Package;
+
+import HE;
+import std;
+import Utils;
+import CopyEngine;
+import Zip;
+import Pipeline;
+
+export namespace Package {
+
+	struct Summary
+	{
+		std::filesystem::path archivePath;
+		uint32_t fileCount = 0;
+		uint64_t inputBytes = 0;  // tar stream size
+		uint64_t outputBytes = 0; // archive size on disk
+		double seconds = 0.0;
+		bool compressed = false;
+		bool succeeded = false;
+
+		double GetRatio() const { return inputBytes ? (double)outputBytes / (double)inputBytes : 0.0; }
+		double GetThroughput() const { return seconds > 0.0 ? (double)inputBytes / seconds : 0.0; }
+	};
+}
+
+// Internal
+namespace Package {
+
+	constexpr size_t c_BlockSize = 512;
+
+	// entries are written with fixed metadata so identical trees give byte-identical archives
+	constexpr uint64_t c_FixedMTime = 0;
+
+	struct TarHeader
+	{
+		char name[100];
+		char mode[8];
+		char uid[8];
+		char gid[8];
+		char size[12];
+		char mtime[12];
+		char checksum[8];
+		char typeflag;
+		char linkname[100];
+		char magic[6];
+		char version[2];
+		char uname[32];
+		char gname[32];
+		char devmajor[8];
+		char devminor[8];
+		char prefix[155];
+		char pad[12];
+	};
+	static_assert(sizeof(TarHeader) == c_BlockSize);
+
+	struct Entry
+	{
+		std::string name; // archive path, '/' separated
+		std::filesystem::path path;
+		uint64_t size = 0;
+		bool directory = false;
+		bool executable = false;
+	};
+
+	// std::FILE* sink, a pipe into the compressor or the archive itself
+	class Writer
+	{
+	public:
+		Writer(std::FILE* file) : file(file) {}
+
+		bool Write(const void* data, size_t size)
+		{
+			if (std::fwrite(data, 1, size, file) != size)
+				return false;
+
+			written += size;
+			return true;
+		}
+
+		bool Pad()
+		{
+			static const char zeros[c_BlockSize] = {};
+			size_t rem = written % c_BlockSize;
+			return rem == 0 || Write(zeros, c_BlockSize - rem);
+		}
+
+		uint64_t written = 0;
+
+	private:
+		std::FILE* file;
+	};
+
+	void WriteOctal(char* dst, size_t size, uint64_t value)
+	{
+		std::memset(dst, '0', size - 1);
+		dst[size - 1] = '\0';
+		for (size_t i = size - 1; i > 0 && value; i--)
+		{
+			dst[i - 1] = (char)('0' + (value & 7));
+			value >>= 3;
+		}
+	}
+
+	bool WriteHeader(Writer& out, std::string_view name, uint64_t size, char type, uint32_t mode)
+	{
+		TarHeader h = {};
+		std::memcpy(h.name, name.data(), std::min(name.size(), sizeof(h.name)));
+		WriteOctal(h.mode, sizeof(h.mode), mode);
+		WriteOctal(h.uid, sizeof(h.uid), 0);
+		WriteOctal(h.gid, sizeof(h.gid), 0);
+		WriteOctal(h.size, sizeof(h.size), size);
+		WriteOctal(h.mtime, sizeof(h.mtime), c_FixedMTime);
+		h.typeflag = type;
+		std::memcpy(h.magic, "ustar", 6);
+		std::memcpy(h.version, "00", 2);
+
+		std::memset(h.checksum, ' ', sizeof(h.checksum));
+		uint32_t sum = 0;
+		for (size_t i = 0; i < sizeof(h); i++)
+			sum += ((const uint8_t*)&h)[i];
+		WriteOctal(h.checksum, 7, sum);
+
+		return out.Write(&h, sizeof(h));
+	}
+
+	// pax record : "<len> <key>=<value>\n", len counts itself
+	std::string PaxRecord(std::string_view key, std::string_view value)
+	{
+		size_t base = key.size() + value.size() + 3;
+		size_t len = base + std::to_string(base).size();
+		if (std::to_string(len).size() != std::to_string(base).size())
+			len++;
+
+		return std::format("{} {}={}\n", len, key, value);
+	}
+
+	bool IsExecutable(const std::filesystem::path& path)
+	{
+		auto ext = path.extension();
+		return ext == ".exe" || ext == ".dll" || ext == ".so";
+	}
+
+	bool WriteEntryHeader(Writer& out, const Entry& e)
+	{
+		std::string name = e.directory ? e.name + "/" : e.name;
+		uint64_t maxSize = 077777777777ull;
+
+		// long paths and >8 GiB files go through a pax extended header
+		if (name.size() > 100 || e.size > maxSize)
+		{
+			std::string pax;
+			if (name.size() > 100)
+				pax += PaxRecord("path", name);
+			if (e.size > maxSize)
+				pax += PaxRecord("size", std::to_string(e.size));
+
+			if (!WriteHeader(out, "PaxHeader", pax.size(), 'x', 0644) || !out.Write(pax.data(), pax.size()) || !out.Pad())
+				return false;
+		}
+
+		uint32_t mode = e.directory || e.executable ? 0755 : 0644;
+		return WriteHeader(out, name, e.directory ? 0 : std::min(e.size, maxSize), e.directory ? '5' : '0', mode);
+	}
+
+	bool WriteEntry(Writer& out, const Entry& e)
+	{
+		if (!WriteEntryHeader(out, e))
+			return false;
+
+		if (e.directory)
+			return true;
+
+		std::ifstream file(e.path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		static thread_local std::vector<char> buffer(1 << 20);
+		uint64_t remaining = e.size;
+		while (remaining > 0)
+		{
+			file.read(buffer.data(), (std::streamsize)std::min<uint64_t>(remaining, buffer.size()));
+			size_t n = (size_t)file.gcount();
+			if (n == 0 || !out.Write(buffer.data(), n))
+				return false;
+
+			remaining -= n;
+		}
+
+		return out.Pad();
+	}
+
+	std::vector<Entry> ListEntries(const std::filesystem::path& dir, const std::string& root)
+	{
+		std::vector<Entry> entries;
+		entries.push_back({ root, dir, 0, true, false });
+
+		std::error_code ec;
+		for (auto it = std::filesystem::recursive_directory_iterator(dir, std::filesystem::directory_options::follow_directory_symlink, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			auto relative = it->path().lexically_relative(dir).generic_string();
+			if (relative == ".hstage")
+				continue;
+
+			Entry e;
+			e.name = root + "/" + relative;
+			e.path = it->path();
+			e.directory = it->is_directory(ec);
+			if (!e.directory)
+			{
+				if (!it->is_regular_file(ec))
+					continue;
+
+				e.size = it->file_size(ec);
+				auto perms = it->status(ec).permissions();
+				e.executable = IsExecutable(e.path) || (perms & std::filesystem::perms::owner_exec) != std::filesystem::perms::none;
+			}
+
+			entries.push_back(std::move(e));
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+		return entries;
+	}
+
+	std::FILE* OpenPipe(const std::string& cmd, bool write = true)
+	{
+#ifdef HE_PLATFORM_WINDOWS
+		return _popen(cmd.c_str(), write ? "wb" : "rb");
+#else
+		return popen(cmd.c_str(), write ? "w" : "r");
+#endif
+	}
+
+	int ClosePipe(std::FILE* pipe)
+	{
+#ifdef HE_PLATFORM_WINDOWS
+		return _pclose(pipe);
+#else
+		return pclose(pipe);
+#endif
+	}
+
+	// started directly, a missing zstd fails to start instead of being reported by a shell that did start
+	bool HasZstd()
+	{
+		static bool found = Utils::RunProcess("zstd -q --version") == 0;
+		return found;
+	}
+
+	// Streams the tar produced by writeEntries into `zstd -T0`, or a plain .tar when zstd is not installed.
+	// The archive is written next to its final path and renamed once complete.
+	Summary WriteTar(const std::filesystem::path& archiveBasePath, const std::function<bool(Writer& out, uint32_t& fileCount)>& writeEntries)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Summary summary;
+		summary.compressed = HasZstd();
+		summary.archivePath = archiveBasePath;
+		summary.archivePath += summary.compressed ? ".tar.zst" : ".tar";
+
+		auto tmpPath = summary.archivePath;
+		tmpPath += ".tmp";
+
+		std::error_code ec;
+		std::filesystem::create_directories(summary.archivePath.parent_path(), ec);
+
+		std::FILE* file = nullptr;
+		if (summary.compressed)
+			file = OpenPipe(std::format("zstd -q -f -T0 -9 -o \"{}\"", tmpPath.string()));
+		else
+			file = std::fopen(tmpPath.string().c_str(), "wb");
+
+		if (!file)
+		{
+			HE_ERROR("Package : unable to create {}", summary.archivePath.string());
+			return summary;
+		}
+
+		Writer out(file);
+		bool ok = writeEntries(out, summary.fileCount);
+
+		// end of archive, two zero blocks
+		static const char zeros[c_BlockSize * 2] = {};
+		ok = ok && out.Write(zeros, sizeof(zeros));
+
+		if (summary.compressed)
+			ok = ClosePipe(file) == 0 && ok;
+		else
+			ok = std::fclose(file) == 0 && ok;
+
+		if (ok)
+			std::filesystem::rename(tmpPath, summary.archivePath, ec);
+
+		if (!ok || ec)
+		{
+			HE_ERROR("Package : failed to write {}", summary.archivePath.string());
+			std::filesystem::remove(tmpPath, ec);
+			return summary;
+		}
+
+		summary.succeeded = true;
+		summary.inputBytes = out.written;
+		summary.outputBytes = std::filesystem::file_size(summary.archivePath, ec);
+		summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		HE_INFO(
+			"Package {} : {} files, {} -> {} (ratio {:.3f}) in {:.3f}s, {}/s",
+			summary.archivePath.string(),
+			summary.fileCount,
+			Utils::FormatBytes(summary.inputBytes),
+			Utils::FormatBytes(summary.outputBytes),
+			summary.GetRatio(),
+			summary.seconds,
+			Utils::FormatBytes((uint64_t)summary.GetThroughput())
+		);
+
+		return summary;
+	}
+
+	bool ReadExact(std::FILE* file, void* data, size_t size)
+	{
+		return std::fread(data, 1, size, file) == size;
+	}
+
+	bool Skip(std::FILE* file, uint64_t size)
+	{
+		static thread_local std::vector<char> buffer(1 << 16);
+		while (size > 0)
+		{
+			size_t n = (size_t)std::min<uint64_t>(size, buffer.size());
+			if (!ReadExact(file, buffer.data(), n))
+				return false;
+			size -= n;
+		}
+
+		return true;
+	}
+
+	uint64_t ReadOctal(const char* src, size_t size)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < size && src[i] >= '0' && src[i] <= '7'; i++)
+			value = (value << 3) | (uint64_t)(src[i] - '0');
+
+		return value;
+	}
+
+	std::string_view ReadField(const char* src, size_t size)
+	{
+		return std::string_view(src, std::find(src, src + size, '\0'));
+	}
+
+	uint64_t PaddedSize(uint64_t size)
+	{
+		return (size + c_BlockSize - 1) / c_BlockSize * c_BlockSize;
+	}
+
+	// pax records we care about : path and size, the rest is ignored
+	void ParsePax(std::string_view data, std::string& path, std::optional<uint64_t>& size)
+	{
+		while (!data.empty())
+		{
+			size_t space = data.find(' ');
+			size_t len = 0;
+			if (space == std::string_view::npos || std::from_chars(data.data(), data.data() + space, len).ec != std::errc() || len == 0 || len > data.size())
+				return;
+
+			std::string_view record = data.substr(space + 1, len - space - 2);
+			size_t eq = record.find('=');
+			if (eq != std::string_view::npos)
+			{
+				auto key = record.substr(0, eq);
+				auto value = record.substr(eq + 1);
+				if (key == "path")
+					path = value;
+				else if (key == "size")
+				{
+					uint64_t v = 0;
+					if (std::from_chars(value.data(), value.data() + value.size(), v).ec == std::errc())
+						size = v;
+				}
+			}
+
+			data.remove_prefix(len);
+		}
+	}
+
+	// Reads a tar stream and writes it under outputDir. The stream is read on the calling thread while files
+	// are created and written by a few writer threads, so decompression, parsing and disk writes all overlap.
+	// Files larger than c_DirectWriteSize are written by the reader to keep memory bounded.
+	bool ExtractTar(std::FILE* in, const std::filesystem::path& outputDir, uint32_t& fileCount, uint64_t& byteCount)
+	{
+		constexpr uint64_t c_DirectWriteSize = 4ull << 20;
+		constexpr uint64_t c_MaxBufferedBytes = 256ull << 20;
+
+		struct File
+		{
+			std::filesystem::path path;
+			std::vector<char> data;
+			bool executable = false;
+		};
+
+		std::atomic<uint64_t> buffered = 0;
+		std::atomic<bool> writeFailed = false;
+		Pipeline::Channel<File> files;
+
+		auto write = [&writeFailed](const File& f) {
+			std::ofstream out(f.path, std::ios::binary | std::ios::trunc);
+			out.write(f.data.data(), (std::streamsize)f.data.size());
+			if (!out.good())
+			{
+				HE_ERROR("Package : unable to write {}", f.path.string());
+				writeFailed = true;
+			}
+		};
+
+		auto setExecutable = [](const std::filesystem::path& path) {
+			std::error_code ec;
+			std::filesystem::permissions(path, std::filesystem::perms::owner_exec | std::filesystem::perms::group_exec | std::filesystem::perms::others_exec, std::filesystem::perm_options::add, ec);
+		};
+
+		std::vector<std::jthread> writers;
+		for (uint32_t i = 0; i < std::max(CopyEngine::GetDefaultWorkerCount() / 2, 1u); i++)
+		{
+			writers.emplace_back([&]() {
+				File f;
+				while (files.Pop(f))
+				{
+					write(f);
+					if (f.executable)
+						setExecutable(f.path);
+
+					buffered -= f.data.size();
+					buffered.notify_one();
+				}
+			});
+		}
+
+		bool ok = false;
+		std::string longName;
+		std::optional<uint64_t> paxSize;
+		std::vector<char> buffer(1 << 20);
+
+		TarHeader h;
+		while (ReadExact(in, &h, sizeof(h)))
+		{
+			const uint8_t* raw = (const uint8_t*)&h;
+			if (std::all_of(raw, raw + sizeof(h), [](uint8_t b) { return b == 0; }))
+			{
+				ok = true;
+				break;
+			}
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < sizeof(h); i++)
+				sum += (i >= offsetof(TarHeader, checksum) && i < offsetof(TarHeader, checksum) + sizeof(h.checksum)) ? ' ' : raw[i];
+			if (sum != ReadOctal(h.checksum, sizeof(h.checksum)))
+			{
+				HE_ERROR("Package : corrupted tar header");
+				break;
+			}
+
+			uint64_t size = paxSize.value_or(ReadOctal(h.size, sizeof(h.size)));
+			std::string name = longName;
+			if (name.empty())
+			{
+				auto prefix = ReadField(h.prefix, sizeof(h.prefix));
+				name = prefix.empty() ? std::string(ReadField(h.name, sizeof(h.name))) : std::format("{}/{}", prefix, ReadField(h.name, sizeof(h.name)));
+			}
+
+			// extended headers describe the next entry
+			if (h.typeflag == 'x' || h.typeflag == 'L')
+			{
+				std::string data(size, '\0');
+				if (!ReadExact(in, data.data(), size) || !Skip(in, PaddedSize(size) - size))
+					break;
+
+				if (h.typeflag == 'L')
+					longName = ReadField(data.data(), data.size());
+				else
+					ParsePax(data, longName, paxSize);
+
+				continue;
+			}
+
+			longName.clear();
+			paxSize.reset();
+
+			auto relative = std::filesystem::path(name).lexically_normal();
+			if (relative.is_absolute() || relative.has_root_name() || (!relative.empty() && *relative.begin() == ".."))
+			{
+				HE_ERROR("Package : {} escapes the output directory", name);
+				break;
+			}
+
+			auto dst = outputDir / relative;
+			std::error_code ec;
+
+			if (h.typeflag == '5')
+			{
+				std::filesystem::create_directories(dst, ec);
+				continue;
+			}
+
+			// links, devices and global headers carry nothing we need
+			if (h.typeflag != '0' && h.typeflag != '\0' && h.typeflag != '7')
+			{
+				if (!Skip(in, PaddedSize(size)))
+					break;
+				continue;
+			}
+
+			std::filesystem::create_directories(dst.parent_path(), ec);
+			bool executable = (ReadOctal(h.mode, sizeof(h.mode)) & 0111) != 0;
+			fileCount++;
+			byteCount += size;
+
+			if (size <= c_DirectWriteSize)
+			{
+				File f{ dst, std::vector<char>(size), executable };
+				if (!ReadExact(in, f.data.data(), size) || !Skip(in, PaddedSize(size) - size))
+					break;
+
+				uint64_t current = buffered.load();
+				while (current > c_MaxBufferedBytes)
+				{
+					buffered.wait(current);
+					current = buffered.load();
+				}
+
+				buffered += size;
+				files.Push(std::move(f));
+				continue;
+			}
+
+			std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+			uint64_t remaining = size;
+			while (remaining > 0)
+			{
+				size_t n = (size_t)std::min<uint64_t>(remaining, buffer.size());
+				if (!ReadExact(in, buffer.data(), n))
+					break;
+
+				out.write(buffer.data(), n);
+				remaining -= n;
+			}
+
+			if (remaining > 0 || !out.good() || !Skip(in, PaddedSize(size) - size))
+			{
+				HE_ERROR("Package : unable to write {}", dst.string());
+				break;
+			}
+
+			out.close();
+			if (executable)
+				setExecutable(dst);
+		}
+
+		files.Close();
+		writers.clear();
+
+		return ok && !writeFailed;
+	}
+}
+
+export namespace Package {
+
+	// Streams outputDir as a deterministic tar into `zstd -T0` (all cores), or into a plain .tar when zstd is
+	// not installed. Entries live under `rootName/` in the archive. archiveBasePath gets the extension appended.
+	Summary CreateArchive(const std::filesystem::path& outputDir, const std::filesystem::path& archiveBasePath, const std::string& rootName)
+	{
+		HE_PROFILE_FUNCTION();
+
+		return WriteTar(archiveBasePath, [&](Writer& out, uint32_t& fileCount) {
+			for (const auto& e : ListEntries(outputDir, rootName))
+			{
+				if (!WriteEntry(out, e))
+				{
+					HE_ERROR("Package : unable to add {}", e.path.string());
+					return false;
+				}
+
+				if (!e.directory)
+					fileCount++;
+			}
+
+			return true;
+		});
+	}
+
+	// Repacks a zip as <archiveBasePath>.tar.zst with the same layout, entries sorted by name.
+	Summary ConvertZip(const std::filesystem::path& zipPath, const std::filesystem::path& archiveBasePath)
+	{
+		HE_PROFILE_FUNCTION();
+
+		Zip::Archive zip;
+		if (!zip.Open(zipPath))
+		{
+			HE_ERROR("Package : unable to read {}", zipPath.string());
+			return {};
+		}
+
+		std::vector<const Zip::Entry*> entries;
+		for (const auto& e : zip.GetEntries())
+			entries.push_back(&e);
+		std::sort(entries.begin(), entries.end(), [](const Zip::Entry* a, const Zip::Entry* b) { return a->name < b->name; });
+
+		return WriteTar(archiveBasePath, [&](Writer& out, uint32_t& fileCount) {
+			for (const Zip::Entry* z : entries)
+			{
+				Entry e;
+				e.name = z->name;
+				while (e.name.ends_with('/'))
+					e.name.pop_back();
+				e.size = z->size;
+				e.directory = z->directory;
+				e.executable = IsExecutable(e.name);
+
+				if (e.name.empty() || !WriteEntryHeader(out, e))
+					return false;
+
+				if (e.directory)
+					continue;
+
+				bool ok = zip.Read(*z, [&out](const uint8_t* p, size_t n) { return out.Write(p, n); }) && out.Pad();
+				if (!ok)
+				{
+					HE_ERROR("Package : unable to convert {} from {}", z->name, zipPath.string());
+					return false;
+				}
+
+				fileCount++;
+			}
+
+			return true;
+		});
+	}
+
+	bool IsTarArchive(const std::filesystem::path& path)
+	{
+		auto name = path.filename().string();
+		return name.ends_with(".tar.zst") || name.ends_with(".tzst") || name.ends_with(".tar");
+	}
+
+	// Extracts a .tar, .tar.zst or seekable .tar.zst straight into outputDir. Decompression runs in a
+	// `zstd -d` process streaming into us through a pipe, nothing is staged on disk.
+	bool ExtractArchive(const std::filesystem::path& archivePath, const std::filesystem::path& outputDir)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		bool compressed = archivePath.extension() != ".tar";
+
+		if (compressed && !HasZstd())
+		{
+			HE_ERROR("Package : zstd is required to extract {}", archivePath.string());
+			return false;
+		}
+
+		std::FILE* in = compressed ? OpenPipe(std::format("zstd -d -q -c -T0 \"{}\"", archivePath.string()), false) : std::fopen(archivePath.string().c_str(), "rb");
+		if (!in)
+		{
+			HE_ERROR("Package : unable to read {}", archivePath.string());
+			return false;
+		}
+
+		uint32_t fileCount = 0;
+		uint64_t byteCount = 0;
+		bool ok = ExtractTar(in, outputDir, fileCount, byteCount);
+
+		// drain what is left so zstd exits cleanly
+		if (compressed)
+		{
+			while (Skip(in, c_BlockSize)) {}
+			ok = ClosePipe(in) == 0 && ok;
+		}
+		else
+		{
+			std::fclose(in);
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (ok)
+			HE_INFO("Package : extracted {} ({} files, {}) in {:.3f}s", archivePath.filename().string(), fileCount, Utils::FormatBytes(byteCount), seconds);
+		else
+			HE_ERROR("Package : failed to extract {}", archivePath.string());
+
+		return ok;
+	}
+}
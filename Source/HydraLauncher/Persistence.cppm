@@ -0,0 +1,119 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Persistence;
+
+import HE;
+import std;
+import Utils;
+
+export namespace Persistence {
+
+	// Write-behind file writer. Submit only swaps the newest content for a file in memory, a background thread
+	// writes it once no new content arrived for `debounce` (or `maxDelay` after the first change at most).
+	// Every write goes through Utils::WriteFileAtomic (or the write function when set) and writes are serialized,
+	// so callers never touch the disk.
+	class Writer
+	{
+	public:
+		// replaces the write of one file, it runs with writes serialized and reports its own errors
+		using WriteFunction = std::function<void(const std::filesystem::path& path, const std::string& content)>;
+
+		~Writer() { Stop(); }
+
+		// set before Start
+		void SetWriteFunction(WriteFunction fn) { writeFunction = std::move(fn); }
+
+		void Start(std::chrono::milliseconds debounce = std::chrono::milliseconds(500), std::chrono::milliseconds maxDelay = std::chrono::milliseconds(3000))
+		{
+			this->debounce = debounce;
+			this->maxDelay = maxDelay;
+			thread = std::jthread([this](std::stop_token token) { Run(token); });
+		}
+
+		// writes what is pending and joins the thread, later Submit calls are written by Flush only
+		void Stop()
+		{
+			if (thread.joinable())
+			{
+				thread.request_stop();
+				cv.notify_all();
+				thread.join();
+			}
+
+			Flush();
+		}
+
+		void Submit(const std::filesystem::path& path, std::string content)
+		{
+			{
+				std::lock_guard lock(mutex);
+				auto now = std::chrono::steady_clock::now();
+				if (pending.empty())
+					firstChange = now;
+
+				pending[path] = std::move(content);
+				lastChange = now;
+			}
+			cv.notify_all();
+		}
+
+		// writes everything pending on the calling thread
+		void Flush()
+		{
+			// taken before the swap so an older snapshot can never land after a newer one
+			std::lock_guard writeLock(writeMutex);
+
+			std::map<std::filesystem::path, std::string> files;
+			{
+				std::lock_guard lock(mutex);
+				files.swap(pending);
+			}
+
+			for (const auto& [path, content] : files)
+			{
+				if (writeFunction)
+					writeFunction(path, content);
+				else if (!Utils::WriteFileAtomic(path, content))
+					HE_ERROR("Unable to open file for writing, {}", path.string());
+			}
+		}
+
+	private:
+		void Run(std::stop_token token)
+		{
+			std::unique_lock lock(mutex);
+			while (!token.stop_requested())
+			{
+				cv.wait(lock, token, [this] { return !pending.empty(); });
+				if (token.stop_requested())
+					break;
+
+				// debounce, every Submit pushes the deadline back up to maxDelay
+				auto deadline = std::min(lastChange + debounce, firstChange + maxDelay);
+				if (std::chrono::steady_clock::now() < deadline)
+				{
+					cv.wait_until(lock, token, deadline, [] { return false; });
+					continue;
+				}
+
+				lock.unlock();
+				Flush();
+				lock.lock();
+			}
+		}
+
+		std::map<std::filesystem::path, std::string> pending;
+		std::chrono::steady_clock::time_point firstChange;
+		std::chrono::steady_clock::time_point lastChange;
+		std::chrono::milliseconds debounce;
+		std::chrono::milliseconds maxDelay;
+		WriteFunction writeFunction;
+
+		std::mutex mutex;
+		std::mutex writeMutex;
+		std::condition_variable_any cv;
+		std::jthread thread;
+	};
+}
@@ -0,0 +1,164 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Pipeline;
+
+import HE;
+import std;
+
+export namespace Pipeline {
+
+	using TaskID = uint32_t;
+
+	enum class TaskState : uint8_t
+	{
+		Pending,
+		Running,
+		Succeeded,
+		Failed,
+		Skipped // a dependency failed or was skipped
+	};
+
+	// Blocking multi-producer queue used to hand work from one stage to the next while both run.
+	template<typename T>
+	class Channel
+	{
+	public:
+		void Push(T value)
+		{
+			{
+				std::lock_guard lock(mutex);
+				queue.push_back(std::move(value));
+			}
+			cv.notify_one();
+		}
+
+		// no more values will be pushed, Pop returns false once the queue is drained
+		void Close()
+		{
+			{
+				std::lock_guard lock(mutex);
+				closed = true;
+			}
+			cv.notify_all();
+		}
+
+		bool Pop(T& out)
+		{
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [this] { return !queue.empty() || closed; });
+			if (queue.empty())
+				return false;
+
+			out = std::move(queue.front());
+			queue.pop_front();
+			return true;
+		}
+
+	private:
+		std::deque<T> queue;
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool closed = false;
+	};
+
+	// Tasks with explicit dependencies, each one starts on its own thread as soon as everything it depends on
+	// succeeded. Dependencies must be added first, which keeps the graph acyclic.
+	class Graph
+	{
+	public:
+		TaskID Add(std::string name, std::function<bool()> fn, std::initializer_list<TaskID> dependencies = {})
+		{
+			for (TaskID dep : dependencies)
+				HE_ASSERT(dep < tasks.size());
+
+			tasks.push_back({ std::move(name), std::move(fn), dependencies });
+			return (TaskID)tasks.size() - 1;
+		}
+
+		TaskState GetState(TaskID id) const { return tasks[id].state; }
+
+		// blocks until every task finished or was skipped, returns true if all of them succeeded
+		bool Run()
+		{
+			HE_PROFILE_FUNCTION();
+
+			std::vector<std::jthread> threads;
+			std::unique_lock lock(mutex);
+
+			while (true)
+			{
+				size_t running = 0;
+
+				for (auto& task : tasks)
+				{
+					if (task.state == TaskState::Running)
+						running++;
+
+					if (task.state != TaskState::Pending)
+						continue;
+
+					bool ready = true;
+					bool skip = false;
+					for (TaskID dep : task.dependencies)
+					{
+						TaskState s = tasks[dep].state;
+						skip |= s == TaskState::Failed || s == TaskState::Skipped;
+						ready &= s == TaskState::Succeeded;
+					}
+
+					if (skip)
+					{
+						task.state = TaskState::Skipped;
+						HE_WARN("Pipeline : skipped {}", task.name);
+					}
+					else if (ready)
+					{
+						task.state = TaskState::Running;
+						running++;
+						threads.emplace_back([this, &task]() { Execute(task); });
+					}
+				}
+
+				if (running == 0)
+					break;
+
+				cv.wait(lock);
+			}
+
+			lock.unlock();
+			threads.clear();
+
+			return std::all_of(tasks.begin(), tasks.end(), [](const Task& t) { return t.state == TaskState::Succeeded; });
+		}
+
+	private:
+		struct Task
+		{
+			std::string name;
+			std::function<bool()> fn;
+			std::vector<TaskID> dependencies;
+			TaskState state = TaskState::Pending;
+		};
+
+		void Execute(Task& task)
+		{
+			auto start = std::chrono::steady_clock::now();
+			bool ok = task.fn();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			HE_INFO("Pipeline : {} {} in {:.2f}s", task.name, ok ? "done" : "failed", seconds);
+
+			{
+				std::lock_guard lock(mutex);
+				task.state = ok ? TaskState::Succeeded : TaskState::Failed;
+			}
+			cv.notify_all();
+		}
+
+		std::vector<Task> tasks;
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+}
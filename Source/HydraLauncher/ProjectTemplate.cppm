@@ -0,0 +1,305 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HE_TEMPLATE_SSE2
+#endif
+
+export module ProjectTemplate;
+
+import HE;
+import std;
+import CopyEngine;
+import Staging;
+
+export namespace ProjectTemplate {
+
+	struct Token
+	{
+		std::string pattern;
+		std::string value;
+	};
+
+	// Finds the occurrences of a small set of tokens. Candidates come from comparing 16 byte blocks against the
+	// first and last byte of every pattern at once (SSE2), only those are compared in full.
+	class Matcher
+	{
+	public:
+		Matcher() = default;
+
+		explicit Matcher(std::vector<Token> tokens) : tokens(std::move(tokens))
+		{
+			std::erase_if(this->tokens, [](const Token& t) { return t.pattern.empty(); });
+			for (const auto& t : this->tokens)
+				maxLength = std::max(maxLength, t.pattern.size());
+		}
+
+		bool IsEmpty() const { return tokens.empty(); }
+
+		struct Match
+		{
+			size_t position = std::string_view::npos;
+			uint32_t token = 0;
+		};
+
+		// first match that starts in [from, limit), earlier tokens win at the same position
+		Match Find(std::string_view text, size_t from, size_t limit) const
+		{
+			limit = std::min(limit, text.size());
+
+#ifdef HE_TEMPLATE_SSE2
+			// every load stays inside text, token sets past c_MaxSimdTokens are rare and stay scalar
+			while (tokens.size() <= c_MaxSimdTokens && from + 16 + maxLength - 1 <= text.size() && from < limit)
+			{
+				const char* p = text.data() + from;
+				__m128i block = _mm_loadu_si128((const __m128i*)p);
+
+				uint32_t masks[c_MaxSimdTokens] = {};
+				uint32_t any = 0;
+				for (size_t i = 0; i < tokens.size(); i++)
+				{
+					const auto& pattern = tokens[i].pattern;
+					__m128i last = _mm_loadu_si128((const __m128i*)(p + pattern.size() - 1));
+					__m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(pattern.front())), _mm_cmpeq_epi8(last, _mm_set1_epi8(pattern.back())));
+					masks[i] = (uint32_t)_mm_movemask_epi8(eq);
+					any |= masks[i];
+				}
+
+				while (any)
+				{
+					uint32_t bit = std::countr_zero(any);
+					any &= any - 1;
+
+					size_t position = from + bit;
+					if (position >= limit)
+						return {};
+
+					for (size_t i = 0; i < tokens.size(); i++)
+					{
+						if ((masks[i] >> bit) & 1 && text.substr(position).starts_with(tokens[i].pattern))
+							return { position, (uint32_t)i };
+					}
+				}
+
+				from += 16;
+			}
+#endif
+
+			return FindScalar(text, from, limit);
+		}
+
+		// Appends text to out with every token replaced. Unless final, the last maxLength - 1 bytes may hold the
+		// start of a token, they are left for the next call. Returns how many bytes of text were consumed.
+		size_t Substitute(std::string_view text, std::string& out, bool final, uint32_t& replacements) const
+		{
+			size_t limit = final ? text.size() : (text.size() >= maxLength ? text.size() - maxLength + 1 : 0);
+
+			size_t position = 0;
+			while (true)
+			{
+				Match m = Find(text, position, limit);
+				if (m.position == std::string_view::npos)
+					break;
+
+				out.append(text.substr(position, m.position - position));
+				out.append(tokens[m.token].value);
+				position = m.position + tokens[m.token].pattern.size();
+				replacements++;
+			}
+
+			size_t end = std::max(position, limit);
+			out.append(text.substr(position, end - position));
+			return end;
+		}
+
+	private:
+		static constexpr size_t c_MaxSimdTokens = 8;
+
+		Match FindScalar(std::string_view text, size_t from, size_t limit) const
+		{
+			for (size_t position = from; position < limit; position++)
+			{
+				for (size_t i = 0; i < tokens.size(); i++)
+				{
+					if (text[position] == tokens[i].pattern.front() && text.substr(position).starts_with(tokens[i].pattern))
+						return { position, (uint32_t)i };
+				}
+			}
+
+			return {};
+		}
+
+		std::vector<Token> tokens;
+		size_t maxLength = 1;
+	};
+
+	struct Options
+	{
+		std::filesystem::path templateDir;
+		std::filesystem::path outputDir;
+
+		std::vector<std::string> exclude;                                 // '/' separated paths relative to templateDir, files or whole directories
+		std::vector<Token> renames;                                       // '/' separated relative path to its new one, a directory moves what is below it
+		std::vector<Token> tokens;                                        // substituted in every text file
+		std::unordered_map<std::string, std::vector<Token>> fileTokens;   // replaces tokens for one relative path
+		std::vector<std::string> textExtensions = { ".lua", ".c", ".cpp", ".cppm", ".h", ".hpp", ".inl", ".hlsl", ".slang", ".glsl", ".json", ".ini", ".txt", ".md" };
+
+		// How files without substitutions are placed. Reflink clones share blocks with the template until either
+		// side writes, HardLink shares the file itself, so editing an asset in place also edits the template.
+		// Both fall back to a copy where the filesystem can't. Auto and Symlink are placed as Reflink, they would
+		// hard link on Windows.
+		Staging::Strategy strategy = Staging::Strategy::Copy;
+	};
+
+	// the strategies offered for template assets
+	constexpr Staging::Strategy c_AssetStrategies[] = { Staging::Strategy::Copy, Staging::Strategy::Reflink, Staging::Strategy::HardLink };
+
+	Staging::Strategy ResolveAssetStrategy(Staging::Strategy strategy)
+	{
+		if (std::ranges::find(c_AssetStrategies, strategy) != std::end(c_AssetStrategies))
+			return strategy;
+
+		return Staging::Strategy::Reflink;
+	}
+
+	struct Summary
+	{
+		std::atomic<uint32_t> files = 0;
+		std::atomic<uint32_t> linkedFiles = 0; // reflinked or hard linked instead of copied
+		std::atomic<uint32_t> substitutedFiles = 0;
+		std::atomic<uint32_t> replacements = 0;
+	};
+}
+
+// Internal
+namespace ProjectTemplate {
+
+	constexpr size_t c_ChunkSize = 256 * 1024;
+
+	// the longest rename that is the path itself or one of its parent directories applies
+	std::filesystem::path Rename(const std::string& relative, const std::vector<Token>& renames)
+	{
+		const Token* best = nullptr;
+		for (const auto& r : renames)
+		{
+			bool matches = relative == r.pattern || (relative.starts_with(r.pattern) && relative.size() > r.pattern.size() && relative[r.pattern.size()] == '/');
+			if (matches && (!best || r.pattern.size() > best->pattern.size()))
+				best = &r;
+		}
+
+		if (!best)
+			return relative;
+
+		return best->value + relative.substr(best->pattern.size());
+	}
+
+	// one read and one write, tokens are replaced chunk by chunk on the way
+	bool Substitute(const std::filesystem::path& src, const std::filesystem::path& dst, const Matcher& matcher, Summary& summary)
+	{
+		std::ifstream in(src, std::ios::binary);
+		std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+		if (!in.is_open() || !out.is_open())
+		{
+			HE_ERROR("ProjectTemplate : unable to instantiate {}", dst.string());
+			return false;
+		}
+
+		std::string buffer;
+		std::string output;
+		uint32_t replacements = 0;
+
+		while (true)
+		{
+			size_t carried = buffer.size();
+			buffer.resize(carried + c_ChunkSize);
+			in.read(buffer.data() + carried, c_ChunkSize);
+			buffer.resize(carried + (size_t)in.gcount());
+			bool final = !in;
+
+			size_t consumed = matcher.Substitute(buffer, output, final, replacements);
+			out.write(output.data(), output.size());
+			output.clear();
+			buffer.erase(0, consumed);
+
+			if (final)
+				break;
+		}
+
+		summary.replacements += replacements;
+		summary.substitutedFiles += replacements > 0;
+		return out.good() && in.eof();
+	}
+}
+
+export namespace ProjectTemplate {
+
+	// Queues the instantiation of a template in a single walk: excluded paths are never read, renames are
+	// applied to the destination up front, text files are streamed through the token matcher and everything
+	// else is placed with options.strategy. Shares the queue so the caller can run it together with other copies. summary
+	// must outlive queue.Run.
+	void Plan(const Options& options, CopyEngine::Queue& queue, Summary& summary)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto defaultMatcher = std::make_shared<Matcher>(options.tokens);
+		std::set<std::string, std::less<>> exclude(options.exclude.begin(), options.exclude.end());
+		std::set<std::string, std::less<>> textExtensions(options.textExtensions.begin(), options.textExtensions.end());
+
+		queue.directories.push_back(options.outputDir);
+
+		std::error_code ec;
+		for (auto it = std::filesystem::recursive_directory_iterator(options.templateDir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			auto relative = it->path().lexically_relative(options.templateDir);
+			auto key = relative.generic_string();
+
+			if (exclude.contains(key))
+			{
+				if (it->is_directory(ec))
+					it.disable_recursion_pending();
+				continue;
+			}
+
+			auto dst = options.outputDir / Rename(key, options.renames);
+			if (it->is_directory(ec))
+			{
+				queue.directories.push_back(dst);
+				continue;
+			}
+
+			if (!it->is_regular_file(ec))
+				continue;
+
+			summary.files++;
+			uint64_t size = it->file_size(ec);
+
+			std::shared_ptr<Matcher> matcher = defaultMatcher;
+			if (auto fileTokens = options.fileTokens.find(key); fileTokens != options.fileTokens.end())
+				matcher = std::make_shared<Matcher>(fileTokens->second);
+
+			if (matcher->IsEmpty() || !textExtensions.contains(relative.extension().string()))
+			{
+				auto strategy = ResolveAssetStrategy(options.strategy);
+				if (strategy == Staging::Strategy::Copy)
+				{
+					queue.Add(it->path(), dst, ec ? 0 : size);
+					continue;
+				}
+
+				queue.Add(it->path(), dst, ec ? 0 : size, [strategy, &summary](const CopyEngine::Job& job) {
+					std::error_code ec;
+					auto used = Staging::Materialize(job.src, job.dst, strategy, ec);
+					summary.linkedFiles += used != Staging::Strategy::Copy;
+					return !ec;
+				});
+				continue;
+			}
+
+			queue.Add(it->path(), dst, ec ? 0 : size, [matcher, &summary](const CopyEngine::Job& job) {
+				return Substitute(job.src, job.dst, *matcher, summary);
+			});
+		}
+	}
+}
@@ -0,0 +1,204 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Registry;
+
+import HE;
+import std;
+
+export namespace Registry {
+
+	// Entries in insertion order with a hash index on a string key, KeyOf(const T&) -> std::string_view.
+	//
+	// Every entry lives in its own allocation, so a reference to one (the handle tasks and the UI hold) stays
+	// valid until that entry is removed, whatever is added meanwhile. Find returns the first entry added with a
+	// key. The index is guarded, Find and Reindex may be called from any thread. The entries are not : adding,
+	// removing and iterating stay on the owning thread, like a std::vector.
+	template<typename T, auto KeyOf>
+	class Table
+	{
+	public:
+		template<typename E, typename It>
+		struct Iterator
+		{
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = std::remove_const_t<E>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = E*;
+			using reference = E&;
+
+			It it;
+
+			E& operator*() const { return **it; }
+			E* operator->() const { return it->get(); }
+			E& operator[](difference_type n) const { return *it[n]; }
+			Iterator& operator++() { ++it; return *this; }
+			Iterator operator++(int) { return { it++ }; }
+			Iterator& operator--() { --it; return *this; }
+			Iterator operator--(int) { return { it-- }; }
+			Iterator& operator+=(difference_type n) { it += n; return *this; }
+			Iterator& operator-=(difference_type n) { it -= n; return *this; }
+			Iterator operator+(difference_type n) const { return { it + n }; }
+			Iterator operator-(difference_type n) const { return { it - n }; }
+			difference_type operator-(const Iterator& other) const { return it - other.it; }
+			auto operator<=>(const Iterator& other) const = default;
+		};
+
+		using iterator = Iterator<T, typename std::vector<std::unique_ptr<T>>::iterator>;
+		using const_iterator = Iterator<const T, typename std::vector<std::unique_ptr<T>>::const_iterator>;
+
+		iterator begin() { return { entries.begin() }; }
+		iterator end() { return { entries.end() }; }
+		const_iterator begin() const { return { entries.begin() }; }
+		const_iterator end() const { return { entries.end() }; }
+
+		size_t size() const { return entries.size(); }
+		bool empty() const { return entries.empty(); }
+
+		T& operator[](size_t index) { return *entries[index]; }
+		const T& operator[](size_t index) const { return *entries[index]; }
+
+		void reserve(size_t count)
+		{
+			std::unique_lock lock(indexMutex);
+			entries.reserve(count);
+			index.reserve(count);
+		}
+
+		void clear()
+		{
+			std::unique_lock lock(indexMutex);
+			entries.clear();
+			index.clear();
+			dirty = false;
+		}
+
+		T& Add(T&& value)
+		{
+			std::unique_lock lock(indexMutex);
+			return Append(std::move(value));
+		}
+
+		T& Add() { return Add(T{}); }
+
+		void Remove(size_t i)
+		{
+			std::unique_lock lock(indexMutex);
+			HE_VERIFY(i < entries.size());
+
+			auto it = index.find(KeyOf(*entries[i]));
+			bool indexed = it != index.end() && it->second == entries[i].get();
+
+			std::unique_ptr<T> removed = std::move(entries[i]);
+			entries.erase(entries.begin() + i);
+
+			// another entry may share the key
+			if (indexed && !dirty)
+			{
+				index.erase(it);
+				auto next = std::find_if(entries.begin(), entries.end(), [&](const std::unique_ptr<T>& e) { return KeyOf(*e) == KeyOf(*removed); });
+				if (next != entries.end())
+					index.emplace(std::string(KeyOf(**next)), next->get());
+			}
+		}
+
+		void Remove(const T* entry)
+		{
+			auto it = std::find_if(entries.begin(), entries.end(), [entry](const std::unique_ptr<T>& e) { return e.get() == entry; });
+			if (it != entries.end())
+				Remove(it - entries.begin());
+		}
+
+		// removes every entry pred(entry) returns true for in one pass, returns the number removed
+		template<typename Fn>
+		size_t RemoveIf(Fn&& pred)
+		{
+			std::unique_lock lock(indexMutex);
+			size_t removed = std::erase_if(entries, [&](const std::unique_ptr<T>& e) { return pred(std::as_const(*e)); });
+			if (removed)
+				Rebuild();
+
+			return removed;
+		}
+
+		// Call after changing the key of an entry in place. The index is rebuilt by the next lookup.
+		void Reindex() { dirty = true; }
+
+		T* Find(std::string_view key)
+		{
+			if (dirty)
+			{
+				std::unique_lock lock(indexMutex);
+				if (dirty.exchange(false))
+					Rebuild();
+			}
+
+			std::shared_lock lock(indexMutex);
+			auto it = index.find(key);
+			return it != index.end() ? it->second : nullptr;
+		}
+
+		bool Contains(std::string_view key) { return Find(key) != nullptr; }
+
+		// Batch merge, one lookup per incoming entry. Entries with a new key are appended in order,
+		// merge(existing, incoming) is called for the others. Returns the number of added entries.
+		template<typename Fn>
+		size_t Merge(std::vector<T>&& incoming, Fn&& merge)
+		{
+			HE_PROFILE_FUNCTION();
+
+			std::unique_lock lock(indexMutex);
+			if (dirty.exchange(false))
+				Rebuild();
+
+			entries.reserve(entries.size() + incoming.size());
+			index.reserve(entries.size() + incoming.size());
+
+			size_t added = 0;
+			for (auto& value : incoming)
+			{
+				auto it = index.find(KeyOf(value));
+				if (it != index.end())
+				{
+					merge(*it->second, value);
+					continue;
+				}
+
+				Append(std::move(value));
+				added++;
+			}
+
+			return added;
+		}
+
+	private:
+		// callers hold indexMutex exclusively
+		T& Append(T&& value)
+		{
+			auto& entry = entries.emplace_back(std::make_unique<T>(std::move(value)));
+			if (!dirty)
+				index.try_emplace(std::string(KeyOf(*entry)), entry.get());
+
+			return *entry;
+		}
+
+		void Rebuild()
+		{
+			index.clear();
+			for (const auto& e : entries)
+				index.try_emplace(std::string(KeyOf(*e)), e.get());
+		}
+
+		struct StringHash
+		{
+			using is_transparent = void;
+			size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+		};
+
+		std::vector<std::unique_ptr<T>> entries;
+		std::unordered_map<std::string, T*, StringHash, std::equal_to<>> index;
+		std::atomic<bool> dirty = false;
+		std::shared_mutex indexMutex;
+	};
+}
@@ -0,0 +1,655 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module ResourcePack;
+
+import HE;
+import std;
+import Hash;
+import Utils;
+import CopyEngine;
+
+// Layout of a .hpak file, little endian :
+//
+//   Header
+//   entry data, each entry starts on a c_Alignment boundary
+//   IndexEntry[entryCount] sorted by (pathHash, name)
+//   names, '/' separated paths relative to the packed directory
+//
+// The header is written last, so an interrupted incremental update leaves the previous index valid.
+
+export namespace ResourcePack {
+
+	constexpr uint32_t c_Magic = 0x4B415048; // "HPAK"
+	constexpr uint32_t c_Version = 1;
+	constexpr uint64_t c_Alignment = 16;
+
+	enum class Compression : uint32_t
+	{
+		None,
+		LZ4, // LZ4 block format
+	};
+
+	struct Header
+	{
+		uint32_t magic = c_Magic;
+		uint32_t version = c_Version;
+		uint64_t indexOffset = 0;
+		uint64_t indexSize = 0;
+		uint32_t entryCount = 0;
+		uint32_t flags = 0;
+		uint64_t liveBytes = 0; // bytes referenced by the index, the rest of the data region is dead space
+		uint64_t reserved = 0;
+	};
+	static_assert(sizeof(Header) == 48);
+
+	struct IndexEntry
+	{
+		uint64_t pathHash = 0;
+		uint64_t contentHash = 0; // of the uncompressed content
+		uint64_t offset = 0;
+		uint64_t storedSize = 0;
+		uint64_t size = 0;
+		uint32_t nameOffset = 0; // into the names block
+		uint32_t nameSize = 0;
+		Compression compression = Compression::None;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(IndexEntry) == 56);
+
+	uint64_t HashPath(std::string_view path) { return Hash::Compute(path); }
+
+	struct Summary
+	{
+		uint32_t writtenEntries = 0;
+		uint32_t reusedEntries = 0;
+		uint32_t removedEntries = 0;
+		uint32_t failedEntries = 0;
+		uint64_t writtenBytes = 0;
+		uint64_t totalBytes = 0;  // uncompressed size of all entries
+		uint64_t storedBytes = 0; // size of all entries in the pack
+		bool compacted = false;
+		double seconds = 0.0;
+	};
+}
+
+// Internal
+namespace ResourcePack::LZ4 {
+
+	constexpr size_t c_MinMatch = 4;
+	constexpr size_t c_LastLiterals = 5;
+	constexpr size_t c_MatchFindLimit = 12;
+	constexpr uint32_t c_HashLog = 16;
+
+	inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+	size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+	uint8_t* WriteLength(uint8_t* op, size_t length)
+	{
+		while (length >= 255)
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = (uint8_t)length;
+		return op;
+	}
+
+	// greedy single-probe compressor, returns 0 if the output doesn't fit in dstCapacity
+	size_t Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+	{
+		static thread_local std::vector<uint32_t> table;
+		table.assign(size_t(1) << c_HashLog, 0);
+
+		const uint8_t* ip = src;
+		const uint8_t* anchor = src;
+		const uint8_t* end = src + srcSize;
+		uint8_t* op = dst;
+		uint8_t* oend = dst + dstCapacity;
+
+		if (srcSize > c_MatchFindLimit)
+		{
+			const uint8_t* mflimit = end - c_MatchFindLimit;
+			const uint8_t* matchlimit = end - c_LastLiterals;
+
+			while (ip < mflimit)
+			{
+				uint32_t seq = Read32(ip);
+				uint32_t h = (seq * 2654435761u) >> (32 - c_HashLog);
+				const uint8_t* ref = src + table[h];
+				table[h] = (uint32_t)(ip - src);
+
+				if (ref >= ip || ip - ref > 0xFFFF || Read32(ref) != seq)
+				{
+					ip++;
+					continue;
+				}
+
+				while (ip > anchor && ref > src && ip[-1] == ref[-1])
+				{
+					ip--;
+					ref--;
+				}
+
+				const uint8_t* mp = ip + c_MinMatch;
+				const uint8_t* rp = ref + c_MinMatch;
+				while (mp < matchlimit && *mp == *rp)
+				{
+					mp++;
+					rp++;
+				}
+
+				size_t literals = ip - anchor;
+				size_t matchLength = (mp - ip) - c_MinMatch;
+				if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1)
+					return 0;
+
+				uint8_t* token = op++;
+				*token = (uint8_t)(std::min<size_t>(literals, 15) << 4);
+				if (literals >= 15)
+					op = WriteLength(op, literals - 15);
+
+				std::memcpy(op, anchor, literals);
+				op += literals;
+
+				uint16_t offset = (uint16_t)(ip - ref);
+				*op++ = (uint8_t)(offset & 0xFF);
+				*op++ = (uint8_t)(offset >> 8);
+
+				*token |= (uint8_t)std::min<size_t>(matchLength, 15);
+				if (matchLength >= 15)
+					op = WriteLength(op, matchLength - 15);
+
+				ip = mp;
+				anchor = ip;
+			}
+		}
+
+		size_t literals = end - anchor;
+		if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals)
+			return 0;
+
+		uint8_t* token = op++;
+		*token = (uint8_t)(std::min<size_t>(literals, 15) << 4);
+		if (literals >= 15)
+			op = WriteLength(op, literals - 15);
+
+		std::memcpy(op, anchor, literals);
+		op += literals;
+
+		return op - dst;
+	}
+
+	// bounds checked, fails on malformed input or if the output isn't exactly dstSize bytes
+	bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* iend = src + srcSize;
+		uint8_t* op = dst;
+		uint8_t* oend = dst + dstSize;
+
+		auto readLength = [&](size_t& length) {
+			uint8_t b;
+			do
+			{
+				if (ip >= iend)
+					return false;
+				b = *ip++;
+				length += b;
+			} while (b == 255);
+			return true;
+		};
+
+		while (ip < iend)
+		{
+			uint8_t token = *ip++;
+
+			size_t literals = token >> 4;
+			if (literals == 15 && !readLength(literals))
+				return false;
+
+			if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+				return false;
+
+			std::memcpy(op, ip, literals);
+			ip += literals;
+			op += literals;
+
+			if (ip >= iend)
+				break;
+
+			if (iend - ip < 2)
+				return false;
+
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - dst))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(matchLength))
+				return false;
+
+			matchLength += c_MinMatch;
+			if (matchLength > (size_t)(oend - op))
+				return false;
+
+			// may overlap, copy forward byte by byte
+			const uint8_t* match = op - offset;
+			for (size_t i = 0; i < matchLength; i++)
+				op[i] = match[i];
+			op += matchLength;
+		}
+
+		return op == oend;
+	}
+}
+
+export namespace ResourcePack {
+
+	// Maps a pack and looks entries up by path without reading the data region.
+	class Reader
+	{
+	public:
+		bool Open(const std::filesystem::path& path)
+		{
+			Close();
+
+			if (!file.Open(path) || file.Size() < sizeof(Header))
+			{
+				Close();
+				return false;
+			}
+
+			std::memcpy(&header, file.Data(), sizeof(Header));
+			if (header.magic != c_Magic || header.version != c_Version ||
+				header.indexOffset < sizeof(Header) || header.indexOffset > file.Size() ||
+				header.indexSize > file.Size() - header.indexOffset ||
+				(uint64_t)header.entryCount * sizeof(IndexEntry) > header.indexSize ||
+				header.indexOffset % alignof(IndexEntry) != 0)
+			{
+				Close();
+				return false;
+			}
+
+			entries = { (const IndexEntry*)(file.Data() + header.indexOffset), header.entryCount };
+			names = { (const char*)(file.Data() + header.indexOffset + header.entryCount * sizeof(IndexEntry)), header.indexSize - header.entryCount * sizeof(IndexEntry) };
+
+			for (const auto& e : entries)
+			{
+				if ((uint64_t)e.nameOffset + e.nameSize > names.size() || e.offset > header.indexOffset || e.storedSize > header.indexOffset - e.offset)
+				{
+					Close();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void Close()
+		{
+			file.Close();
+			header = {};
+			entries = {};
+			names = {};
+		}
+
+		bool IsOpen() const { return file.Data() != nullptr; }
+		const Header& GetHeader() const { return header; }
+		uint64_t GetFileSize() const { return file.Size(); }
+		std::span<const IndexEntry> GetEntries() const { return entries; }
+
+		std::string_view GetName(const IndexEntry& e) const { return names.substr(e.nameOffset, e.nameSize); }
+
+		const IndexEntry* Find(std::string_view path) const
+		{
+			uint64_t hash = HashPath(path);
+			auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const IndexEntry& e, uint64_t h) { return e.pathHash < h; });
+			for (; it != entries.end() && it->pathHash == hash; it++)
+			{
+				if (GetName(*it) == path)
+					return &*it;
+			}
+
+			return nullptr;
+		}
+
+		// the bytes as stored, still compressed if the entry is
+		std::span<const uint8_t> GetStoredData(const IndexEntry& e) const { return { file.Data() + e.offset, (size_t)e.storedSize }; }
+
+		bool Read(const IndexEntry& e, std::vector<uint8_t>& out) const
+		{
+			auto stored = GetStoredData(e);
+			out.resize(e.size);
+
+			switch (e.compression)
+			{
+			case Compression::None:
+				if (e.storedSize != e.size)
+					return false;
+				std::memcpy(out.data(), stored.data(), stored.size());
+				return true;
+			case Compression::LZ4:
+				return LZ4::Decompress(stored.data(), stored.size(), out.data(), out.size());
+			}
+
+			return false;
+		}
+
+	private:
+		Utils::MappedFile file;
+		Header header;
+		std::span<const IndexEntry> entries;
+		std::string_view names;
+	};
+}
+
+// Internal
+namespace ResourcePack {
+
+	struct Source
+	{
+		std::string name;
+		std::filesystem::path path;
+		uint64_t size = 0;
+		uint64_t hash = 0;
+		bool hashed = false;
+		std::optional<IndexEntry> previous; // unchanged entry of the existing pack
+	};
+
+	uint64_t AlignUp(uint64_t v) { return (v + c_Alignment - 1) & ~(c_Alignment - 1); }
+
+	// Writes entry data at the stream position, padding it to the alignment first. Returns false on I/O error.
+	bool WriteAligned(std::ostream& out, uint64_t& pos, const void* data, size_t size, uint64_t& outOffset)
+	{
+		static const char zeros[c_Alignment] = {};
+		uint64_t aligned = AlignUp(pos);
+		out.write(zeros, aligned - pos);
+		out.write((const char*)data, size);
+
+		outOffset = aligned;
+		pos = aligned + size;
+		return out.good();
+	}
+
+	// Reads, compresses and writes one changed entry.
+	bool WriteSource(std::ostream& out, uint64_t& pos, const Source& source, bool compress, IndexEntry& e)
+	{
+		static thread_local std::vector<uint8_t> content;
+		static thread_local std::vector<uint8_t> compressed;
+
+		std::ifstream file(source.path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		content.resize(source.size);
+		file.read((char*)content.data(), content.size());
+		if ((uint64_t)file.gcount() != source.size)
+			return false;
+
+		e.size = source.size;
+		e.compression = Compression::None;
+		const uint8_t* data = content.data();
+		size_t size = content.size();
+
+		if (compress && size > 64)
+		{
+			// only keep the compressed form if it saves at least 1/8
+			compressed.resize(LZ4::CompressBound(size));
+			size_t compressedSize = LZ4::Compress(content.data(), size, compressed.data(), size - size / 8);
+			if (compressedSize > 0)
+			{
+				e.compression = Compression::LZ4;
+				data = compressed.data();
+				size = compressedSize;
+			}
+		}
+
+		e.storedSize = size;
+		return WriteAligned(out, pos, data, size, e.offset);
+	}
+
+	bool WriteIndex(std::ostream& out, uint64_t& pos, std::vector<IndexEntry>& entries, const std::vector<std::string_view>& entryNames, Header& header)
+	{
+		std::vector<size_t> order(entries.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return entries[a].pathHash != entries[b].pathHash ? entries[a].pathHash < entries[b].pathHash : entryNames[a] < entryNames[b];
+		});
+
+		std::vector<IndexEntry> sorted;
+		sorted.reserve(entries.size());
+		std::string names;
+		for (size_t i : order)
+		{
+			IndexEntry e = entries[i];
+			e.nameOffset = (uint32_t)names.size();
+			e.nameSize = (uint32_t)entryNames[i].size();
+			names += entryNames[i];
+			header.liveBytes += e.storedSize;
+			sorted.push_back(e);
+		}
+
+		uint64_t offset;
+		if (!WriteAligned(out, pos, sorted.data(), sorted.size() * sizeof(IndexEntry), offset))
+			return false;
+
+		out.write(names.data(), names.size());
+		pos += names.size();
+
+		header.indexOffset = offset;
+		header.indexSize = sorted.size() * sizeof(IndexEntry) + names.size();
+		header.entryCount = (uint32_t)sorted.size();
+
+		return out.good();
+	}
+}
+
+export namespace ResourcePack {
+
+	// Packs every file under sourceDir into packPath. An existing pack is updated in place : unchanged entries
+	// are kept, changed ones are appended, and the file is rewritten once dead space outweighs live data.
+	Summary Write(const std::filesystem::path& packPath, const std::filesystem::path& sourceDir, bool compress = true)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		Summary summary;
+
+		std::vector<Source> sources;
+		{
+			std::error_code ec;
+			for (auto it = std::filesystem::recursive_directory_iterator(sourceDir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+			{
+				if (!it->is_regular_file(ec))
+					continue;
+
+				Source& s = sources.emplace_back();
+				s.name = it->path().lexically_relative(sourceDir).generic_string();
+				s.path = it->path();
+				s.size = it->file_size(ec);
+			}
+		}
+
+		// content hashes decide what gets rewritten
+		{
+			CopyEngine::Queue queue;
+			for (size_t i = 0; i < sources.size(); i++)
+				queue.Add(sources[i].path, {}, sources[i].size, [&sources, i](const CopyEngine::Job&) { return sources[i].hashed = Hash::ComputeFile(sources[i].path, sources[i].hash); });
+			queue.Run();
+		}
+
+		std::erase_if(sources, [&](const Source& s) {
+			if (!s.hashed)
+			{
+				HE_ERROR("ResourcePack : unable to read {}", s.path.string());
+				summary.failedEntries++;
+			}
+			return !s.hashed;
+		});
+
+		Reader previous;
+		bool hasPrevious = previous.Open(packPath);
+
+		uint64_t reusedBytes = 0;
+		if (hasPrevious)
+		{
+			for (auto& s : sources)
+			{
+				const IndexEntry* e = previous.Find(s.name);
+				if (e && e->contentHash == s.hash && e->size == s.size)
+				{
+					s.previous = *e;
+					reusedBytes += e->storedSize;
+				}
+			}
+
+			std::unordered_set<std::string_view> names;
+			for (const auto& s : sources)
+				names.insert(s.name);
+
+			for (const auto& e : previous.GetEntries())
+				summary.removedEntries += names.contains(previous.GetName(e)) ? 0 : 1;
+		}
+
+		if (hasPrevious && summary.failedEntries == 0 && summary.removedEntries == 0 && previous.GetEntries().size() == sources.size() &&
+			std::all_of(sources.begin(), sources.end(), [](const Source& s) { return s.previous.has_value(); }))
+		{
+			summary.reusedEntries = (uint32_t)sources.size();
+			for (const auto& e : previous.GetEntries())
+			{
+				summary.totalBytes += e.size;
+				summary.storedBytes += e.storedSize;
+			}
+
+			HE_INFO("ResourcePack {} : up to date", packPath.string());
+			return summary;
+		}
+
+		// everything past the reused entries would be dead after an append
+		bool compact = !hasPrevious || previous.GetFileSize() - sizeof(Header) - reusedBytes > reusedBytes;
+		summary.compacted = compact;
+
+		std::vector<IndexEntry> entries(sources.size());
+		std::vector<std::string_view> entryNames(sources.size());
+		Header header;
+		bool ok = true;
+
+		auto writeEntries = [&](std::ostream& out, uint64_t& pos, bool copyReused) {
+			for (size_t i = 0; i < sources.size() && ok; i++)
+			{
+				const Source& s = sources[i];
+				IndexEntry& e = entries[i];
+				entryNames[i] = s.name;
+
+				if (s.previous)
+				{
+					e = *s.previous;
+					if (copyReused)
+					{
+						auto stored = previous.GetStoredData(e);
+						ok = WriteAligned(out, pos, stored.data(), stored.size(), e.offset);
+					}
+					summary.reusedEntries++;
+				}
+				else
+				{
+					e.pathHash = HashPath(s.name);
+					e.contentHash = s.hash;
+					if (!WriteSource(out, pos, s, compress, e))
+					{
+						HE_ERROR("ResourcePack : unable to pack {}", s.path.string());
+						ok = false;
+						break;
+					}
+					summary.writtenEntries++;
+					summary.writtenBytes += e.storedSize;
+				}
+
+				summary.totalBytes += e.size;
+				summary.storedBytes += e.storedSize;
+			}
+
+			ok = ok && WriteIndex(out, pos, entries, entryNames, header);
+		};
+
+		if (compact)
+		{
+			auto tmpPath = packPath;
+			tmpPath += ".tmp";
+
+			{
+				std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+				ok = out.is_open();
+
+				uint64_t pos = sizeof(Header);
+				out.write((const char*)&header, sizeof(Header));
+				if (ok)
+					writeEntries(out, pos, true);
+
+				out.seekp(0);
+				out.write((const char*)&header, sizeof(Header));
+				ok = ok && out.good();
+			}
+
+			previous.Close();
+
+			std::error_code ec;
+			if (ok)
+				std::filesystem::rename(tmpPath, packPath, ec);
+
+			if (!ok || ec)
+			{
+				HE_ERROR("ResourcePack : unable to write {}", packPath.string());
+				std::filesystem::remove(tmpPath, ec);
+				ok = false;
+			}
+		}
+		else
+		{
+			// reused entries keep their offsets, the file must not stay mapped while it is written
+			uint64_t pos = previous.GetFileSize();
+			previous.Close();
+
+			{
+				std::fstream out(packPath, std::ios::binary | std::ios::in | std::ios::out);
+				ok = out.is_open();
+				out.seekp(pos);
+
+				if (ok)
+					writeEntries(out, pos, false);
+
+				// the new index is complete on disk before the header points at it
+				out.flush();
+				out.seekp(0);
+				out.write((const char*)&header, sizeof(Header));
+				ok = ok && out.good();
+			}
+
+			if (!ok)
+				HE_ERROR("ResourcePack : unable to update {}", packPath.string());
+		}
+
+		if (!ok)
+			summary.failedEntries++;
+
+		summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		HE_INFO(
+			"ResourcePack {} : {} entries, {} written ({}), {} reused, {} removed, {} -> {}{} in {:.3f}s",
+			packPath.string(),
+			sources.size(),
+			summary.writtenEntries, Utils::FormatBytes(summary.writtenBytes),
+			summary.reusedEntries,
+			summary.removedEntries,
+			Utils::FormatBytes(summary.totalBytes), Utils::FormatBytes(summary.storedBytes),
+			summary.compacted ? ", compacted" : "",
+			summary.seconds
+		);
+
+		return summary;
+	}
+}
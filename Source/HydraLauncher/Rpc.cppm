@@ -0,0 +1,192 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Rpc;
+
+import HE;
+import std;
+import simdjson;
+import Json;
+
+// JSON-RPC 2.0 framing for line based transports: a line holds one request or a batch (array) of them, the
+// answer is one line with the response or the array of responses. Notifications (no id) get no response.
+//
+//   {"jsonrpc" : "2.0", "id" : 1, "method" : "BuildProject", "params" : {"project" : "Game"}}
+
+// Internal
+namespace Rpc {
+
+	std::string_view TrimToken(std::string_view token)
+	{
+		while (!token.empty() && std::isspace((unsigned char)token.back()))
+			token.remove_suffix(1);
+
+		return token;
+	}
+}
+
+export namespace Rpc {
+
+	struct ErrorCode
+	{
+		enum : int
+		{
+			None = 0,
+			ParseError = -32700,
+			InvalidRequest = -32600,
+			MethodNotFound = -32601,
+			InvalidParams = -32602,
+			InternalError = -32603
+		};
+	};
+
+	// Params is read through its Json::Schema, missing members keep their defaults
+	template<typename Params>
+	struct Request
+	{
+		std::string id; // raw JSON token, empty for a notification
+		std::string method;
+		Params params;
+		int error = ErrorCode::None; // malformed request, answered without calling the method
+
+		bool IsNotification() const { return id.empty(); }
+	};
+
+	template<typename Params>
+	struct Message
+	{
+		std::vector<Request<Params>> requests;
+		bool batch = false;
+	};
+
+	struct Result
+	{
+		int error = ErrorCode::None; // an ErrorCode or an application code
+		std::string message;
+		Json::Writer value{ true }; // the result, written by the method when it succeeds
+
+		void Fail(int code, std::string_view text)
+		{
+			error = code;
+			message = text;
+		}
+	};
+
+	template<typename Params>
+	void ReadRequest(Json::Value value, Request<Params>& request)
+	{
+		bool version = false;
+		bool method = false;
+		bool object = Json::ForEachField(value, [&](std::string_view key, Json::Value field) {
+			if (key == "jsonrpc")
+			{
+				std::string_view str;
+				version = field.get_string().get(str) == simdjson::SUCCESS && str == "2.0";
+			}
+			else if (key == "method")
+			{
+				method = Json::Read(field, request.method);
+			}
+			else if (key == "id")
+			{
+				simdjson::ondemand::json_type type;
+				if (field.type().get(type) != simdjson::SUCCESS || type == simdjson::ondemand::json_type::object || type == simdjson::ondemand::json_type::array)
+					return false;
+
+				request.id = TrimToken(field.raw_json_token());
+			}
+			else if (key == "params")
+			{
+				if (!Json::Read(field, request.params))
+					request.error = ErrorCode::InvalidParams;
+			}
+			return true;
+		});
+
+		if (!object || !version || !method)
+			request.error = ErrorCode::InvalidRequest;
+	}
+
+	// false when line is not JSON, answer it with a ParseError and a null id
+	template<typename Params>
+	bool Parse(std::string_view line, Message<Params>& message)
+	{
+		simdjson::ondemand::document doc;
+		Json::Value root;
+		if (!Json::Parse(line, doc) || doc.get_value().get(root) != simdjson::SUCCESS)
+			return false;
+
+		simdjson::ondemand::array array;
+		if (root.get_array().get(array) != simdjson::SUCCESS)
+		{
+			ReadRequest(root, message.requests.emplace_back());
+			return true;
+		}
+
+		message.batch = true;
+		for (auto element : array)
+		{
+			Json::Value value;
+			if (element.get(value) != simdjson::SUCCESS)
+				return false;
+
+			ReadRequest(value, message.requests.emplace_back());
+		}
+
+		// an empty batch is one invalid request
+		if (message.requests.empty())
+		{
+			message.batch = false;
+			message.requests.emplace_back().error = ErrorCode::InvalidRequest;
+		}
+
+		return true;
+	}
+
+	// id is a raw JSON token, "null" when the request had none readable
+	void WriteResponse(Json::Writer& out, std::string_view id, const Result& result)
+	{
+		out.BeginObject();
+		out.Key("jsonrpc");
+		out.String("2.0");
+		out.Key("id");
+		out.Raw(id.empty() ? "null" : id);
+
+		if (result.error == ErrorCode::None)
+		{
+			out.Key("result");
+			out.Raw(result.value.GetString().empty() ? "null" : result.value.GetString());
+		}
+		else
+		{
+			out.Key("error");
+			out.BeginObject();
+			out.Member("code", result.error);
+			out.Member("message", result.message);
+			out.EndObject();
+		}
+
+		out.EndObject();
+	}
+
+	void WriteError(Json::Writer& out, std::string_view id, int code, std::string_view message)
+	{
+		Result result;
+		result.Fail(code, message);
+		WriteResponse(out, id, result);
+	}
+
+	// params is already encoded
+	void WriteNotification(Json::Writer& out, std::string_view method, std::string_view params)
+	{
+		out.BeginObject();
+		out.Key("jsonrpc");
+		out.String("2.0");
+		out.Key("method");
+		out.String(method);
+		out.Key("params");
+		out.Raw(params);
+		out.EndObject();
+	}
+}
@@ -0,0 +1,313 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Snapshot;
+
+import HE;
+import std;
+import Utils;
+
+// Versioned binary image of resolved state, read in place from a mapping.
+//
+//   Header
+//   SectionDesc[sectionCount]            id, record size, offset, count
+//   sections                             8-byte aligned arrays of trivially copyable records
+//
+// Strings are interned into two reserved sections (offsets + bytes) and records refer to them by index.
+// The sources the state was resolved from are a reserved section too, with their mtime and size at write time.
+
+export namespace Snapshot {
+
+	constexpr uint32_t c_Magic = 0x504E5348; // "HSNP"
+	constexpr uint32_t c_FormatVersion = 1;
+
+	// stat result of a source file, a missing file is recorded too so its creation invalidates the snapshot
+	struct Source
+	{
+		std::filesystem::path path;
+		int64_t mtime = -1;
+		uint64_t size = 0;
+
+		static Source Stat(const std::filesystem::path& path)
+		{
+			Source s;
+			s.path = path;
+
+			std::error_code ec;
+			auto time = std::filesystem::last_write_time(path, ec);
+			if (ec)
+				return s;
+
+			s.mtime = time.time_since_epoch().count();
+			s.size = std::filesystem::is_regular_file(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+			return s;
+		}
+
+		bool operator==(const Source& other) const = default;
+	};
+
+	// true if every source still has the mtime and size it had when the snapshot was written
+	bool IsFresh(const std::vector<Source>& sources)
+	{
+		HE_PROFILE_FUNCTION();
+
+		return std::all_of(sources.begin(), sources.end(), [](const Source& s) { return Source::Stat(s.path) == s; });
+	}
+
+	// The stat of each source as this process last read or wrote it. A source that differs on disk was changed
+	// by someone else since, so the state resolved from it must not be written as a fresh snapshot.
+	class Tracker
+	{
+	public:
+		void Record(const Source& s)
+		{
+			std::lock_guard lock(mutex);
+			sources[s.path] = s;
+		}
+
+		void Record(const std::filesystem::path& path) { Record(Source::Stat(path)); }
+
+		// keeps the stat of a source that was already recorded
+		void RecordIfNew(const std::filesystem::path& path)
+		{
+			std::lock_guard lock(mutex);
+			if (!sources.contains(path))
+				sources.emplace(path, Source::Stat(path));
+		}
+
+		void Clear()
+		{
+			std::lock_guard lock(mutex);
+			sources.clear();
+		}
+
+		// true if s is the recorded stat, or if its source was never recorded
+		bool Matches(const Source& s)
+		{
+			std::lock_guard lock(mutex);
+			auto it = sources.find(s.path);
+			return it == sources.end() || it->second == s;
+		}
+
+	private:
+		std::map<std::filesystem::path, Source> sources;
+		std::mutex mutex;
+	};
+}
+
+// Internal
+namespace Snapshot {
+
+	enum ReservedSection : uint32_t
+	{
+		StringOffsets = 0xFFFF0000,
+		StringBytes,
+		Sources
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t formatVersion;
+		uint32_t schemaVersion;
+		uint32_t sectionCount;
+	};
+
+	struct SectionDesc
+	{
+		uint32_t id;
+		uint32_t recordSize;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	struct StringRef
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct SourceRecord
+	{
+		uint32_t path;
+		uint32_t pad;
+		int64_t mtime;
+		uint64_t size;
+	};
+
+	constexpr uint64_t Align(uint64_t v) { return (v + 7) & ~7ull; }
+}
+
+export namespace Snapshot {
+
+	class Writer
+	{
+	public:
+		uint32_t Intern(std::string_view str)
+		{
+			auto it = interned.find(str);
+			if (it != interned.end())
+				return it->second;
+
+			uint32_t index = (uint32_t)strings.size();
+			strings.push_back({ (uint32_t)bytes.size(), (uint32_t)str.size() });
+			bytes.append(str);
+			interned.emplace(std::string(str), index);
+			return index;
+		}
+
+		void AddSource(const std::filesystem::path& path) { AddSource(Source::Stat(path)); }
+
+		void AddSource(const Source& s)
+		{
+			sources.push_back({ Intern(s.path.string()), 0, s.mtime, s.size });
+		}
+
+		template<typename T>
+		void AddSection(uint32_t id, std::span<const T> records)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			HE_ASSERT(id < ReservedSection::StringOffsets);
+
+			AddRaw(id, sizeof(T), records.data(), records.size());
+		}
+
+		bool Write(const std::filesystem::path& filePath, uint32_t schemaVersion)
+		{
+			HE_PROFILE_FUNCTION();
+
+			AddRaw(ReservedSection::StringOffsets, sizeof(StringRef), strings.data(), strings.size());
+			AddRaw(ReservedSection::StringBytes, 1, bytes.data(), bytes.size());
+			AddRaw(ReservedSection::Sources, sizeof(SourceRecord), sources.data(), sources.size());
+
+			Header header = { c_Magic, c_FormatVersion, schemaVersion, (uint32_t)sections.size() };
+
+			uint64_t offset = Align(sizeof(Header) + sizeof(SectionDesc) * sections.size());
+			std::vector<SectionDesc> descs;
+			for (const auto& s : sections)
+			{
+				descs.push_back({ s.id, s.recordSize, offset, s.data.size() / std::max(s.recordSize, 1u) });
+				offset = Align(offset + s.data.size());
+			}
+
+			std::string out(offset, '\0');
+			std::memcpy(out.data(), &header, sizeof(header));
+			std::memcpy(out.data() + sizeof(header), descs.data(), sizeof(SectionDesc) * descs.size());
+			for (size_t i = 0; i < sections.size(); i++)
+				std::memcpy(out.data() + descs[i].offset, sections[i].data.data(), sections[i].data.size());
+
+			return Utils::WriteFileAtomic(filePath, out);
+		}
+
+	private:
+		void AddRaw(uint32_t id, uint32_t recordSize, const void* data, size_t count)
+		{
+			auto& s = sections.emplace_back();
+			s.id = id;
+			s.recordSize = recordSize;
+			s.data.assign((const char*)data, (const char*)data + recordSize * count);
+		}
+
+		struct Section
+		{
+			uint32_t id;
+			uint32_t recordSize;
+			std::string data;
+		};
+
+		struct StringHash
+		{
+			using is_transparent = void;
+			size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+		};
+
+		std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> interned;
+		std::vector<StringRef> strings;
+		std::string bytes;
+		std::vector<SourceRecord> sources;
+		std::vector<Section> sections;
+	};
+
+	// Every accessor reads straight from the mapping, which stays valid until the Reader is destroyed.
+	class Reader
+	{
+	public:
+		// fails on a missing file, another format or schema version, or any out of range section
+		bool Open(const std::filesystem::path& filePath, uint32_t schemaVersion)
+		{
+			HE_PROFILE_FUNCTION();
+
+			if (!file.Open(filePath) || file.Size() < sizeof(Header))
+				return false;
+
+			const uint8_t* data = file.Data();
+			const Header* header = (const Header*)data;
+			if (header->magic != c_Magic || header->formatVersion != c_FormatVersion || header->schemaVersion != schemaVersion)
+				return false;
+
+			if (sizeof(Header) + sizeof(SectionDesc) * (uint64_t)header->sectionCount > file.Size())
+				return false;
+
+			sections = { (const SectionDesc*)(data + sizeof(Header)), header->sectionCount };
+			for (const auto& s : sections)
+			{
+				// division rather than count * recordSize, which a corrupt file can overflow
+				if (s.recordSize == 0 || s.offset % 8 != 0 || s.offset > file.Size() || s.count > (file.Size() - s.offset) / s.recordSize)
+					return false;
+			}
+
+			strings = GetSection<StringRef>(ReservedSection::StringOffsets);
+			bytes = GetSection<char>(ReservedSection::StringBytes);
+			for (const auto& s : strings)
+			{
+				if ((uint64_t)s.offset + s.size > bytes.size())
+					return false;
+			}
+
+			for (const auto& s : GetSection<SourceRecord>(ReservedSection::Sources))
+			{
+				if (s.path >= strings.size())
+					return false;
+			}
+
+			return true;
+		}
+
+		template<typename T>
+		std::span<const T> GetSection(uint32_t id) const
+		{
+			for (const auto& s : sections)
+			{
+				if (s.id == id && s.recordSize == sizeof(T))
+					return { (const T*)(file.Data() + s.offset), (size_t)s.count };
+			}
+
+			return {};
+		}
+
+		// out of range indices read as an empty string
+		std::string_view GetString(uint32_t index) const
+		{
+			if (index >= strings.size())
+				return {};
+
+			return { bytes.data() + strings[index].offset, strings[index].size };
+		}
+
+		std::vector<Source> GetSources() const
+		{
+			std::vector<Source> sources;
+			for (const auto& s : GetSection<SourceRecord>(ReservedSection::Sources))
+				sources.push_back({ std::filesystem::path(GetString(s.path)), s.mtime, s.size });
+
+			return sources;
+		}
+
+	private:
+		Utils::MappedFile file;
+		std::span<const SectionDesc> sections;
+		std::span<const StringRef> strings;
+		std::span<const char> bytes;
+	};
+}
@@ -0,0 +1,595 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+#ifdef HE_PLATFORM_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#endif
+
+export module Staging;
+
+import HE;
+import std;
+import Hash;
+import CopyEngine;
+import Utils;
+
+export namespace Staging {
+
+	constexpr const char* c_ManifestFileName = ".hstage";
+	constexpr const char* c_ManifestHeader = "HydraStage 2";
+
+	// How a planned file ends up in the output directory.
+	enum class Strategy : uint8_t
+	{
+		Auto,     // Copy for Dist, otherwise the cheapest safe option the filesystem offers
+		Copy,     // independent physical copy
+		HardLink, // shares the source inode, falls back to Copy across volumes
+		Reflink,  // copy-on-write clone (FICLONE), falls back to copy_file_range / Copy
+		Symlink,  // whole directories (Resources, Assets) become directory links, files are hard linked
+
+		Count
+	};
+
+	constexpr const char* c_StrategyStr[] = { "Auto", "Copy", "HardLink", "Reflink", "Symlink" };
+
+	const char* ToString(Strategy strategy) { return c_StrategyStr[(uint8_t)strategy]; }
+
+	Strategy StrategyFromString(std::string_view str)
+	{
+		for (uint8_t i = 0; i < (uint8_t)Strategy::Count; i++)
+			if (str == c_StrategyStr[i])
+				return (Strategy)i;
+
+		return Strategy::Auto;
+	}
+
+	struct FileEntry
+	{
+		uint64_t size = 0;
+		int64_t mtime = 0;  // source last write time
+		uint64_t hash = 0;  // source content hash
+		bool isLink = false; // directory link, size/mtime/hash unused
+	};
+
+	// What was staged into an output directory, keyed by the path relative to it.
+	struct Manifest
+	{
+		Strategy strategy = Strategy::Copy;
+		std::unordered_map<std::string, FileEntry> entries;
+
+		bool Read(const std::filesystem::path& filePath)
+		{
+			entries.clear();
+
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+				return false;
+
+			std::string line;
+			if (!std::getline(file, line) || !line.starts_with(c_ManifestHeader))
+				return false;
+
+			strategy = StrategyFromString(std::string_view(line).substr(std::min(line.size(), std::strlen(c_ManifestHeader) + 1)));
+
+			while (std::getline(file, line))
+			{
+				// <kind> <hash> <size> <mtime> <path>
+				std::string_view view = line;
+				if (view.size() < 2 || (view[0] != 'f' && view[0] != 'l'))
+					return false;
+
+				size_t p0 = view.find(' ', 2);
+				size_t p1 = view.find(' ', p0 + 1);
+				size_t p2 = view.find(' ', p1 + 1);
+				if (p0 == std::string_view::npos || p1 == std::string_view::npos || p2 == std::string_view::npos)
+					return false;
+
+				FileEntry e;
+				e.isLink = view[0] == 'l';
+				auto sizeStr = view.substr(p0 + 1, p1 - p0 - 1);
+				auto mtimeStr = view.substr(p1 + 1, p2 - p1 - 1);
+				if (!Hash::FromString(view.substr(2, p0 - 2), e.hash) ||
+					std::from_chars(sizeStr.data(), sizeStr.data() + sizeStr.size(), e.size).ec != std::errc() ||
+					std::from_chars(mtimeStr.data(), mtimeStr.data() + mtimeStr.size(), e.mtime).ec != std::errc())
+				{
+					return false;
+				}
+
+				entries[std::string(view.substr(p2 + 1))] = e;
+			}
+
+			return true;
+		}
+
+		bool Write(const std::filesystem::path& filePath) const
+		{
+			std::ofstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+			{
+				HE_ERROR("Unable to open file for writing, {}", filePath.string());
+				return false;
+			}
+
+			file << c_ManifestHeader << " " << ToString(strategy) << "\n";
+			for (auto& [path, e] : entries)
+				file << (e.isLink ? 'l' : 'f') << " " << Hash::ToString(e.hash) << " " << e.size << " " << e.mtime << " " << path << "\n";
+
+			return file.good();
+		}
+	};
+
+	// The set of files an output directory should contain.
+	struct Plan
+	{
+		struct Item
+		{
+			std::filesystem::path src;
+			std::string dst; // relative to the output directory, '/' separated
+			uint64_t size = 0; // scheduling hint, the source is stat'ed again when staged
+		};
+
+		struct Directory
+		{
+			std::filesystem::path src;
+			std::string dst;
+			bool recursive = true;
+			std::function<bool(const std::filesystem::path&)> filter;
+
+			// a whole, unfiltered tree can be staged as a single directory link
+			bool IsLinkable() const { return recursive && !filter; }
+		};
+
+		std::vector<Item> items;
+		std::vector<Directory> directories;
+
+		void AddFile(const std::filesystem::path& src, const std::filesystem::path& dst)
+		{
+			std::error_code ec;
+			uint64_t size = std::filesystem::file_size(src, ec);
+			items.push_back({ src, dst.lexically_normal().generic_string(), ec ? 0 : size });
+		}
+
+		void AddDirectory(const std::filesystem::path& srcDir, const std::filesystem::path& dstDir, bool recursive = true, const std::function<bool(const std::filesystem::path&)>& filter = {})
+		{
+			std::error_code ec;
+			if (!std::filesystem::is_directory(srcDir, ec))
+				return;
+
+			directories.push_back({ srcDir, dstDir.lexically_normal().generic_string(), recursive, filter });
+		}
+
+		void Expand(const Directory& dir, std::vector<Item>& outItems) const
+		{
+			std::error_code ec;
+			auto add = [&](const std::filesystem::directory_entry& entry) {
+				if (!entry.is_regular_file())
+					return;
+
+				if (dir.filter && !dir.filter(entry.path()))
+					return;
+
+				std::error_code sizeEc;
+				uint64_t size = entry.file_size(sizeEc);
+
+				auto dst = std::filesystem::path(dir.dst) / entry.path().lexically_relative(dir.src);
+				outItems.push_back({ entry.path(), dst.lexically_normal().generic_string(), sizeEc ? 0 : size });
+			};
+
+			if (dir.recursive)
+			{
+				for (const auto& entry : std::filesystem::recursive_directory_iterator(dir.src, ec))
+					add(entry);
+			}
+			else
+			{
+				for (const auto& entry : std::filesystem::directory_iterator(dir.src, ec))
+					add(entry);
+			}
+		}
+	};
+
+	struct Summary
+	{
+		uint32_t copiedFiles = 0;
+		uint32_t linkedFiles = 0;
+		uint32_t skippedFiles = 0;
+		uint32_t removedFiles = 0;
+		uint32_t failedFiles = 0;
+		uint32_t linkedDirectories = 0;
+		uint64_t copiedBytes = 0;
+		uint64_t linkedBytes = 0;
+		uint64_t skippedBytes = 0;
+		double seconds = 0.0;
+		std::vector<std::string> skippedPaths; // relative to the output directory, left as the previous run staged them
+	};
+}
+
+// Internal
+namespace Staging {
+
+	int64_t GetLastWriteTime(const std::filesystem::path& path, std::error_code& ec)
+	{
+		return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+	}
+
+	void RemoveEmptyParents(std::filesystem::path dir, const std::filesystem::path& root)
+	{
+		std::error_code ec;
+		while (dir != root && dir.native().size() > root.native().size() && !std::filesystem::is_symlink(dir, ec) && std::filesystem::is_empty(dir, ec))
+		{
+			std::filesystem::remove(dir, ec);
+			dir = dir.parent_path();
+		}
+	}
+
+	// true if any directory between root and the file is a link, deleting through it would hit the source
+	bool HasLinkedParent(const std::filesystem::path& root, std::string_view relative)
+	{
+		std::error_code ec;
+		size_t pos = relative.find('/');
+		while (pos != std::string_view::npos)
+		{
+			if (std::filesystem::is_symlink(root / relative.substr(0, pos), ec))
+				return true;
+
+			pos = relative.find('/', pos + 1);
+		}
+
+		return false;
+	}
+
+	bool IsExecutableImage(const std::filesystem::path& path)
+	{
+		auto ext = path.extension();
+		return ext == ".exe" || ext == ".dll" || ext == ".so" || ext == ".dylib" || ext == ".pdb";
+	}
+
+	bool CopyFile(const std::filesystem::path& src, const std::filesystem::path& dst, std::error_code& ec)
+	{
+		std::filesystem::copy_file(src, dst, std::filesystem::copy_options::overwrite_existing, ec);
+		return !ec;
+	}
+
+	// copy-on-write clone where the filesystem supports it (btrfs, xfs), else an in-kernel copy
+	bool ReflinkFile(const std::filesystem::path& src, const std::filesystem::path& dst, bool& cloned, std::error_code& ec)
+	{
+		cloned = false;
+
+#ifdef HE_PLATFORM_LINUX
+		int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+		if (in < 0)
+		{
+			ec = std::error_code(errno, std::generic_category());
+			return false;
+		}
+
+		struct stat st;
+		::fstat(in, &st);
+
+		int out = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+		if (out < 0)
+		{
+			ec = std::error_code(errno, std::generic_category());
+			::close(in);
+			return false;
+		}
+
+		bool ok = ::ioctl(out, FICLONE, in) == 0;
+		cloned = ok;
+
+		if (!ok)
+		{
+			off_t remaining = st.st_size;
+			ok = true;
+			while (remaining > 0)
+			{
+				ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, (size_t)remaining, 0);
+				if (n <= 0)
+				{
+					ok = false;
+					break;
+				}
+				remaining -= n;
+			}
+		}
+
+		::close(in);
+		::close(out);
+
+		if (!ok)
+			return CopyFile(src, dst, ec);
+
+		return true;
+#else
+		// CopyFile2 already clones blocks on ReFS / Dev Drive volumes
+		return CopyFile(src, dst, ec);
+#endif
+	}
+
+	bool CreateDirectoryLink(const std::filesystem::path& src, const std::filesystem::path& dst)
+	{
+		std::error_code ec;
+		if (std::filesystem::is_symlink(dst, ec))
+		{
+			if (std::filesystem::equivalent(std::filesystem::read_symlink(dst, ec), src, ec))
+				return true;
+
+			std::filesystem::remove(dst, ec);
+		}
+
+		if (std::filesystem::exists(dst, ec))
+		{
+			RemoveEmptyParents(dst, dst.parent_path());
+			if (std::filesystem::exists(dst, ec))
+				return false; // still holds files we don't own
+		}
+
+		std::filesystem::create_directories(dst.parent_path(), ec);
+		std::filesystem::create_directory_symlink(std::filesystem::absolute(src), dst, ec);
+		return !ec;
+	}
+}
+
+export namespace Staging {
+
+	// Auto resolves per file : reflinks are always safe, hard links are only used for data files since a
+	// running exe/dll that shares its inode with the build output would lock or mutate it on the next link.
+	Strategy ResolveFileStrategy(Strategy strategy, const std::filesystem::path& src)
+	{
+		if (strategy != Strategy::Auto)
+			return strategy;
+
+#ifdef HE_PLATFORM_LINUX
+		return Strategy::Reflink;
+#else
+		return IsExecutableImage(src) ? Strategy::Copy : Strategy::HardLink;
+#endif
+	}
+
+	// places src at dst with the requested strategy, returns the strategy that was actually used
+	Strategy Materialize(const std::filesystem::path& src, const std::filesystem::path& dst, Strategy strategy, std::error_code& ec)
+	{
+		// never write through an existing file, it may be a link to the source
+		std::filesystem::remove(dst, ec);
+		ec.clear();
+
+		switch (strategy)
+		{
+		case Strategy::Symlink:
+		case Strategy::HardLink:
+		{
+			std::filesystem::create_hard_link(src, dst, ec);
+			if (!ec)
+				return Strategy::HardLink;
+
+			ec.clear();
+			break;
+		}
+		case Strategy::Reflink:
+		{
+			bool cloned = false;
+			if (ReflinkFile(src, dst, cloned, ec))
+				return cloned ? Strategy::Reflink : Strategy::Copy;
+
+			return Strategy::Copy;
+		}
+		case Strategy::Auto:
+		case Strategy::Copy:
+		case Strategy::Count:
+			break;
+		}
+
+		CopyFile(src, dst, ec);
+		return Strategy::Copy;
+	}
+
+	// Full copies for Dist, the cheapest safe strategy otherwise.
+	Strategy GetDefaultStrategy(bool dist)
+	{
+		return dist ? Strategy::Copy : Strategy::Auto;
+	}
+
+	// Brings outputDir in line with the plan, writing only added or changed files and deleting stale ones.
+	Summary Stage(const Plan& plan, const std::filesystem::path& outputDir, Strategy strategy = Strategy::Copy, CopyEngine::Progress* progress = nullptr)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+		Summary summary;
+
+		std::error_code ec;
+		std::filesystem::create_directories(outputDir, ec);
+
+		auto manifestPath = outputDir / c_ManifestFileName;
+		Manifest previous;
+		previous.Read(manifestPath);
+
+		// switching strategy re-materializes everything
+		bool canSkip = previous.strategy == strategy;
+
+		Manifest current;
+		current.strategy = strategy;
+
+		std::vector<Plan::Item> items = plan.items;
+		std::vector<const Plan::Directory*> links;
+		for (const auto& dir : plan.directories)
+		{
+			if (strategy == Strategy::Symlink && dir.IsLinkable())
+				links.push_back(&dir);
+			else
+				plan.Expand(dir, items);
+		}
+
+		// 1. links from the previous run that are no longer wanted
+		for (const auto& [path, e] : previous.entries)
+		{
+			if (!e.isLink)
+				continue;
+
+			bool keep = std::any_of(links.begin(), links.end(), [&](const Plan::Directory* d) { return d->dst == path; });
+			if (!keep && std::filesystem::is_symlink(outputDir / path, ec))
+				std::filesystem::remove(outputDir / path, ec);
+		}
+
+		std::unordered_set<std::string> planned;
+		planned.reserve(items.size());
+		for (const auto& item : items)
+			planned.insert(item.dst);
+
+		// 2. stale files from the previous run
+		for (const auto& [path, e] : previous.entries)
+		{
+			if (e.isLink || planned.contains(path) || HasLinkedParent(outputDir, path))
+				continue;
+
+			auto dst = outputDir / path;
+			if (std::filesystem::remove(dst, ec))
+			{
+				summary.removedFiles++;
+				RemoveEmptyParents(dst.parent_path(), outputDir);
+			}
+		}
+
+		// 3. directory links, a directory that can't be linked is staged file by file
+		for (auto dir : links)
+		{
+			if (CreateDirectoryLink(dir->src, outputDir / dir->dst))
+			{
+				FileEntry e;
+				e.isLink = true;
+				current.entries[dir->dst] = e;
+				summary.linkedDirectories++;
+			}
+			else
+			{
+				HE_WARN("Staging : unable to link {}, staging files", dir->dst);
+				plan.Expand(*dir, items);
+			}
+		}
+
+		enum class Outcome : uint8_t { Skipped, Copied, Linked, Failed };
+
+		std::vector<FileEntry> entries(items.size());
+		std::vector<Outcome> outcomes(items.size(), Outcome::Failed);
+
+		auto stageItem = [&](size_t index) {
+			const Plan::Item& item = items[index];
+			FileEntry& e = entries[index];
+
+			std::error_code ec;
+			e.size = std::filesystem::file_size(item.src, ec);
+			if (!ec) e.mtime = GetLastWriteTime(item.src, ec);
+			if (ec)
+			{
+				HE_ERROR("Staging : unable to read {} : {}", item.src.string(), ec.message());
+				return Outcome::Failed;
+			}
+
+			auto dst = outputDir / item.dst;
+			auto it = previous.entries.find(item.dst);
+			bool hashed = false;
+			bool dstValid = std::filesystem::file_size(dst, ec) == e.size && !ec;
+
+			if (canSkip && it != previous.entries.end() && !it->second.isLink && dstValid)
+			{
+				const FileEntry& old = it->second;
+
+				// unchanged source, no need to read it
+				if (old.size == e.size && old.mtime == e.mtime)
+				{
+					e.hash = old.hash;
+					return Outcome::Skipped;
+				}
+
+				// touched but identical (e.g. a relinked dll with the same content)
+				if (old.size == e.size && (hashed = Hash::ComputeFile(item.src, e.hash)) && e.hash == old.hash)
+					return Outcome::Skipped;
+			}
+
+			if (!hashed && !Hash::ComputeFile(item.src, e.hash))
+			{
+				HE_ERROR("Staging : unable to read {}", item.src.string());
+				return Outcome::Failed;
+			}
+
+			Strategy used = Materialize(item.src, dst, ResolveFileStrategy(strategy, item.src), ec);
+			if (ec)
+			{
+				HE_ERROR("Staging : unable to stage {} : {}", item.src.string(), ec.message());
+				return Outcome::Failed;
+			}
+
+			return used == Strategy::Copy ? Outcome::Copied : Outcome::Linked;
+		};
+
+		// 4. files, stat/hash/materialize fan out across the copy engine
+		CopyEngine::Queue queue;
+		queue.jobs.reserve(items.size());
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			queue.Add(items[i].src, outputDir / items[i].dst, items[i].size, [&, i](const CopyEngine::Job&) {
+				outcomes[i] = stageItem(i);
+				return outcomes[i] != Outcome::Failed;
+			});
+		}
+		queue.Run(progress);
+
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			const Plan::Item& item = items[i];
+			const FileEntry& e = entries[i];
+
+			switch (outcomes[i])
+			{
+			case Outcome::Skipped:
+				summary.skippedFiles++;
+				summary.skippedBytes += e.size;
+				summary.skippedPaths.push_back(item.dst);
+				break;
+			case Outcome::Copied:
+				summary.copiedFiles++;
+				summary.copiedBytes += e.size;
+				break;
+			case Outcome::Linked:
+				summary.linkedFiles++;
+				summary.linkedBytes += e.size;
+				break;
+			case Outcome::Failed:
+			{
+				// keeps whatever is already staged, with a zero mtime so the next run looks at it again
+				summary.failedFiles++;
+				auto it = previous.entries.find(item.dst);
+				if (it != previous.entries.end() && !it->second.isLink)
+					current.entries[item.dst] = { it->second.size, 0, it->second.hash };
+				continue;
+			}
+			}
+
+			current.entries[item.dst] = e;
+		}
+
+		current.Write(manifestPath);
+
+		summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		HE_INFO(
+			"Staging {} ({}) : {} copied ({}), {} linked ({}), {} directory links, {} skipped ({}), {} removed, {} failed in {:.3f}s",
+			outputDir.string(),
+			ToString(strategy),
+			summary.copiedFiles, Utils::FormatBytes(summary.copiedBytes),
+			summary.linkedFiles, Utils::FormatBytes(summary.linkedBytes),
+			summary.linkedDirectories,
+			summary.skippedFiles, Utils::FormatBytes(summary.skippedBytes),
+			summary.removedFiles,
+			summary.failedFiles,
+			summary.seconds
+		);
+
+		return summary;
+	}
+}
@@ -1,12 +1,22 @@
 module;
 
 #include "HydraEngine/Base.h"
+
+#ifdef HE_PLATFORM_WINDOWS
 #include <windows.h>
 #include <stdio.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 module Utils;
 import HE;
 
+#ifdef HE_PLATFORM_WINDOWS
 namespace Utils {
 
 	Process::~Process()
@@ -42,17 +52,23 @@ namespace Utils {
 		return result;
 	}
 
-	void Process::Wait()
+	int Process::Wait()
 	{
-		if (hProcess)
-		{
-			WaitForSingleObject(hProcess, INFINITE);
+		if (!hProcess)
+			return -1;
 
-			CloseHandle(hProcess);
-			CloseHandle(hThread);
-			hProcess = nullptr;
-			hThread = nullptr;
-		}
+		WaitForSingleObject(hProcess, INFINITE);
+
+		DWORD exitCode = 0;
+		if (!GetExitCodeProcess(hProcess, &exitCode))
+			exitCode = (DWORD)-1;
+
+		CloseHandle(hProcess);
+		CloseHandle(hThread);
+		hProcess = nullptr;
+		hThread = nullptr;
+
+		return (int)exitCode;
 	}
 	
 	void Process::Kill()
@@ -175,4 +191,125 @@ namespace Utils {
 
 		return result;
 	}
-}
\ No newline at end of file
+}
+#else
+
+// Internal
+namespace Utils {
+
+	// forks a child that runs command through /bin/sh in workingDir, its stdout and stderr go to outputFd when
+	// given, are dropped without showOutput and inherited otherwise. -1 when nothing was started
+	pid_t Spawn(const char* command, const char* workingDir, bool showOutput, int outputFd)
+	{
+		pid_t pid = fork();
+		if (pid != 0)
+			return pid;
+
+		if (workingDir && chdir(workingDir) != 0)
+			_exit(127);
+
+		int fd = outputFd >= 0 ? outputFd : showOutput ? -1 : open("/dev/null", O_WRONLY);
+		if (fd >= 0)
+		{
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+		}
+
+		execl("/bin/sh", "sh", "-c", command, (char*)nullptr);
+		_exit(127);
+	}
+
+	int WaitExitCode(pid_t pid)
+	{
+		int status = 0;
+		while (waitpid(pid, &status, 0) < 0)
+		{
+			if (errno != EINTR)
+				return -1;
+		}
+
+		return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	}
+
+	void ReadAll(int fd, std::string* output)
+	{
+		char buffer[4096];
+		ssize_t bytesRead;
+		while ((bytesRead = read(fd, buffer, sizeof(buffer))) > 0 || (bytesRead < 0 && errno == EINTR))
+		{
+			if (bytesRead > 0)
+				output->append(buffer, bytesRead);
+		}
+
+		close(fd);
+	}
+}
+
+namespace Utils {
+
+	Process::~Process()
+	{
+	}
+
+	bool Process::Start(const char* command, bool showOutput, const char* workingDir)
+	{
+		pid_t pid = Spawn(command, workingDir, showOutput, -1);
+		dwProcessId = pid > 0 ? (uint32_t)pid : 0;
+
+		return pid > 0;
+	}
+
+	int Process::Wait()
+	{
+		if (!dwProcessId)
+			return -1;
+
+		int exitCode = WaitExitCode((pid_t)dwProcessId);
+		dwProcessId = 0;
+
+		return exitCode;
+	}
+
+	void Process::Kill()
+	{
+		if (dwProcessId)
+		{
+			kill((pid_t)dwProcessId, SIGKILL);
+			WaitExitCode((pid_t)dwProcessId);
+			dwProcessId = 0;
+		}
+	}
+
+	// the result is whether the command started, as on Windows
+	bool ExecCommand(const char* command, std::string* output, const char* workingDir, bool async, bool showOutput, const std::function<void()>& onComplete)
+	{
+		// close on exec so other children never hold the write end, dup2 clears it on this one's stdout and stderr
+		int fds[2] = { -1, -1 };
+		if (output && pipe2(fds, O_CLOEXEC) != 0)
+			return false;
+
+		pid_t pid = Spawn(command, workingDir, showOutput, fds[1]);
+		if (output)
+			close(fds[1]);
+
+		bool result = pid > 0;
+		auto finish = [pid, result, output, readFd = fds[0], onComplete]() {
+			if (output)
+				ReadAll(readFd, output);
+
+			if (result)
+				WaitExitCode(pid);
+
+			if (onComplete)
+				onComplete();
+		};
+
+		if (async)
+			std::thread(finish).detach();
+		else
+			finish();
+
+		return result;
+	}
+}
+#endif
@@ -5,6 +5,11 @@
 
 #ifdef HE_PLATFORM_WINDOWS
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 export module Utils;
@@ -23,18 +28,29 @@ export namespace Utils {
 		~Process();
 	
 		bool Start(const char* command, bool showOutput = false, const char* workingDir = nullptr);
-		void Wait();
+		int Wait(); // exit code, -1 when nothing was started
 		void Kill();
 
 	private:
-		void* hProcess;
-		void* hThread;
-		uint32_t dwProcessId;
-		uint32_t dwThreadId;
+		void* hProcess = nullptr;
+		void* hThread = nullptr;
+		uint32_t dwProcessId = 0;
+		uint32_t dwThreadId = 0;
 	};
 	
 	bool ExecCommand(const char* command, std::string* output = nullptr, const char* workingDir = nullptr, bool async = false, bool showOutput = false, const std::function<void()>& onComplete = {});
 
+	// runs an executable and waits for it, without a shell on Windows and through /bin/sh elsewhere. unlike
+	// ExecCommand the result is the exit code, -1 when it did not start
+	int RunProcess(const char* command, const char* workingDir = nullptr, bool showOutput = false)
+	{
+		Process process;
+		if (!process.Start(command, showOutput, workingDir))
+			return -1;
+
+		return process.Wait();
+	}
+
 	enum class AppDataType 
 	{
 		Roaming,
@@ -85,7 +101,7 @@ export namespace Utils {
 		return appDataPath;
 	}
 
-	void CopyDepenDlls(const std::filesystem::path& to, bool debug)
+	std::vector<std::filesystem::path> GetDepenDlls(bool debug)
 	{
 		const char* dlls[] = {
 			"vcruntime140_1.dll", 
@@ -101,11 +117,212 @@ export namespace Utils {
 			dlls[2] = "ucrtbased.dll";
 			dlls[3] = "msvcp140d.dll";
 		}
-		
+
+		std::vector<std::filesystem::path> paths;
 		for (auto name : dlls)
+			paths.push_back("C:/Windows/System32/" + std::string(name));
+
+		return paths;
+	}
+
+	void CopyDepenDlls(const std::filesystem::path& to, bool debug)
+	{
+		for (auto& dll : GetDepenDlls(debug))
+		{
+			std::filesystem::copy_file(dll, to / dll.filename(), std::filesystem::copy_options::overwrite_existing);
+		}
+	}
+
+	std::string FormatBytes(uint64_t bytes)
+	{
+		const char* units[] = { "B", "KB", "MB", "GB", "TB" };
+		double value = (double)bytes;
+		int unit = 0;
+		while (value >= 1024.0 && unit < 4)
+		{
+			value /= 1024.0;
+			unit++;
+		}
+
+		return std::format("{:.2f} {}", value, units[unit]);
+	}
+
+	// Read-only view of a whole file, the pages are loaded lazily by the OS.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { Close(); }
+
+		bool Open(const std::filesystem::path& path)
+		{
+			Close();
+
+#ifdef HE_PLATFORM_WINDOWS
+			file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				file = nullptr;
+				return false;
+			}
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize))
+			{
+				Close();
+				return false;
+			}
+
+			size = (size_t)fileSize.QuadPart;
+			if (size == 0)
+				return true;
+
+			mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping)
+			{
+				Close();
+				return false;
+			}
+
+			data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+			int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				return false;
+
+			struct stat st;
+			if (::fstat(fd, &st) != 0)
+			{
+				::close(fd);
+				return false;
+			}
+
+			size = (size_t)st.st_size;
+			if (size == 0)
+			{
+				::close(fd);
+				return true;
+			}
+
+			void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			data = ptr == MAP_FAILED ? nullptr : (const uint8_t*)ptr;
+#endif
+			if (!data)
+			{
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void Close()
+		{
+#ifdef HE_PLATFORM_WINDOWS
+			if (data) UnmapViewOfFile(data);
+			if (mapping) CloseHandle(mapping);
+			if (file) CloseHandle(file);
+			mapping = nullptr;
+			file = nullptr;
+#else
+			if (data) ::munmap((void*)data, size);
+#endif
+			data = nullptr;
+			size = 0;
+		}
+
+		const uint8_t* Data() const { return data; }
+		size_t Size() const { return size; }
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+#ifdef HE_PLATFORM_WINDOWS
+		HANDLE file = nullptr;
+		HANDLE mapping = nullptr;
+#endif
+	};
+
+	// Writes content to a temp file next to path, flushes it to disk, then renames it over path.
+	// Readers see either the old or the new file, never a truncated one.
+	bool WriteFileAtomic(const std::filesystem::path& path, std::string_view content)
+	{
+		auto tmpPath = path;
+		tmpPath += ".tmp";
+
+#ifdef HE_PLATFORM_WINDOWS
+		HANDLE file = CreateFileW(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		DWORD written = 0;
+		bool ok = WriteFile(file, content.data(), (DWORD)content.size(), &written, nullptr) && written == content.size();
+		ok = FlushFileBuffers(file) && ok;
+		CloseHandle(file);
+
+		ok = ok && MoveFileExW(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+		int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (fd < 0)
+			return false;
+
+		bool ok = true;
+		size_t offset = 0;
+		while (ok && offset < content.size())
+		{
+			ssize_t n = ::write(fd, content.data() + offset, content.size() - offset);
+			ok = n > 0;
+			offset += ok ? (size_t)n : 0;
+		}
+
+		ok = ::fsync(fd) == 0 && ok;
+		::close(fd);
+
+		ok = ok && ::rename(tmpPath.c_str(), path.c_str()) == 0;
+
+		// persist the rename itself
+		if (ok)
 		{
-			std::filesystem::copy_file("C:/Windows/System32/" + std::string(name), to / name, std::filesystem::copy_options::overwrite_existing);
+			int dir = ::open(path.parent_path().empty() ? "." : path.parent_path().c_str(), O_RDONLY | O_CLOEXEC);
+			if (dir >= 0)
+			{
+				::fsync(dir);
+				::close(dir);
+			}
 		}
+#endif
+
+		if (!ok)
+		{
+			std::error_code ec;
+			std::filesystem::remove(tmpPath, ec);
+		}
+
+		return ok;
+	}
+
+	// A '/' separated relative path that stays below its root on every platform, for paths read from stores and
+	// manifests. normalized receives it without "." components.
+	bool IsContainedPath(std::string_view path, std::string& normalized)
+	{
+		if (path.empty() || path.find('\\') != std::string_view::npos || path.find(':') != std::string_view::npos)
+			return false;
+
+		auto p = std::filesystem::path(path).lexically_normal();
+		if (p.is_absolute() || p.has_root_name() || p.has_root_directory() || !p.has_filename() || p == ".")
+			return false;
+
+		for (const auto& part : p)
+		{
+			if (part == "..")
+				return false;
+		}
+
+		normalized = p.generic_string();
+		return true;
 	}
 
 	const char* GetLastWriteTime(const std::filesystem::path& path)
@@ -0,0 +1,783 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Zip;
+
+import HE;
+import std;
+import Utils;
+import CopyEngine;
+
+// Internal
+namespace Zip {
+
+	inline uint16_t Read16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+	inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+	inline uint64_t Read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+	// slicing-by-8 tables
+	struct CrcTables
+	{
+		uint32_t t[8][256];
+
+		constexpr CrcTables() : t{}
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				t[0][i] = c;
+			}
+
+			for (uint32_t i = 0; i < 256; i++)
+				for (int s = 1; s < 8; s++)
+					t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+		}
+	};
+
+	constexpr CrcTables c_Crc;
+
+	struct Huffman
+	{
+		static constexpr uint32_t c_FastBits = 10;
+
+		uint16_t fast[1 << c_FastBits]; // symbol << 4 | length, 0 when the code is longer than c_FastBits
+		uint16_t counts[16];
+		uint16_t symbols[288];
+
+		bool Build(const uint8_t* lengths, uint32_t count)
+		{
+			std::memset(counts, 0, sizeof(counts));
+			for (uint32_t i = 0; i < count; i++)
+				counts[lengths[i]]++;
+			counts[0] = 0;
+
+			// over-subscribed sets are invalid, incomplete ones are allowed (single distance code)
+			int left = 1;
+			for (int len = 1; len < 16; len++)
+			{
+				left <<= 1;
+				left -= counts[len];
+				if (left < 0)
+					return false;
+			}
+
+			uint16_t offsets[16];
+			offsets[1] = 0;
+			for (int len = 1; len < 15; len++)
+				offsets[len + 1] = offsets[len] + counts[len];
+
+			for (uint32_t i = 0; i < count; i++)
+				if (lengths[i])
+					symbols[offsets[lengths[i]]++] = (uint16_t)i;
+
+			std::memset(fast, 0, sizeof(fast));
+
+			uint32_t code = 0;
+			uint32_t index = 0;
+			for (uint32_t len = 1; len <= c_FastBits; len++)
+			{
+				for (uint32_t i = 0; i < counts[len]; i++, code++, index++)
+				{
+					// deflate packs codes MSB first into an LSB first stream
+					uint32_t reversed = 0;
+					for (uint32_t b = 0; b < len; b++)
+						reversed |= ((code >> b) & 1) << (len - 1 - b);
+
+					for (uint32_t j = reversed; j < (1u << c_FastBits); j += 1u << len)
+						fast[j] = uint16_t((symbols[index] << 4) | len);
+				}
+				code <<= 1;
+			}
+
+			return true;
+		}
+	};
+
+	constexpr uint16_t c_LengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr uint8_t c_LengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr uint16_t c_DistBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr uint8_t c_DistExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	constexpr uint8_t c_CodeLengthOrder[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	constexpr size_t c_WindowSize = 32768;
+	constexpr size_t c_OutputSize = 1 << 20;
+	constexpr size_t c_MaxMatch = 258;
+
+	// Raw deflate (RFC 1951) decoder. Output goes through a 1 MiB buffer that keeps the last 32 KiB as
+	// history, so memory stays fixed no matter how large the entry is.
+	class Inflater
+	{
+	public:
+		using Sink = std::function<bool(const uint8_t*, size_t)>;
+
+		bool Inflate(const uint8_t* src, size_t srcSize, const Sink& sink)
+		{
+			in = src;
+			inEnd = src + srcSize;
+			bitBuffer = 0;
+			bitCount = 0;
+			overrun = 0;
+			produced = 0;
+			pos = 0;
+			this->sink = &sink;
+			output.resize(c_OutputSize + c_WindowSize);
+
+			bool last = false;
+			while (!last)
+			{
+				Refill();
+				last = Bits(1);
+				uint32_t type = (uint32_t)Bits(2);
+
+				bool ok = false;
+				switch (type)
+				{
+				case 0: ok = Stored(); break;
+				case 1: ok = Block(GetFixedLitLen(), GetFixedDist()); break;
+				case 2: ok = Dynamic(); break;
+				default: ok = false; break;
+				}
+
+				if (!ok || Overrun())
+					return false;
+			}
+
+			return Flush(0);
+		}
+
+	private:
+		void Refill()
+		{
+			if (inEnd - in >= 8)
+			{
+				bitBuffer |= Read64(in) << bitCount;
+				in += (63 - bitCount) >> 3;
+				bitCount |= 56;
+				return;
+			}
+
+			while (bitCount <= 56)
+			{
+				if (in < inEnd)
+					bitBuffer |= uint64_t(*in++) << bitCount;
+				else
+					overrun++;
+				bitCount += 8;
+			}
+		}
+
+		uint64_t Bits(uint32_t n)
+		{
+			uint64_t v = bitBuffer & ((uint64_t(1) << n) - 1);
+			bitBuffer >>= n;
+			bitCount -= n;
+			return v;
+		}
+
+		// true once bits past the end of the input have been consumed
+		bool Overrun() const { return overrun * 8 > bitCount; }
+
+		int Decode(const Huffman& h)
+		{
+			uint32_t e = h.fast[bitBuffer & ((1u << Huffman::c_FastBits) - 1)];
+			if (e)
+			{
+				Bits(e & 15);
+				return int(e >> 4);
+			}
+
+			// canonical decode for the rare long codes
+			int code = 0, first = 0, index = 0;
+			uint64_t b = bitBuffer;
+			for (uint32_t len = 1; len < 16; len++)
+			{
+				code |= int(b & 1);
+				b >>= 1;
+
+				int count = h.counts[len];
+				if (code - first < count)
+				{
+					Bits(len);
+					return h.symbols[index + code - first];
+				}
+
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+
+			return -1;
+		}
+
+		bool Flush(size_t keep)
+		{
+			if (pos <= keep)
+				return true;
+
+			size_t n = pos - keep;
+			if (!(*sink)(output.data(), n))
+				return false;
+
+			std::memmove(output.data(), output.data() + n, keep);
+			pos = keep;
+			return true;
+		}
+
+		bool Stored()
+		{
+			// back to byte alignment, return whole unread bytes to the input
+			Bits(bitCount & 7);
+			size_t unread = bitCount / 8;
+			if (unread < overrun)
+				return false;
+
+			in -= unread - overrun;
+			bitBuffer = 0;
+			bitCount = 0;
+			overrun = 0;
+
+			if (inEnd - in < 4)
+				return false;
+
+			uint16_t len = Read16(in);
+			uint16_t nlen = Read16(in + 2);
+			in += 4;
+			if (len != (uint16_t)~nlen || (size_t)(inEnd - in) < len)
+				return false;
+
+			while (len > 0)
+			{
+				if (pos >= c_OutputSize && !Flush(c_WindowSize))
+					return false;
+
+				size_t n = std::min<size_t>(len, output.size() - pos);
+				std::memcpy(output.data() + pos, in, n);
+				pos += n;
+				produced += n;
+				in += n;
+				len -= (uint16_t)n;
+			}
+
+			return true;
+		}
+
+		bool Block(const Huffman& litLen, const Huffman& dist)
+		{
+			while (true)
+			{
+				if (pos > c_OutputSize && !Flush(c_WindowSize))
+					return false;
+
+				Refill();
+
+				int sym = Decode(litLen);
+				if (sym < 0)
+					return false;
+
+				if (sym < 256)
+				{
+					output[pos++] = (uint8_t)sym;
+					produced++;
+					continue;
+				}
+
+				if (sym == 256)
+					return true;
+
+				sym -= 257;
+				if (sym >= 29)
+					return false;
+
+				size_t length = c_LengthBase[sym] + Bits(c_LengthExtra[sym]);
+
+				int dsym = Decode(dist);
+				if (dsym < 0 || dsym >= 30)
+					return false;
+
+				size_t distance = c_DistBase[dsym] + Bits(c_DistExtra[dsym]);
+				if (distance > produced || Overrun())
+					return false;
+
+				uint8_t* dst = output.data() + pos;
+				const uint8_t* ref = dst - distance;
+				if (distance >= length)
+				{
+					std::memcpy(dst, ref, length);
+				}
+				else
+				{
+					for (size_t i = 0; i < length; i++)
+						dst[i] = ref[i];
+				}
+
+				pos += length;
+				produced += length;
+			}
+		}
+
+		bool Dynamic()
+		{
+			uint32_t hlit = (uint32_t)Bits(5) + 257;
+			uint32_t hdist = (uint32_t)Bits(5) + 1;
+			uint32_t hclen = (uint32_t)Bits(4) + 4;
+			if (hlit > 286 || hdist > 30)
+				return false;
+
+			uint8_t lengths[288 + 32] = {};
+			for (uint32_t i = 0; i < hclen; i++)
+			{
+				Refill();
+				lengths[c_CodeLengthOrder[i]] = (uint8_t)Bits(3);
+			}
+
+			Huffman codeLengths;
+			if (!codeLengths.Build(lengths, 19))
+				return false;
+
+			std::memset(lengths, 0, sizeof(lengths));
+			uint32_t n = 0;
+			while (n < hlit + hdist)
+			{
+				Refill();
+				int sym = Decode(codeLengths);
+				if (sym < 0)
+					return false;
+
+				if (sym < 16)
+				{
+					lengths[n++] = (uint8_t)sym;
+					continue;
+				}
+
+				uint8_t value = 0;
+				uint32_t repeat;
+				if (sym == 16)
+				{
+					if (n == 0)
+						return false;
+					value = lengths[n - 1];
+					repeat = 3 + (uint32_t)Bits(2);
+				}
+				else if (sym == 17)
+				{
+					repeat = 3 + (uint32_t)Bits(3);
+				}
+				else
+				{
+					repeat = 11 + (uint32_t)Bits(7);
+				}
+
+				if (n + repeat > hlit + hdist)
+					return false;
+
+				while (repeat--)
+					lengths[n++] = value;
+			}
+
+			if (lengths[256] == 0 || Overrun())
+				return false;
+
+			if (!litLenTable.Build(lengths, hlit) || !distTable.Build(lengths + hlit, hdist))
+				return false;
+
+			return Block(litLenTable, distTable);
+		}
+
+		static const Huffman& GetFixedLitLen()
+		{
+			static const Huffman table = [] {
+				uint8_t lengths[288];
+				std::fill(lengths, lengths + 144, 8);
+				std::fill(lengths + 144, lengths + 256, 9);
+				std::fill(lengths + 256, lengths + 280, 7);
+				std::fill(lengths + 280, lengths + 288, 8);
+				Huffman h;
+				h.Build(lengths, 288);
+				return h;
+			}();
+			return table;
+		}
+
+		static const Huffman& GetFixedDist()
+		{
+			static const Huffman table = [] {
+				uint8_t lengths[30];
+				std::fill(lengths, lengths + 30, 5);
+				Huffman h;
+				h.Build(lengths, 30);
+				return h;
+			}();
+			return table;
+		}
+
+		const uint8_t* in = nullptr;
+		const uint8_t* inEnd = nullptr;
+		uint64_t bitBuffer = 0;
+		uint32_t bitCount = 0;
+		size_t overrun = 0;  // zero bytes fed past the end of the input
+		uint64_t produced = 0;
+		size_t pos = 0;
+		const Sink* sink = nullptr;
+		std::vector<uint8_t> output;
+		Huffman litLenTable;
+		Huffman distTable;
+	};
+}
+
+export namespace Zip {
+
+	uint32_t Crc32(uint32_t crc, const void* data, size_t size)
+	{
+		const uint8_t* p = (const uint8_t*)data;
+		crc = ~crc;
+
+		while (size >= 8)
+		{
+			uint32_t lo = Read32(p) ^ crc;
+			uint32_t hi = Read32(p + 4);
+			crc = c_Crc.t[7][lo & 0xFF] ^ c_Crc.t[6][(lo >> 8) & 0xFF] ^ c_Crc.t[5][(lo >> 16) & 0xFF] ^ c_Crc.t[4][lo >> 24] ^
+				c_Crc.t[3][hi & 0xFF] ^ c_Crc.t[2][(hi >> 8) & 0xFF] ^ c_Crc.t[1][(hi >> 16) & 0xFF] ^ c_Crc.t[0][hi >> 24];
+			p += 8;
+			size -= 8;
+		}
+
+		while (size--)
+			crc = c_Crc.t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+		return ~crc;
+	}
+
+	// Decodes a single member gzip stream (RFC 1952), as used by HTTP content encoding. The trailer's
+	// CRC32 and size are checked.
+	bool Gunzip(const uint8_t* src, size_t srcSize, std::string& out)
+	{
+		enum Flags : uint8_t { FTEXT = 1, FHCRC = 2, FEXTRA = 4, FNAME = 8, FCOMMENT = 16 };
+
+		out.clear();
+		if (srcSize < 18 || src[0] != 0x1F || src[1] != 0x8B || src[2] != 8)
+			return false;
+
+		uint8_t flags = src[3];
+		size_t offset = 10;
+		size_t end = srcSize - 8;
+
+		if (flags & FEXTRA)
+		{
+			if (offset + 2 > end)
+				return false;
+			offset += 2 + Read16(src + offset);
+		}
+
+		for (uint8_t f : { FNAME, FCOMMENT })
+		{
+			if (!(flags & f))
+				continue;
+
+			while (offset < end && src[offset] != 0)
+				offset++;
+			offset++;
+		}
+
+		if (flags & FHCRC)
+			offset += 2;
+
+		if (offset > end)
+			return false;
+
+		uint32_t crc = 0;
+		auto append = [&](const uint8_t* p, size_t n) {
+			crc = Crc32(crc, p, n);
+			out.append((const char*)p, n);
+			return true;
+		};
+
+		static thread_local Inflater inflater;
+		if (!inflater.Inflate(src + offset, end - offset, append))
+			return false;
+
+		return crc == Read32(src + end) && (uint32_t)out.size() == Read32(src + end + 4);
+	}
+
+	enum class Method : uint16_t
+	{
+		Stored = 0,
+		Deflate = 8,
+	};
+
+	struct Entry
+	{
+		std::string name; // as stored, '/' separated
+		uint64_t compressedSize = 0;
+		uint64_t size = 0;
+		uint64_t localHeaderOffset = 0;
+		uint32_t crc = 0;
+		Method method = Method::Stored;
+		bool directory = false;
+	};
+
+	// Mapped zip archive, only the central directory is parsed up front.
+	class Archive
+	{
+	public:
+		bool Open(const std::filesystem::path& path)
+		{
+			entries.clear();
+			if (!file.Open(path))
+				return false;
+
+			const uint8_t* data = file.Data();
+			size_t size = file.Size();
+			if (size < 22)
+				return false;
+
+			// end of central directory, followed by up to 64 KiB of comment
+			size_t eocd = std::string::npos;
+			for (size_t i = size - 22 + 1; i-- > 0 && size - i <= 22 + 0xFFFF;)
+			{
+				if (Read32(data + i) == 0x06054b50)
+				{
+					eocd = i;
+					break;
+				}
+			}
+
+			if (eocd == std::string::npos)
+				return false;
+
+			uint64_t count = Read16(data + eocd + 10);
+			uint64_t cdSize = Read32(data + eocd + 12);
+			uint64_t cdOffset = Read32(data + eocd + 16);
+
+			// zip64 locator sits right before the classic record
+			if (eocd >= 20 && Read32(data + eocd - 20) == 0x07064b50)
+			{
+				uint64_t zip64 = Read64(data + eocd - 20 + 8);
+				if (zip64 + 56 > size || Read32(data + zip64) != 0x06064b50)
+					return false;
+
+				count = Read64(data + zip64 + 32);
+				cdSize = Read64(data + zip64 + 40);
+				cdOffset = Read64(data + zip64 + 48);
+			}
+
+			if (cdOffset > size || cdSize > size - cdOffset)
+				return false;
+
+			entries.reserve((size_t)std::min<uint64_t>(count, cdSize / 46));
+
+			const uint8_t* p = data + cdOffset;
+			const uint8_t* end = p + cdSize;
+			for (uint64_t i = 0; i < count; i++)
+			{
+				if (end - p < 46 || Read32(p) != 0x02014b50)
+					return false;
+
+				uint16_t nameSize = Read16(p + 28);
+				uint16_t extraSize = Read16(p + 30);
+				uint16_t commentSize = Read16(p + 32);
+				if ((size_t)(end - p) < 46u + nameSize + extraSize + commentSize)
+					return false;
+
+				Entry e;
+				e.method = (Method)Read16(p + 10);
+				e.crc = Read32(p + 16);
+				e.compressedSize = Read32(p + 20);
+				e.size = Read32(p + 24);
+				e.localHeaderOffset = Read32(p + 42);
+				e.name.assign((const char*)p + 46, nameSize);
+				e.directory = e.name.ends_with('/');
+
+				// zip64 extended information, fields only present when the classic one is saturated
+				const uint8_t* extra = p + 46 + nameSize;
+				const uint8_t* extraEnd = extra + extraSize;
+				while (extraEnd - extra >= 4)
+				{
+					uint16_t id = Read16(extra);
+					uint16_t len = Read16(extra + 2);
+					const uint8_t* field = extra + 4;
+					if (extraEnd - field < len)
+						break;
+
+					if (id == 0x0001)
+					{
+						const uint8_t* f = field;
+						auto take = [&](uint64_t& v) {
+							if (field + len - f >= 8)
+							{
+								v = Read64(f);
+								f += 8;
+							}
+						};
+
+						if (e.size == 0xFFFFFFFF) take(e.size);
+						if (e.compressedSize == 0xFFFFFFFF) take(e.compressedSize);
+						if (e.localHeaderOffset == 0xFFFFFFFF) take(e.localHeaderOffset);
+					}
+
+					extra = field + len;
+				}
+
+				entries.push_back(std::move(e));
+				p += 46 + nameSize + extraSize + commentSize;
+			}
+
+			return true;
+		}
+
+		const std::vector<Entry>& GetEntries() const { return entries; }
+
+		// compressed bytes of an entry, empty if the local header is out of bounds
+		std::span<const uint8_t> GetData(const Entry& e) const
+		{
+			const uint8_t* data = file.Data();
+			size_t size = file.Size();
+			if (e.localHeaderOffset > size || size - e.localHeaderOffset < 30 || Read32(data + e.localHeaderOffset) != 0x04034b50)
+				return {};
+
+			uint64_t offset = e.localHeaderOffset + 30 + Read16(data + e.localHeaderOffset + 26) + Read16(data + e.localHeaderOffset + 28);
+			if (offset > size || e.compressedSize > size - offset)
+				return {};
+
+			return { data + offset, (size_t)e.compressedSize };
+		}
+
+		// decompresses an entry into sink, verifying its CRC
+		bool Read(const Entry& e, const std::function<bool(const uint8_t*, size_t)>& sink) const
+		{
+			auto data = GetData(e);
+			if (data.data() == nullptr && e.compressedSize > 0)
+				return false;
+
+			uint32_t crc = 0;
+			uint64_t written = 0;
+			auto check = [&](const uint8_t* p, size_t n) {
+				crc = Crc32(crc, p, n);
+				written += n;
+				return sink(p, n);
+			};
+
+			bool ok = false;
+			switch (e.method)
+			{
+			case Method::Stored:
+				ok = e.compressedSize == e.size && check(data.data(), data.size());
+				break;
+			case Method::Deflate:
+			{
+				static thread_local Inflater inflater;
+				ok = inflater.Inflate(data.data(), data.size(), check);
+				break;
+			}
+			default:
+				HE_ERROR("Zip : unsupported compression method {} for {}", (uint16_t)e.method, e.name);
+				return false;
+			}
+
+			return ok && written == e.size && crc == e.crc;
+		}
+
+	private:
+		Utils::MappedFile file;
+		std::vector<Entry> entries;
+	};
+
+	struct ArchiveProgress
+	{
+		std::filesystem::path archive;
+		uint64_t completedBytes = 0;
+		uint64_t totalBytes = 0;
+		uint32_t completedEntries = 0;
+		uint32_t totalEntries = 0;
+	};
+
+	// archive is the one the finished entry belongs to, overall sums every archive
+	using ProgressCallback = std::function<void(const ArchiveProgress& archive, const ArchiveProgress& overall)>;
+
+	// Extracts several archives at once into outputDir. All entries of all archives share one worker pool,
+	// largest first, of workerCount workers or the copy engine's default. onProgress is called under a lock after
+	// every entry.
+	bool Extract(const std::vector<std::filesystem::path>& archives, const std::filesystem::path& outputDir, const ProgressCallback& onProgress = {}, uint32_t workerCount = 0)
+	{
+		HE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::unique_ptr<Archive>> opened(archives.size());
+		std::vector<ArchiveProgress> progress(archives.size());
+		ArchiveProgress overall;
+		std::mutex progressMutex;
+		bool ok = true;
+
+		CopyEngine::Queue queue;
+
+		for (size_t a = 0; a < archives.size(); a++)
+		{
+			opened[a] = std::make_unique<Archive>();
+			progress[a].archive = archives[a];
+
+			if (!opened[a]->Open(archives[a]))
+			{
+				HE_ERROR("Zip : unable to read {}", archives[a].string());
+				ok = false;
+				continue;
+			}
+
+			for (const auto& e : opened[a]->GetEntries())
+			{
+				auto relative = std::filesystem::path(e.name).lexically_normal();
+				if (relative.is_absolute() || relative.has_root_name() || (!relative.empty() && *relative.begin() == ".."))
+				{
+					HE_ERROR("Zip : {} escapes the output directory", e.name);
+					ok = false;
+					continue;
+				}
+
+				auto dst = outputDir / relative;
+				if (e.directory)
+				{
+					queue.directories.push_back(dst);
+					continue;
+				}
+
+				progress[a].totalBytes += e.size;
+				progress[a].totalEntries++;
+				overall.totalBytes += e.size;
+				overall.totalEntries++;
+
+				queue.Add(archives[a], dst, e.size, [&, a, entry = &e](const CopyEngine::Job& job) {
+					bool entryOk;
+					{
+						std::ofstream out(job.dst, std::ios::binary | std::ios::trunc);
+						entryOk = out.is_open() && opened[a]->Read(*entry, [&out](const uint8_t* p, size_t n) {
+							out.write((const char*)p, n);
+							return out.good();
+						});
+					}
+
+					if (!entryOk)
+						HE_ERROR("Zip : failed to extract {} from {}", entry->name, job.src.string());
+
+					std::lock_guard lock(progressMutex);
+					progress[a].completedBytes += entry->size;
+					progress[a].completedEntries++;
+					overall.completedBytes += entry->size;
+					overall.completedEntries++;
+					if (onProgress)
+						onProgress(progress[a], overall);
+
+					return entryOk;
+				});
+			}
+		}
+
+		ok = queue.Run(nullptr, workerCount) && ok;
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		HE_INFO("Zip : extracted {} archives ({}) in {:.3f}s", archives.size(), Utils::FormatBytes(overall.totalBytes), seconds);
+
+		return ok;
+	}
+}
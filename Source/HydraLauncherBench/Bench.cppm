@@ -0,0 +1,190 @@
+module;
+
+#include "HydraEngine/Base.h"
+
+export module Bench;
+
+import HE;
+import std;
+import Json;
+
+// Repeated timings of one operation each and their JSON report, comparable between commits :
+//
+//   {"schema" : 1, "meta" : {...}, "results" : [{"name" : "db.serialize", "ok" : true, "ms" : {"min" : ...}, ...}]}
+
+// Internal
+namespace Bench {
+
+	using Clock = std::chrono::steady_clock;
+
+	double Percentile(const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty())
+			return 0.0;
+
+		double rank = p * (sorted.size() - 1);
+		size_t lo = (size_t)rank;
+		size_t hi = std::min(lo + 1, sorted.size() - 1);
+		return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+	}
+}
+
+export namespace Bench {
+
+	struct Result
+	{
+		std::string name;
+		bool ok = true;
+		std::string error;
+		std::vector<double> samples; // milliseconds
+		std::vector<std::pair<std::string, double>> counters; // sizes and rates, the same on every run
+
+		void Fail(std::string_view text)
+		{
+			ok = false;
+			error = text;
+			HE_ERROR("Bench : {} failed, {}", name, text);
+		}
+
+		void Counter(std::string_view key, double value) { counters.emplace_back(key, value); }
+	};
+
+	class Report
+	{
+	public:
+		Report(std::string filter, uint32_t repetitions) : filter(std::move(filter)), repetitions(std::max(repetitions, 1u)) {}
+
+		// names are matched on a substring, "db." runs every database benchmark
+		bool Enabled(std::string_view name) const { return filter.empty() || name.find(filter) != std::string_view::npos; }
+
+		// Times fn `repetitions` times after one untimed warm up run, setup runs untimed before each of them.
+		// Either returning false fails the benchmark. Null when the filter skips it.
+		Result* Run(std::string_view name, const std::function<bool()>& setup, const std::function<bool()>& fn)
+		{
+			if (!Enabled(name))
+				return nullptr;
+
+			Result& result = Add(name);
+			HE_INFO("Bench : {}", name);
+
+			for (uint32_t i = 0; i <= repetitions; i++)
+			{
+				if (setup && !setup())
+				{
+					result.Fail("setup");
+					break;
+				}
+
+				auto start = Clock::now();
+				bool ok = fn();
+				auto end = Clock::now();
+
+				if (!ok)
+				{
+					result.Fail("run");
+					break;
+				}
+
+				if (i > 0)
+					result.samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+
+			return &result;
+		}
+
+		// samples taken by the caller, frames for example
+		Result& Add(std::string_view name)
+		{
+			auto& result = results.emplace_back();
+			result.name = name;
+			return result;
+		}
+
+		void Meta(std::string_view key, std::string_view value) { meta.emplace_back(key, value); }
+
+		bool Failed() const { return std::any_of(results.begin(), results.end(), [](const Result& r) { return !r.ok; }); }
+
+		std::string ToJson() const
+		{
+			Json::Writer out;
+			out.BeginObject();
+			out.Member("schema", 1);
+
+			out.Key("meta");
+			out.BeginObject();
+			for (const auto& [key, value] : meta)
+			{
+				out.Key(key);
+				out.String(value);
+			}
+			out.EndObject();
+
+			out.Key("results");
+			out.BeginArray();
+			for (const auto& r : results)
+			{
+				out.BeginObject();
+				out.Member("name", r.name);
+				out.Member("ok", r.ok);
+				if (!r.ok)
+					out.Member("error", r.error);
+
+				out.Member("samples", (uint64_t)r.samples.size());
+				if (!r.samples.empty())
+				{
+					auto sorted = r.samples;
+					std::sort(sorted.begin(), sorted.end());
+
+					double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+					double variance = 0.0;
+					for (double s : sorted)
+						variance += (s - mean) * (s - mean);
+
+					out.Key("ms");
+					out.BeginObject();
+					out.Member("min", sorted.front());
+					out.Member("median", Percentile(sorted, 0.5));
+					out.Member("mean", mean);
+					out.Member("p95", Percentile(sorted, 0.95));
+					out.Member("max", sorted.back());
+					out.Member("stddev", std::sqrt(variance / sorted.size()));
+					out.EndObject();
+				}
+
+				out.Key("counters");
+				out.BeginObject();
+				for (const auto& [key, value] : r.counters)
+					out.Member(key, value);
+				out.EndObject();
+
+				out.EndObject();
+			}
+			out.EndArray();
+
+			out.EndObject();
+			return out.GetString();
+		}
+
+		void Print() const
+		{
+			for (const auto& r : results)
+			{
+				if (!r.ok || r.samples.empty())
+				{
+					HE_INFO("{:<28} {}", r.name, r.ok ? "no samples" : r.error);
+					continue;
+				}
+
+				auto sorted = r.samples;
+				std::sort(sorted.begin(), sorted.end());
+				HE_INFO("{:<28} median {:>10.3f} ms   min {:>10.3f} ms   p95 {:>10.3f} ms", r.name, Percentile(sorted, 0.5), sorted.front(), Percentile(sorted, 0.95));
+			}
+		}
+
+	private:
+		std::string filter;
+		uint32_t repetitions;
+		std::deque<Result> results; // Run hands out pointers
+		std::vector<std::pair<std::string, std::string>> meta;
+	};
+}
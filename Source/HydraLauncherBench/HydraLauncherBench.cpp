@@ -0,0 +1,473 @@
+#include "HydraLauncher/HydraLauncher.cpp"
+
+import Bench;
+import Fixtures;
+
+// Times the launcher's hot paths on generated inputs and writes the results as JSON, to compare commits :
+//
+//   HydraLauncherBench [--out bench.json] [--filter <name part>] [--repetitions 10] [--projects 10000]
+//                      [--catalog 5000] [--frames 300] [--work <dir>] [--commit <id>] [--no-ui] [--keep]
+//
+// Fixtures are generated under --work, a temporary directory by default, and deleted afterwards unless --keep.
+// The launcher runs on a scratch app data directory there, the user's own db.json is never read or written.
+// ui.projects.frame opens the launcher window on the Projects page and times its OnUpdate.
+
+struct BenchOptions
+{
+    std::filesystem::path out = "bench.json";
+    std::filesystem::path work;
+    std::string filter;
+    std::string commit;
+    uint32_t repetitions = 10;
+    uint32_t projects = 10000;
+    uint32_t catalogEntries = 5000;
+    uint32_t frames = 300;
+    bool ui = true;
+    bool keep = false;
+};
+
+constexpr uint32_t c_WarmupFrames = 30;
+constexpr const char* c_UnreachableRemoteInfoURL = "http://127.0.0.1:9/remoteInfo.json";
+
+static bool ParseBenchOptions(ApplicationCommandLineArgs args, BenchOptions& options)
+{
+    for (int i = 1; i < args.count; i++)
+    {
+        std::string_view arg = args[i];
+        if (arg == "--no-ui")
+        {
+            options.ui = false;
+            continue;
+        }
+
+        if (arg == "--keep")
+        {
+            options.keep = true;
+            continue;
+        }
+
+        if (i + 1 >= args.count)
+        {
+            HE_ERROR("Bench : missing value for {}", arg);
+            return false;
+        }
+
+        std::string_view value = args[++i];
+        auto number = [&](uint32_t& out) {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+            return ec == std::errc() && ptr == value.data() + value.size();
+        };
+
+        bool ok = true;
+        if (arg == "--out")              options.out = value;
+        else if (arg == "--work")        options.work = value;
+        else if (arg == "--filter")      options.filter = value;
+        else if (arg == "--commit")      options.commit = value;
+        else if (arg == "--repetitions") ok = number(options.repetitions);
+        else if (arg == "--projects")    ok = number(options.projects);
+        else if (arg == "--catalog")     ok = number(options.catalogEntries);
+        else if (arg == "--frames")      ok = number(options.frames);
+        else                             ok = false;
+
+        if (!ok)
+        {
+            HE_ERROR("Bench : invalid argument {} {}", arg, value);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void SetEnv(const char* name, const char* value)
+{
+#ifdef HE_PLATFORM_WINDOWS
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+#pragma region Benchmarks
+
+// db.json with the projects' .hproject files, loaded and written back the way the launcher does at startup
+// and on every change
+static void RunDatabaseBenches(Bench::Report& report, const BenchOptions& options)
+{
+    if (!report.Enabled("db."))
+        return;
+
+    auto dir = options.work / "db";
+    Fixtures::DatabaseDesc desc;
+    desc.projects = options.projects;
+    if (!Fixtures::WriteDatabase(dir / "AppData" / "db.json", dir / "Projects", desc))
+        return report.Add("db").Fail("fixtures");
+
+    HydraLauncher launcher;
+    launcher.headless = true;
+    launcher.databaseFilePath = std::filesystem::absolute(dir / "AppData" / "db.json");
+
+    auto reset = [&]() {
+        launcher.instances.clear();
+        launcher.projects.clear();
+        return true;
+    };
+
+    if (auto r = report.Run("db.deserialize", reset, [&]() { launcher.Deserialize(); return launcher.projects.size() == options.projects; }))
+        r->Counter("projects", options.projects);
+
+    if (launcher.projects.size() != options.projects)
+    {
+        reset();
+        launcher.Deserialize();
+    }
+
+    size_t bytes = 0;
+    if (auto r = report.Run("db.serialize", {}, [&]() { bytes = launcher.SerializeDatabase().size(); return bytes > 0; }))
+    {
+        r->Counter("projects", options.projects);
+        r->Counter("bytes", (double)bytes);
+    }
+}
+
+// catalog pages merged into the plugin and template tables, first into empty ones then as an update of every
+// entry, and the cached index as restored at startup
+static void RunCatalogBenches(Bench::Report& report, const BenchOptions& options)
+{
+    if (!report.Enabled("catalog."))
+        return;
+
+    const uint32_t count = options.catalogEntries;
+    const auto fresh = Fixtures::MakeCatalogPage(count, "Entry", 1);
+    const auto update = Fixtures::MakeCatalogPage(count, "Entry", 2);
+
+    HydraLauncher launcher;
+    launcher.headless = true;
+
+    Catalog::Page page;
+    auto merged = [&]() { return launcher.plugins.size() == count && launcher.templates.size() == count; };
+    auto clear = [&]() {
+        launcher.plugins.clear();
+        launcher.templates.clear();
+    };
+
+    if (auto r = report.Run("catalog.merge.fresh", [&]() { clear(); page = fresh; return true; }, [&]() { launcher.MergeCatalogPage(page); return merged(); }))
+        r->Counter("entries", 2.0 * count);
+
+    auto updateSetup = [&]() {
+        if (!merged())
+        {
+            clear();
+            page = fresh;
+            launcher.MergeCatalogPage(page);
+        }
+
+        page = update;
+        return true;
+    };
+
+    if (auto r = report.Run("catalog.merge.update", updateSetup, [&]() { launcher.MergeCatalogPage(page); return merged(); }))
+        r->Counter("entries", 2.0 * count);
+
+    auto indexPath = options.work / "catalog" / "catalog.hcat";
+    if (report.Enabled("catalog.index.load"))
+    {
+        std::filesystem::create_directories(indexPath.parent_path());
+
+        Catalog::Index index;
+        auto copy = fresh;
+        index.Apply(copy);
+        if (!index.Save(indexPath))
+            return report.Add("catalog.index.load").Fail("fixtures");
+    }
+
+    auto load = [&]() {
+        Catalog::Index index;
+        if (!index.Load(indexPath))
+            return false;
+
+        launcher.MergeCatalogIndex(index);
+        return merged();
+    };
+
+    if (auto r = report.Run("catalog.index.load", [&]() { clear(); return true; }, load))
+        r->Counter("entries", 2.0 * count);
+}
+
+// a template sized tree staged into a project's output, from scratch and again with nothing changed
+static void RunStagingBenches(Bench::Report& report, const BenchOptions& options)
+{
+    if (!report.Enabled("staging."))
+        return;
+
+    auto dir = options.work / "staging";
+    Fixtures::TreeDesc desc;
+    desc.files = 2000;
+    desc.directories = 40;
+    uint64_t bytes = Fixtures::WriteTree(dir / "src", desc);
+    if (bytes == 0)
+        return report.Add("staging").Fail("fixtures");
+
+    Staging::Plan plan;
+    plan.AddDirectory(dir / "src", "Resources");
+
+    auto stage = [&](Staging::Strategy strategy, const std::filesystem::path& out, bool warm) {
+        auto summary = Staging::Stage(plan, out, strategy);
+        uint32_t done = warm ? summary.skippedFiles : summary.copiedFiles + summary.linkedFiles;
+        return summary.failedFiles == 0 && done == desc.files;
+    };
+
+    auto clean = [](const std::filesystem::path& path) {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+        return !ec;
+    };
+
+    auto counters = [&](Bench::Result* r) {
+        if (!r)
+            return;
+
+        r->Counter("files", desc.files);
+        r->Counter("bytes", (double)bytes);
+    };
+
+    counters(report.Run("staging.copy.cold", [&]() { return clean(dir / "copy"); }, [&]() { return stage(Staging::Strategy::Copy, dir / "copy", false); }));
+    counters(report.Run("staging.copy.warm", [&]() { return std::filesystem::exists(dir / "copy") || stage(Staging::Strategy::Copy, dir / "copy", false); }, [&]() { return stage(Staging::Strategy::Copy, dir / "copy", true); }));
+    counters(report.Run("staging.hardlink.cold", [&]() { return clean(dir / "link"); }, [&]() { return stage(Staging::Strategy::HardLink, dir / "link", false); }));
+}
+
+// a library archive of mixed text and binary members, as the LibStore unpacks them
+static void RunZipBenches(Bench::Report& report, const BenchOptions& options)
+{
+    if (!report.Enabled("zip."))
+        return;
+
+    auto dir = options.work / "zip";
+    Fixtures::Rng rng{ 7 };
+    std::vector<Fixtures::File> files(500);
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        bool text = rng.Range(0, 4) != 0;
+        files[i].name = std::format("lib/dir{}/file{}.{}", i % 16, i, text ? "h" : "bin");
+        files[i].content = Fixtures::MakeContent(rng, rng.LogRange(512, 1024 * 1024), text);
+        bytes += files[i].content.size();
+    }
+
+    auto archive = Fixtures::MakeZip(files);
+    if (!Fixtures::WriteFile(dir / "lib.zip", archive))
+        return report.Add("zip.extract").Fail("fixtures");
+
+    auto clean = [&]() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir / "out", ec);
+        return !ec;
+    };
+
+    if (auto r = report.Run("zip.extract", clean, [&]() { return Zip::Extract({ dir / "lib.zip" }, dir / "out"); }))
+    {
+        r->Counter("entries", (double)files.size());
+        r->Counter("bytes", (double)bytes);
+        r->Counter("compressedBytes", (double)archive.size());
+    }
+}
+
+// a recursive clone of a repository with two levels of submodules over file://, the network left out
+static void RunGitBenches(Bench::Report& report, const BenchOptions& options)
+{
+    if (!report.Enabled("git."))
+        return;
+
+    auto dir = options.work / "git";
+    Fixtures::RepoTreeDesc desc;
+    desc.depth = 2;
+    desc.submodules = 3;
+    desc.files = 50;
+
+    auto url = Fixtures::CreateRepoTree(dir / "remote", "Engine", desc);
+    if (url.empty())
+        return report.Add("git.clone.file").Fail("fixtures");
+
+    auto clone = dir / "clone";
+    auto clean = [&]() {
+        std::error_code ec;
+        std::filesystem::remove_all(clone, ec);
+        return !ec;
+    };
+
+    auto run = [&]() {
+        Git::ProgressInfo progress = {};
+        return Git::RecursiveClone(url.c_str(), clone.string().c_str(), progress) == Git::CloneState::Completed;
+    };
+
+    if (auto r = report.Run("git.clone.file", clean, run))
+    {
+        uint32_t repositories = 1 + desc.submodules + desc.submodules * desc.submodules;
+        r->Counter("repositories", repositories);
+        r->Counter("files", (double)repositories * desc.files);
+    }
+}
+
+#pragma endregion
+
+static bool WriteReport(Bench::Report& report, const BenchOptions& options)
+{
+    report.Print();
+
+    if (!Utils::WriteFileAtomic(options.out, report.ToJson()))
+    {
+        HE_ERROR("Unable to open file for writing, {}", options.out.string());
+        return false;
+    }
+
+    HE_INFO("Bench : results written to {}", std::filesystem::absolute(options.out).string());
+    return !report.Failed();
+}
+
+static void RemoveWork(const BenchOptions& options)
+{
+    if (options.keep)
+        return;
+
+    std::error_code ec;
+    std::filesystem::remove_all(options.work, ec);
+}
+
+// The launcher on a scratch app data directory holding the db.json fixture, times OnUpdate on the Projects page
+// and closes the window once enough frames are in.
+class BenchLauncher : public HydraLauncher
+{
+public:
+    BenchLauncher(Bench::Report&& report, const BenchOptions& options) : report(std::move(report)), options(options)
+    {
+        appData = options.work / "AppData";
+        result = &this->report.Add("ui.projects.frame");
+        result->Counter("projects", options.projects);
+    }
+
+    virtual void OnUpdate(const FrameInfo& info) override
+    {
+        // the db.json fixture already opens on it, it is forced in case the engine restored another page
+        selectedPage = Page::Projects;
+
+        auto start = std::chrono::steady_clock::now();
+        HydraLauncher::OnUpdate(info);
+        auto end = std::chrono::steady_clock::now();
+
+        if (done)
+            return;
+
+        if (frame++ >= c_WarmupFrames)
+            result->samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+        if (result->samples.size() >= options.frames)
+        {
+            done = true;
+            WriteReport(report, options);
+            Application::Shutdown();
+        }
+    }
+
+    virtual void OnDetach() override
+    {
+        HydraLauncher::OnDetach();
+
+        if (!done)
+        {
+            result->Fail("closed before the last frame");
+            WriteReport(report, options);
+        }
+
+        RemoveWork(options);
+    }
+
+    Bench::Report report;
+    BenchOptions options;
+    Bench::Result* result = nullptr;
+    uint32_t frame = 0;
+    bool done = false;
+};
+
+HE::ApplicationContext* HE::CreateApplication(ApplicationCommandLineArgs args)
+{
+    HE_PROFILE_FUNCTION();
+
+    BenchOptions options;
+    if (!ParseBenchOptions(args, options))
+        std::exit(ExitCode::Usage);
+
+    if (options.work.empty())
+        options.work = std::filesystem::temp_directory_path() / std::format("HydraLauncherBench-{}", std::chrono::system_clock::now().time_since_epoch().count());
+
+    options.work = std::filesystem::absolute(options.work).lexically_normal();
+    std::filesystem::create_directories(options.work);
+
+    Git::Init();
+
+    if (options.commit.empty())
+        options.commit = Git::GetCurrentCommitId(std::filesystem::current_path(), 40);
+
+    Bench::Report report(options.filter, options.repetitions);
+    report.Meta("commit", options.commit);
+    report.Meta("timestamp", std::format("{:%FT%TZ}", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now())));
+#ifdef HE_DEBUG
+    report.Meta("build", "Debug");
+#else
+    report.Meta("build", "Optimized");
+#endif
+    report.Meta("repetitions", std::to_string(options.repetitions));
+    report.Meta("projects", std::to_string(options.projects));
+    report.Meta("catalogEntries", std::to_string(options.catalogEntries));
+
+    RunDatabaseBenches(report, options);
+    RunCatalogBenches(report, options);
+    RunStagingBenches(report, options);
+    RunZipBenches(report, options);
+    RunGitBenches(report, options);
+
+    Git::Shutdown();
+
+    if (!options.ui || !report.Enabled("ui.projects.frame"))
+    {
+        bool ok = WriteReport(report, options);
+        RemoveWork(options);
+        std::exit(ok ? ExitCode::Ok : ExitCode::Failed);
+    }
+
+    Fixtures::DatabaseDesc database;
+    database.projects = options.projects;
+    if (!Fixtures::WriteDatabase(options.work / "AppData" / "db.json", options.work / "Projects", database))
+    {
+        report.Add("ui.projects.frame").Fail("fixtures");
+        WriteReport(report, options);
+        RemoveWork(options);
+        std::exit(ExitCode::Failed);
+    }
+
+    // the catalog sync fails at once instead of reaching the server on every run
+    SetEnv("HYDRA_REMOTE_INFO_URL", c_UnreachableRemoteInfoURL);
+
+    ApplicationDesc desc;
+    desc.deviceDesc.api = {
+        nvrhi::GraphicsAPI::D3D11,
+        nvrhi::GraphicsAPI::D3D12,
+        nvrhi::GraphicsAPI::VULKAN,
+    };
+
+    auto log = (options.work / "HydraLauncherBench").string();
+
+    desc.windowDesc.swapChainDesc.swapChainFormat = nvrhi::Format::SRGBA8_UNORM;
+    desc.windowDesc.customTitlebar = true;
+    desc.windowDesc.iconFilePath = c_AppIconPath;
+    desc.windowDesc.title = "HydraLauncherBench";
+    desc.windowDesc.minWidth = 960;
+    desc.windowDesc.minHeight = 540;
+    desc.logFile = log.c_str();
+
+    ApplicationContext* ctx = new ApplicationContext(desc);
+    Application::PushLayer(new BenchLauncher(std::move(report), options));
+
+    return ctx;
+}
+
+#include "HydraEngine/EntryPoint.h"
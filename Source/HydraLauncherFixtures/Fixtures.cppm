@@ -0,0 +1,711 @@
+module;
+
+#include "HydraEngine/Base.h"
+#include "git2.h"
+
+export module Fixtures;
+
+import HE;
+import std;
+import Json;
+import Zip;
+import Catalog;
+
+// Synthetic inputs for the launcher benchmarks. Everything derives from a seed through Rng, so the same
+// seed gives the same bytes, file names and git object ids on every machine.
+
+// Internal
+namespace Fixtures {
+
+	constexpr const char* c_Words[] = {
+		"void", "const", "return", "struct", "template", "namespace", "include", "auto", "uint32_t", "std::vector",
+		"if", "else", "for", "while", "nullptr", "true", "false", "float", "size_t", "static", "inline", "class",
+		"public", "private", "Texture", "Buffer", "Device", "Shader", "Mesh", "Material", "Scene", "Entity",
+	};
+
+	class BitWriter
+	{
+	public:
+		// least significant bit first, as deflate packs everything but Huffman codes
+		void Put(uint32_t bits, uint32_t count)
+		{
+			acc |= (uint64_t)bits << used;
+			used += count;
+			while (used >= 8)
+			{
+				out += (char)(acc & 0xFF);
+				acc >>= 8;
+				used -= 8;
+			}
+		}
+
+		// Huffman codes are packed most significant bit first
+		void PutCode(uint32_t code, uint32_t length)
+		{
+			uint32_t reversed = 0;
+			for (uint32_t i = 0; i < length; i++, code >>= 1)
+				reversed = (reversed << 1) | (code & 1);
+
+			Put(reversed, length);
+		}
+
+		std::string Finish()
+		{
+			if (used > 0)
+				out += (char)(acc & 0xFF);
+
+			acc = 0;
+			used = 0;
+			return std::move(out);
+		}
+
+	private:
+		uint64_t acc = 0;
+		uint32_t used = 0;
+		std::string out;
+	};
+
+	constexpr uint16_t c_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr uint8_t c_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr uint16_t c_DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr uint8_t c_DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// fixed literal/length codes of RFC 1951 3.2.6
+	void PutSymbol(BitWriter& w, uint32_t symbol)
+	{
+		if (symbol < 144)
+			w.PutCode(0x30 + symbol, 8);
+		else if (symbol < 256)
+			w.PutCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280)
+			w.PutCode(symbol - 256, 7);
+		else
+			w.PutCode(0xC0 + symbol - 280, 8);
+	}
+
+	void PutMatch(BitWriter& w, uint32_t length, uint32_t distance)
+	{
+		uint32_t l = 28;
+		while (c_LengthBase[l] > length)
+			l--;
+
+		PutSymbol(w, 257 + l);
+		w.Put(length - c_LengthBase[l], c_LengthExtra[l]);
+
+		uint32_t d = 29;
+		while (c_DistanceBase[d] > distance)
+			d--;
+
+		w.PutCode(d, 5);
+		w.Put(distance - c_DistanceBase[d], c_DistanceExtra[d]);
+	}
+
+	void Put16(std::string& out, uint16_t v)
+	{
+		out += (char)(v & 0xFF);
+		out += (char)(v >> 8);
+	}
+
+	void Put32(std::string& out, uint32_t v)
+	{
+		Put16(out, (uint16_t)(v & 0xFFFF));
+		Put16(out, (uint16_t)(v >> 16));
+	}
+
+	bool Check(int err, std::string_view what)
+	{
+		if (err == 0)
+			return true;
+
+		const git_error* e = git_error_last();
+		HE_ERROR("Fixtures : {} failed, {}", what, e ? e->message : "no detailed info");
+		return false;
+	}
+}
+
+export namespace Fixtures {
+
+	// splitmix64, no std distribution is involved so sequences match across standard libraries
+	struct Rng
+	{
+		uint64_t state = 1;
+
+		uint64_t Next()
+		{
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// in [lo, hi)
+		uint64_t Range(uint64_t lo, uint64_t hi) { return hi > lo ? lo + Next() % (hi - lo) : lo; }
+
+		// log-uniform in [lo, hi), file sizes are spread that way
+		uint64_t LogRange(uint64_t lo, uint64_t hi)
+		{
+			if (hi <= lo + 1)
+				return lo;
+
+			double t = (double)(Next() >> 11) / (double)(1ull << 53);
+			return std::min(hi - 1, (uint64_t)(lo * std::pow((double)hi / lo, t)));
+		}
+	};
+
+	struct File
+	{
+		std::string name; // '/' separated
+		std::string content;
+	};
+
+	// Source-like text that compresses around 3:1, or random bytes when text is false.
+	std::string MakeContent(Rng& rng, size_t size, bool text = true)
+	{
+		std::string out;
+		out.reserve(size + 32);
+
+		while (out.size() < size)
+		{
+			if (!text)
+			{
+				uint64_t v = rng.Next();
+				out.append((const char*)&v, std::min<size_t>(sizeof(v), size - out.size()));
+				continue;
+			}
+
+			out += c_Words[rng.Range(0, std::size(c_Words))];
+			uint64_t r = rng.Range(0, 16);
+			out += r == 0 ? '\n' : r == 1 ? ';' : ' ';
+			if (r == 2)
+				out += std::to_string(rng.Next() & 0xFFFF);
+		}
+
+		out.resize(size);
+		return out;
+	}
+
+	bool WriteFile(const std::filesystem::path& path, std::string_view content)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(content.data(), (std::streamsize)content.size());
+		return file.good();
+	}
+
+	struct TreeDesc
+	{
+		uint32_t files = 1000;
+		uint32_t directories = 20;
+		uint64_t minSize = 1024;
+		uint64_t maxSize = 64 * 1024;
+		uint64_t seed = 1;
+	};
+
+	// files spread over nested directories under root, returns the bytes written
+	uint64_t WriteTree(const std::filesystem::path& root, const TreeDesc& desc)
+	{
+		HE_PROFILE_FUNCTION();
+
+		Rng rng{ desc.seed };
+
+		std::vector<std::filesystem::path> dirs = { root };
+		for (uint32_t i = 0; i < desc.directories; i++)
+			dirs.push_back(dirs[rng.Range(0, dirs.size())] / std::format("dir{}", i));
+
+		uint64_t bytes = 0;
+		for (uint32_t i = 0; i < desc.files; i++)
+		{
+			auto& dir = dirs[rng.Range(0, dirs.size())];
+			uint64_t size = rng.LogRange(desc.minSize, desc.maxSize);
+			bool text = rng.Range(0, 4) != 0;
+			if (!WriteFile(dir / std::format("file{}.{}", i, text ? "txt" : "bin"), MakeContent(rng, size, text)))
+				return 0;
+
+			bytes += size;
+		}
+
+		return bytes;
+	}
+
+	// Raw deflate stream (RFC 1951) in one fixed Huffman block, from a greedy LZ77 over a 32 KiB window.
+	// Nowhere near zlib's ratio, but it exercises the same inflate paths as real archives.
+	std::string Deflate(std::string_view data)
+	{
+		constexpr uint32_t c_HashBits = 15;
+		constexpr uint32_t c_Window = 32768;
+		constexpr uint32_t c_MaxChain = 16;
+		constexpr uint32_t c_MinMatch = 3;
+		constexpr uint32_t c_MaxMatch = 258;
+
+		const size_t n = data.size();
+		std::vector<int32_t> head(1 << c_HashBits, -1);
+		std::vector<int32_t> prev(c_Window, -1);
+
+		auto hash = [&](size_t i) {
+			uint32_t v = (uint8_t)data[i] | ((uint8_t)data[i + 1] << 8) | ((uint8_t)data[i + 2] << 16);
+			return (v * 2654435761u) >> (32 - c_HashBits);
+		};
+
+		auto insert = [&](size_t i) {
+			if (i + c_MinMatch > n)
+				return;
+
+			auto h = hash(i);
+			prev[i & (c_Window - 1)] = head[h];
+			head[h] = (int32_t)i;
+		};
+
+		BitWriter w;
+		w.Put(1, 1); // final block
+		w.Put(1, 2); // fixed Huffman codes
+
+		size_t i = 0;
+		while (i < n)
+		{
+			uint32_t bestLength = 0;
+			uint32_t bestDistance = 0;
+
+			if (i + c_MinMatch <= n)
+			{
+				size_t max = std::min<size_t>(c_MaxMatch, n - i);
+				int32_t candidate = head[hash(i)];
+				for (uint32_t chain = 0; candidate >= 0 && i - candidate <= c_Window && chain < c_MaxChain; chain++)
+				{
+					uint32_t length = 0;
+					while (length < max && data[candidate + length] == data[i + length])
+						length++;
+
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = (uint32_t)(i - candidate);
+						if (length == max)
+							break;
+					}
+
+					// the ring slot may already hold a newer position
+					int32_t next = prev[candidate & (c_Window - 1)];
+					if (next >= candidate)
+						break;
+
+					candidate = next;
+				}
+			}
+
+			if (bestLength >= c_MinMatch)
+			{
+				PutMatch(w, bestLength, bestDistance);
+				for (uint32_t k = 0; k < bestLength; k++)
+					insert(i + k);
+
+				i += bestLength;
+			}
+			else
+			{
+				PutSymbol(w, (uint8_t)data[i]);
+				insert(i);
+				i++;
+			}
+		}
+
+		PutSymbol(w, 256);
+		return w.Finish();
+	}
+
+	// Zip archive with deflated members, without zip64 so every member and the whole archive stay under 4 GiB.
+	std::string MakeZip(const std::vector<File>& files)
+	{
+		HE_PROFILE_FUNCTION();
+
+		std::string out;
+		std::string central;
+
+		for (const auto& f : files)
+		{
+			auto data = Deflate(f.content);
+			uint32_t crc = Zip::Crc32(0, f.content.data(), f.content.size());
+			uint32_t offset = (uint32_t)out.size();
+
+			Put32(out, 0x04034b50);
+			Put16(out, 20);   // version needed
+			Put16(out, 0);    // flags
+			Put16(out, 8);    // deflate
+			Put32(out, 0);    // time, date
+			Put32(out, crc);
+			Put32(out, (uint32_t)data.size());
+			Put32(out, (uint32_t)f.content.size());
+			Put16(out, (uint16_t)f.name.size());
+			Put16(out, 0);    // extra
+			out += f.name;
+			out += data;
+
+			Put32(central, 0x02014b50);
+			Put16(central, 20); // version made by
+			Put16(central, 20);
+			Put16(central, 0);
+			Put16(central, 8);
+			Put32(central, 0);
+			Put32(central, crc);
+			Put32(central, (uint32_t)data.size());
+			Put32(central, (uint32_t)f.content.size());
+			Put16(central, (uint16_t)f.name.size());
+			Put16(central, 0);  // extra
+			Put16(central, 0);  // comment
+			Put16(central, 0);  // disk
+			Put16(central, 0);  // internal attributes
+			Put32(central, 0);  // external attributes
+			Put32(central, offset);
+			central += f.name;
+		}
+
+		uint32_t centralOffset = (uint32_t)out.size();
+		out += central;
+
+		Put32(out, 0x06054b50);
+		Put16(out, 0);
+		Put16(out, 0);
+		Put16(out, (uint16_t)files.size());
+		Put16(out, (uint16_t)files.size());
+		Put32(out, (uint32_t)central.size());
+		Put32(out, centralOffset);
+		Put16(out, 0);
+
+		return out;
+	}
+
+	struct DatabaseDesc
+	{
+		uint32_t projects = 10000;
+		bool projectFiles = true; // <path>/<name>.hproject, read for every project that exists
+		std::string engineID = "0000000";
+		std::vector<std::filesystem::path> engines;
+	};
+
+	// db.json as the launcher writes it, projects live in projectsDir/Project<i>
+	bool WriteDatabase(const std::filesystem::path& filePath, const std::filesystem::path& projectsDir, const DatabaseDesc& desc)
+	{
+		HE_PROFILE_FUNCTION();
+
+		Json::Writer out;
+		out.BeginObject();
+
+		out.Key("ui");
+		out.BeginObject();
+		out.Member("fontScale", 1.0f);
+		out.Member("selectedPage", 0);
+		out.EndObject();
+
+		out.Key("settings");
+		out.BeginObject();
+		out.EndObject();
+
+		out.Key("engine");
+		out.BeginArray();
+		for (const auto& e : desc.engines)
+		{
+			out.BeginObject();
+			out.Member("path", e);
+			out.Member("state", std::string("Installed"));
+			out.EndObject();
+		}
+		out.EndArray();
+
+		out.Key("projects");
+		out.BeginArray();
+		for (uint32_t i = 0; i < desc.projects; i++)
+		{
+			auto name = std::format("Project{}", i);
+			auto path = std::filesystem::absolute(projectsDir / name).lexically_normal();
+
+			out.BeginObject();
+			out.Member("name", name);
+			out.Member("path", path);
+			out.Member("includSourceCode", false);
+			out.EndObject();
+
+			if (!desc.projectFiles)
+				continue;
+
+			Json::Writer project;
+			project.BeginObject();
+			project.Member("engineID", desc.engineID);
+			project.EndObject();
+			if (!WriteFile(path / std::format("{}.hproject", name), project.GetString()))
+				return false;
+		}
+		out.EndArray();
+
+		out.EndObject();
+		return WriteFile(filePath, out.GetString());
+	}
+
+	// one full catalog page, entry i is named <prefix><i> in both lists
+	Catalog::Page MakeCatalogPage(uint32_t count, std::string_view prefix = "Entry", uint64_t revision = 1)
+	{
+		Catalog::Page page;
+		page.revision = revision;
+		page.plugins.reserve(count);
+		page.templates.reserve(count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			page.plugins.push_back({ std::format("{}Plugin{}", prefix, i), std::format("Plugin {} of the fixture catalog, revision {}", i, revision), std::format("https://example.invalid/plugins/{}{}", prefix, i) });
+			page.templates.push_back({ std::format("{}Template{}", prefix, i), std::format("Template {} of the fixture catalog, revision {}", i, revision), std::format("https://example.invalid/templates/{}{}", prefix, i) });
+		}
+
+		return page;
+	}
+
+	// remoteInfo.json, a single full page
+	bool WriteCatalog(const std::filesystem::path& filePath, const Catalog::Page& page)
+	{
+		Json::Writer out;
+		out.Value(page);
+		return WriteFile(filePath, out.GetString());
+	}
+
+	bool WriteFiles(const std::filesystem::path& dir, const std::vector<File>& files)
+	{
+		for (const auto& f : files)
+		{
+			if (!WriteFile(dir / f.name, f.content))
+				return false;
+		}
+
+		return true;
+	}
+
+	// name, description and URL, the part of .hplugin and config.json the launcher reads
+	std::string MakeInfo(const Catalog::Entry& entry)
+	{
+		Json::Writer out;
+		out.Value(entry);
+		return out.GetString();
+	}
+
+	// <name>.hplugin and its sources
+	std::vector<File> MakePluginFiles(Rng& rng, const Catalog::Entry& entry, uint32_t sources = 4, uint64_t sourceSize = 8 * 1024)
+	{
+		std::vector<File> files;
+		files.push_back({ std::format("{}.hplugin", entry.name), MakeInfo(entry) });
+		files.push_back({ "premake.lua", std::format("project \"{}\"\n    kind \"SharedLib\"\n    files {{ \"Source/**.cpp\" }}\n", entry.name) });
+
+		for (uint32_t i = 0; i < sources; i++)
+			files.push_back({ std::format("Source/{}{}.cpp", entry.name, i), MakeContent(rng, sourceSize) });
+
+		return files;
+	}
+
+	// config.json, a premake.lua and sources holding the PROJECT_NAME token, the entry point Source/<T>/<T>.cpp
+	// and its directory (renamed on instantiation) and `assets` binary assets
+	std::vector<File> MakeTemplateFiles(Rng& rng, const Catalog::Entry& entry, uint32_t assets = 16, uint64_t assetSize = 64 * 1024)
+	{
+		std::vector<File> files;
+		files.push_back({ "config.json", MakeInfo(entry) });
+		files.push_back({ "premake.lua", "workspace \"PROJECT_NAME\"\nproject \"PROJECT_NAME\"\n    kind \"ConsoleApp\"\n    files { \"Source/**.cpp\" }\n" });
+		files.push_back({ std::format("Source/{0}/{0}.cpp", entry.name), std::format("// PROJECT_NAME\n{}", MakeContent(rng, 4 * 1024)) });
+
+		for (uint32_t i = 0; i < assets; i++)
+			files.push_back({ std::format("Assets/asset{}.bin", i), MakeContent(rng, rng.LogRange(assetSize / 4 + 1, assetSize * 2), false) });
+
+		return files;
+	}
+
+	struct LibDesc
+	{
+		uint32_t archives = 4;
+		uint32_t filesPerArchive = 200;
+		uint64_t archiveSize = 64 * 1024 * 1024; // uncompressed, at most 4 GiB as the archives are not zip64
+		uint64_t seed = 1;
+	};
+
+	// Lib<i>.zip archives as the root of a ThirdParty/Lib repository holds them, each one extracts to Lib<i>/
+	// with headers and binaries.
+	std::vector<File> MakeLibArchives(const LibDesc& desc)
+	{
+		Rng rng{ desc.seed };
+		uint32_t count = std::max(desc.filesPerArchive, 1u);
+		uint64_t fileSize = std::max<uint64_t>(desc.archiveSize / count, 1);
+
+		std::vector<File> archives;
+		for (uint32_t a = 0; a < desc.archives; a++)
+		{
+			std::vector<File> files(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				bool header = i % 4 != 0;
+				files[i].name = header ? std::format("Lib{}/include/header{}.h", a, i) : std::format("Lib{}/bin/lib{}.bin", a, i);
+				files[i].content = MakeContent(rng, fileSize, header);
+			}
+
+			archives.push_back({ std::format("Lib{}.zip", a), MakeZip(files) });
+		}
+
+		return archives;
+	}
+
+	std::string ToFileUrl(const std::filesystem::path& path)
+	{
+		auto str = std::filesystem::absolute(path).lexically_normal().generic_string();
+		return str.starts_with('/') ? "file://" + str : "file:///" + str;
+	}
+
+	struct Submodule
+	{
+		std::string path; // in the parent's tree, also the submodule's name
+		std::string url;
+		std::string commit;
+	};
+
+	// Bare repository at path holding a single commit: files, '/' in their names makes directories, plus a
+	// gitlink and .gitmodules entry per submodule at the root of the tree. The author and date are fixed, so
+	// are the ids. Returns the commit id, empty on failure.
+	std::string CreateRepo(const std::filesystem::path& path, const std::vector<File>& files, const std::vector<Submodule>& submodules = {})
+	{
+		HE_PROFILE_FUNCTION();
+
+		git_repository* repo = nullptr;
+		git_treebuilder* builder = nullptr;
+		git_tree* tree = nullptr;
+		git_signature* signature = nullptr;
+		git_oid commit = {};
+
+		auto cleanup = [&]() {
+			if (signature) git_signature_free(signature);
+			if (tree) git_tree_free(tree);
+			if (builder) git_treebuilder_free(builder);
+			if (repo) git_repository_free(repo);
+		};
+
+		auto addBlob = [&](git_treebuilder* b, const std::string& name, std::string_view content) {
+			git_oid oid;
+			return Check(git_blob_create_from_buffer(&oid, repo, content.data(), content.size()), "blob " + name) &&
+				Check(git_treebuilder_insert(nullptr, b, name.c_str(), &oid, GIT_FILEMODE_BLOB), "tree entry " + name);
+		};
+
+		// sorted by name the files of a directory are contiguous, each range becomes a subtree
+		std::vector<const File*> sorted;
+		for (const auto& f : files)
+			sorted.push_back(&f);
+
+		std::sort(sorted.begin(), sorted.end(), [](const File* a, const File* b) { return a->name < b->name; });
+
+		std::function<bool(git_treebuilder*, size_t, size_t, size_t)> fill = [&](git_treebuilder* b, size_t begin, size_t end, size_t prefix) {
+			for (size_t i = begin; i < end;)
+			{
+				std::string_view rest = std::string_view(sorted[i]->name).substr(prefix);
+				size_t slash = rest.find('/');
+				if (slash == std::string_view::npos)
+				{
+					if (!addBlob(b, std::string(rest), sorted[i]->content))
+						return false;
+
+					i++;
+					continue;
+				}
+
+				auto dir = rest.substr(0, slash + 1);
+				size_t j = i;
+				while (j < end && std::string_view(sorted[j]->name).substr(prefix).starts_with(dir))
+					j++;
+
+				git_treebuilder* sub = nullptr;
+				git_oid oid;
+				std::string name(rest.substr(0, slash));
+				bool ok = Check(git_treebuilder_new(&sub, repo, nullptr), "tree builder") &&
+					fill(sub, i, j, prefix + dir.size()) &&
+					Check(git_treebuilder_write(&oid, sub), "tree " + name) &&
+					Check(git_treebuilder_insert(nullptr, b, name.c_str(), &oid, GIT_FILEMODE_TREE), "tree entry " + name);
+
+				if (sub)
+					git_treebuilder_free(sub);
+
+				if (!ok)
+					return false;
+
+				i = j;
+			}
+
+			return true;
+		};
+
+		bool ok = Check(git_repository_init(&repo, path.string().c_str(), 1), "init " + path.string()) &&
+			Check(git_treebuilder_new(&builder, repo, nullptr), "tree builder") &&
+			fill(builder, 0, sorted.size(), 0);
+
+		if (ok && !submodules.empty())
+		{
+			std::string gitmodules;
+			for (const auto& s : submodules)
+			{
+				gitmodules += std::format("[submodule \"{}\"]\n\tpath = {}\n\turl = {}\n", s.path, s.path, s.url);
+
+				git_oid oid;
+				ok = ok && Check(git_oid_fromstr(&oid, s.commit.c_str()), "submodule id " + s.path) &&
+					Check(git_treebuilder_insert(nullptr, builder, s.path.c_str(), &oid, GIT_FILEMODE_COMMIT), "gitlink " + s.path);
+			}
+
+			ok = ok && addBlob(builder, ".gitmodules", gitmodules);
+		}
+
+		git_oid treeId;
+		ok = ok && Check(git_treebuilder_write(&treeId, builder), "tree") &&
+			Check(git_tree_lookup(&tree, repo, &treeId), "tree lookup") &&
+			Check(git_signature_new(&signature, "Fixtures", "fixtures@localhost", 1700000000, 0), "signature") &&
+			Check(git_commit_create(&commit, repo, "HEAD", signature, signature, nullptr, "fixture", tree, 0, nullptr), "commit");
+
+		cleanup();
+
+		if (!ok)
+			return {};
+
+		char id[GIT_OID_MAX_HEXSIZE + 1] = {};
+		git_oid_tostr(id, sizeof(id), &commit);
+		return id;
+	}
+
+	struct RepoTreeDesc
+	{
+		uint32_t depth = 2;      // levels of submodules below the top repository
+		uint32_t submodules = 2; // per repository above the last level
+		uint32_t files = 20;     // per repository
+		uint64_t fileSize = 4 * 1024;
+		uint64_t seed = 1;
+	};
+
+	// <dir>/<name>.git with desc.submodules submodules, each with as many of its own down to desc.depth,
+	// submodules of a level live in <dir>/<name>_<i>.git. topFiles only go to the top repository. Returns its
+	// file:// url, empty on failure.
+	std::string CreateRepoTree(const std::filesystem::path& dir, std::string_view name, const RepoTreeDesc& desc, const std::vector<File>& topFiles = {})
+	{
+		Rng rng{ desc.seed };
+
+		std::function<std::string(std::string_view, uint32_t, std::string&)> create = [&](std::string_view repoName, uint32_t depth, std::string& commit) {
+			std::vector<Submodule> submodules;
+			for (uint32_t i = 0; depth > 0 && i < desc.submodules; i++)
+			{
+				Submodule& s = submodules.emplace_back();
+				s.path = std::format("sub{}", i);
+				s.url = create(std::format("{}_{}", repoName, i), depth - 1, s.commit);
+				if (s.url.empty())
+					return std::string();
+			}
+
+			std::vector<File> files(desc.files);
+			for (uint32_t i = 0; i < desc.files; i++)
+				files[i] = { std::format("file{}.txt", i), MakeContent(rng, desc.fileSize) };
+
+			if (depth == desc.depth)
+				files.insert(files.end(), topFiles.begin(), topFiles.end());
+
+			auto path = dir / std::format("{}.git", repoName);
+			commit = CreateRepo(path, files, submodules);
+			return commit.empty() ? std::string() : ToFileUrl(path);
+		};
+
+		std::string commit;
+		return create(name, desc.depth, commit);
+	}
+}
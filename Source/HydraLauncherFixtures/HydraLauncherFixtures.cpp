@@ -0,0 +1,244 @@
+#include "HydraEngine/Base.h"
+
+import HE;
+import std;
+import Git;
+import Json;
+import Catalog;
+import Fixtures;
+
+using namespace HE;
+
+// Writes a launcher world that needs no network, at any scale :
+//
+//   HydraLauncherFixtures <output dir> [--projects 10000] [--plugins 50] [--templates 20] [--installed 5]
+//                         [--catalog 5000] [--depth 2] [--submodules 3] [--files 50] [--file-size 4096]
+//                         [--libs 4] [--lib-size 67108864] [--seed 1]
+//
+//   Remote/HydraEngine.git        engine repository with --depth levels of --submodules submodules
+//   Remote/HydraEngineLibs.git    --libs zip archives of --lib-size uncompressed bytes each
+//   Remote/Plugins/<name>.git     --plugins plugin repositories, <name>.hplugin and sources
+//   Remote/Templates/<name>.git   --templates template repositories, config.json, premake.lua, sources, assets
+//   Remote/remoteInfo.json        --catalog entries per list, the ones past the repositories point nowhere
+//   AppData/                      db.json with --projects projects and the first --installed plugins and templates
+//   Projects/Project<i>/          <name>.hproject of every project
+//
+// The same seed writes the same bytes, and the same git ids into the same output directory as submodule urls are
+// absolute. The result is one JSON line on stdout with the environment that points the launcher at the fixtures :
+// HYDRA_APP_DATA, HYDRA_REMOTE_INFO_URL, HYDRA_ENGINE_URL and HYDRA_ENGINE_LIBS_URL.
+
+struct FixtureOptions
+{
+    std::filesystem::path root;
+    uint32_t projects = 10000;
+    uint32_t plugins = 50;
+    uint32_t templates = 20;
+    uint32_t installed = 5;
+    uint32_t catalog = 5000;
+    uint32_t depth = 2;
+    uint32_t submodules = 3;
+    uint32_t files = 50;
+    uint64_t fileSize = 4 * 1024;
+    uint32_t libs = 4;
+    uint64_t libSize = 64 * 1024 * 1024;
+    uint64_t seed = 1;
+};
+
+constexpr uint64_t c_MaxLibSize = 0xFFFFFFFFull - 64 * 1024 * 1024; // zip without zip64, headers included
+
+static bool ParseFixtureOptions(ApplicationCommandLineArgs args, FixtureOptions& options)
+{
+    for (int i = 1; i < args.count; i++)
+    {
+        std::string_view arg = args[i];
+        if (!arg.starts_with("--"))
+        {
+            if (!options.root.empty())
+            {
+                HE_ERROR("Fixtures : more than one output directory, {}", arg);
+                return false;
+            }
+
+            options.root = arg;
+            continue;
+        }
+
+        if (i + 1 >= args.count)
+        {
+            HE_ERROR("Fixtures : missing value for {}", arg);
+            return false;
+        }
+
+        std::string_view value = args[++i];
+        auto number = [&](auto& out) {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+            return ec == std::errc() && ptr == value.data() + value.size();
+        };
+
+        bool ok = true;
+        if (arg == "--projects")        ok = number(options.projects);
+        else if (arg == "--plugins")    ok = number(options.plugins);
+        else if (arg == "--templates")  ok = number(options.templates);
+        else if (arg == "--installed")  ok = number(options.installed);
+        else if (arg == "--catalog")    ok = number(options.catalog);
+        else if (arg == "--depth")      ok = number(options.depth);
+        else if (arg == "--submodules") ok = number(options.submodules);
+        else if (arg == "--files")      ok = number(options.files);
+        else if (arg == "--file-size")  ok = number(options.fileSize);
+        else if (arg == "--libs")       ok = number(options.libs);
+        else if (arg == "--lib-size")   ok = number(options.libSize) && options.libSize <= c_MaxLibSize;
+        else if (arg == "--seed")       ok = number(options.seed);
+        else                            ok = false;
+
+        if (!ok)
+        {
+            HE_ERROR("Fixtures : invalid argument {} {}", arg, value);
+            return false;
+        }
+    }
+
+    if (options.root.empty())
+    {
+        HE_ERROR("Fixtures : missing output directory");
+        return false;
+    }
+
+    return true;
+}
+
+// the repositories behind the first catalog entries of each list, the first `installed` of them installed too
+static bool WriteRemotes(const FixtureOptions& options, Catalog::Page& page, std::string& engineUrl, std::string& libsUrl)
+{
+    HE_PROFILE_FUNCTION();
+
+    auto remote = options.root / "Remote";
+    auto appData = options.root / "AppData";
+
+    Fixtures::RepoTreeDesc engine;
+    engine.depth = options.depth;
+    engine.submodules = options.submodules;
+    engine.files = options.files;
+    engine.fileSize = options.fileSize;
+    engine.seed = options.seed;
+
+    // the launcher checks a HydraEngine directory for these before it lists the instance
+    std::vector<Fixtures::File> engineFiles = {
+        { "premake.lua", "-- fixture engine\n" },
+        { "build.lua", "-- fixture engine\n" },
+    };
+
+    engineUrl = Fixtures::CreateRepoTree(remote, "HydraEngine", engine, engineFiles);
+    if (engineUrl.empty())
+        return false;
+
+    Fixtures::LibDesc libs;
+    libs.archives = options.libs;
+    libs.archiveSize = options.libSize;
+    libs.seed = options.seed + 1;
+
+    auto libsPath = remote / "HydraEngineLibs.git";
+    if (Fixtures::CreateRepo(libsPath, Fixtures::MakeLibArchives(libs)).empty())
+        return false;
+
+    libsUrl = Fixtures::ToFileUrl(libsPath);
+
+    Fixtures::Rng rng{ options.seed + 2 };
+    auto write = [&](std::vector<Catalog::Entry>& entries, uint32_t count, std::string_view kind, auto makeFiles) {
+        for (uint32_t i = 0; i < count && i < entries.size(); i++)
+        {
+            auto& entry = entries[i];
+            auto path = remote / kind / std::format("{}.git", entry.name);
+            entry.URL = Fixtures::ToFileUrl(path);
+
+            auto files = makeFiles(rng, entry);
+            if (Fixtures::CreateRepo(path, files).empty())
+                return false;
+
+            if (i < options.installed && !Fixtures::WriteFiles(appData / kind / entry.name, files))
+                return false;
+        }
+
+        // not cloneable, downloading them fails like a dead link
+        for (size_t i = count; i < entries.size(); i++)
+            entries[i].URL = Fixtures::ToFileUrl(remote / "Missing" / std::format("{}.git", entries[i].name));
+
+        return true;
+    };
+
+    return write(page.plugins, options.plugins, "Plugins", [](Fixtures::Rng& rng, const Catalog::Entry& e) { return Fixtures::MakePluginFiles(rng, e); }) &&
+        write(page.templates, options.templates, "Templates", [](Fixtures::Rng& rng, const Catalog::Entry& e) { return Fixtures::MakeTemplateFiles(rng, e); });
+}
+
+static int WriteFixtures(const FixtureOptions& options)
+{
+    HE_PROFILE_FUNCTION();
+
+    auto start = std::chrono::steady_clock::now();
+    auto root = std::filesystem::absolute(options.root).lexically_normal();
+
+    std::error_code ec;
+    if (std::filesystem::exists(root / "Remote", ec) || std::filesystem::exists(root / "AppData", ec))
+    {
+        HE_ERROR("Fixtures : {} already holds fixtures", root.string());
+        return 1;
+    }
+
+    FixtureOptions rooted = options;
+    rooted.root = root;
+
+    // enough entries for every repository
+    auto page = Fixtures::MakeCatalogPage(std::max({ options.catalog, options.plugins, options.templates }), "");
+    page.templates.resize(std::max(options.catalog, options.templates));
+    page.plugins.resize(std::max(options.catalog, options.plugins));
+
+    std::string engineUrl;
+    std::string libsUrl;
+    auto remoteInfo = root / "Remote" / "remoteInfo.json";
+
+    Fixtures::DatabaseDesc database;
+    database.projects = options.projects;
+
+    bool ok = WriteRemotes(rooted, page, engineUrl, libsUrl) &&
+        Fixtures::WriteCatalog(remoteInfo, page) &&
+        Fixtures::WriteDatabase(root / "AppData" / "db.json", root / "Projects", database);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Json::Writer out(true);
+    out.BeginObject();
+    out.Member("ok", ok);
+    out.Member("root", root);
+    out.Member("projects", options.projects);
+    out.Member("catalogPlugins", (uint64_t)page.plugins.size());
+    out.Member("catalogTemplates", (uint64_t)page.templates.size());
+    out.Member("seconds", seconds);
+    out.Key("env");
+    out.BeginObject();
+    out.Member("HYDRA_APP_DATA", root / "AppData");
+    out.Member("HYDRA_REMOTE_INFO_URL", Fixtures::ToFileUrl(remoteInfo));
+    out.Member("HYDRA_ENGINE_URL", engineUrl);
+    out.Member("HYDRA_ENGINE_LIBS_URL", libsUrl);
+    out.EndObject();
+    out.EndObject();
+    std::puts(out.GetString().c_str());
+
+    return ok ? 0 : 1;
+}
+
+HE::ApplicationContext* HE::CreateApplication(ApplicationCommandLineArgs args)
+{
+    HE_PROFILE_FUNCTION();
+
+    // a generator, the process ends before any window or device exists
+    FixtureOptions options;
+    if (!ParseFixtureOptions(args, options))
+        std::exit(2);
+
+    Git::Init();
+    int code = WriteFixtures(options);
+    Git::Shutdown();
+
+    std::exit(code);
+}
+
+#include "HydraEngine/EntryPoint.h"
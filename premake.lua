@@ -33,6 +33,50 @@ CloneLibs(
 projectLocation = "%{wks.location}/Build/IDE"
 
 
+-------------------------------------------------------------------------------------
+-- functions
+-------------------------------------------------------------------------------------
+-- settings shared by the launcher and the targets built from its sources
+function LauncherSettings()
+    language "C++"
+    cppdialect "C++latest"
+    staticruntime "off"
+    targetdir (binOutputDir)
+    objdir (IntermediatesOutputDir)
+
+    LinkHydraApp(includSourceCode)
+    SetHydraFilters()
+
+    includedirs {
+    
+        "Source",
+        "ThirdParty/libgit2/include",
+    }
+    
+    links {
+    
+        "ImGui",
+        "ThirdParty/libgit2/lib/git2",
+    }
+
+    buildoptions {
+    
+        AddCppm("imgui"),
+    }
+
+    filter "system:windows"
+        links {
+            -- for libgit2
+            "winhttp",
+            "Crypt32",
+            "Rpcrt4",
+            -- for the daemon socket
+            "Ws2_32"
+        }
+    filter {}
+end
+
+
 -------------------------------------------------------------------------------------
 -- workspace
 -------------------------------------------------------------------------------------
@@ -48,50 +92,61 @@ workspace "HydraLauncher"
     group "HydraLauncher"
         project "HydraLauncher"
             kind "ConsoleApp"
-            language "C++"
-            cppdialect "C++latest"
-            staticruntime "off"
-            targetdir (binOutputDir)
-            objdir (IntermediatesOutputDir)
-
-            LinkHydraApp(includSourceCode)
-            SetHydraFilters()
+            LauncherSettings()
 
             files {
             
-                "Source/**.h",
-                "Source/**.cpp",
-                "Source/**.cppm",
+                "Source/HydraLauncher/**.h",
+                "Source/HydraLauncher/**.cpp",
+                "Source/HydraLauncher/**.cppm",
                 "*.lua",
 
                 "Resources/Icons/HydraLauncher.aps",
                 "Resources/Icons/HydraLauncher.rc",
                 "Resources/Icons/resource.h",
             }
+
+        -- hot path timings on generated fixtures, HydraLauncher.cpp is compiled through HydraLauncherBench.cpp
+        project "HydraLauncherBench"
+            kind "ConsoleApp"
+            LauncherSettings()
+
+            files {
             
-            includedirs {
-            
-                "Source",
-                "ThirdParty/libgit2/include",
+                "Source/HydraLauncher/**.h",
+                "Source/HydraLauncher/**.cpp",
+                "Source/HydraLauncher/**.cppm",
+                "Source/HydraLauncherBench/**.cpp",
+                "Source/HydraLauncherBench/**.cppm",
+                "Source/HydraLauncherFixtures/Fixtures.cppm",
             }
+
+            removefiles {
             
-            links {
+                "Source/HydraLauncher/HydraLauncher.cpp",
+            }
+
+            defines {
             
-                "ImGui",
-                "ThirdParty/libgit2/lib/git2",
+                "HE_LAUNCHER_BENCH",
             }
 
-            buildoptions {
+        -- offline repositories, catalog and app data at any scale for the bench and manual scale testing
+        project "HydraLauncherFixtures"
+            kind "ConsoleApp"
+            LauncherSettings()
+
+            files {
             
-                AddCppm("imgui"),
+                "Source/HydraLauncher/**.h",
+                "Source/HydraLauncher/**.cpp",
+                "Source/HydraLauncher/**.cppm",
+                "Source/HydraLauncherFixtures/**.cpp",
+                "Source/HydraLauncherFixtures/**.cppm",
             }
 
-            filter "system:windows"
-                links {
-                    -- for libgit2
-                    "winhttp",
-                    "Crypt32",
-                    "Rpcrt4"
-                }
-            filter {}
+            removefiles {
+            
+                "Source/HydraLauncher/HydraLauncher.cpp",
+            }
     group ""